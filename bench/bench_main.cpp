@@ -0,0 +1,375 @@
+#include "adapter/csv_parser.hpp"
+#include "adapter/csv_tokenizer.hpp"
+#include "adapter/csv_writer.hpp"
+#include "adapter/data_cleaner.hpp"
+#include "adapter/structural_scanner.hpp"
+#include "adapter/table.hpp"
+#include "adapter/time_aligner.hpp"
+#include "data_generator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace adapter {
+namespace bench {
+
+namespace {
+
+struct BenchmarkOptions {
+  size_t rows = 100000;
+  size_t iterations = 3;
+  size_t threads = 1;
+  std::string data_dir = "build/bench";
+  std::string json_file;
+  std::string filter;
+  std::vector<DatasetShape> shapes;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  std::string dataset;
+  size_t rows = 0;
+  size_t bytes = 0;
+  size_t iterations = 0;
+  double min_seconds = 0.0;
+  double median_seconds = 0.0;
+
+  double rows_per_second() const {
+    return median_seconds > 0.0 ? rows / median_seconds : 0.0;
+  }
+  double megabytes_per_second() const {
+    return median_seconds > 0.0 ? bytes / median_seconds / 1e6 : 0.0;
+  }
+};
+
+// Pipeline stages report progress on stdout; keep it out of the timings
+// and the report.
+class QuietOutput {
+public:
+  QuietOutput()
+      : saved_out(std::cout.rdbuf(nullptr)),
+        saved_err(std::cerr.rdbuf(nullptr)) {}
+  ~QuietOutput() {
+    std::cout.rdbuf(saved_out);
+    std::cerr.rdbuf(saved_err);
+    std::cout.clear();
+    std::cerr.clear();
+  }
+
+private:
+  std::streambuf *saved_out;
+  std::streambuf *saved_err;
+};
+
+// A loaded dataset shared by every benchmark that runs on it.
+struct Dataset {
+  DatasetSpec spec;
+  std::string name;
+  std::string path;
+  std::string csv;
+  Table table;
+};
+
+class BenchmarkRunner {
+public:
+  explicit BenchmarkRunner(const BenchmarkOptions &options)
+      : options(options) {}
+
+  // prepare runs untimed before every iteration; body is what is measured.
+  void run(const std::string &name, const Dataset &dataset,
+           const std::function<void()> &prepare,
+           const std::function<void()> &body) {
+    if (!options.filter.empty() &&
+        name.find(options.filter) == std::string::npos) {
+      return;
+    }
+
+    std::vector<double> seconds;
+    seconds.reserve(options.iterations);
+    for (size_t i = 0; i < options.iterations; ++i) {
+      QuietOutput quiet;
+      prepare();
+      const auto start = std::chrono::steady_clock::now();
+      body();
+      const auto end = std::chrono::steady_clock::now();
+      seconds.push_back(std::chrono::duration<double>(end - start).count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.dataset = dataset.name;
+    result.rows = dataset.spec.rows;
+    result.bytes = dataset.csv.size();
+    result.iterations = seconds.size();
+    result.min_seconds = seconds.front();
+    result.median_seconds = seconds[seconds.size() / 2];
+    print(result);
+    results.push_back(result);
+  }
+
+  void print_header() const {
+    std::cout << std::left << std::setw(24) << "benchmark" << std::setw(10)
+              << "dataset" << std::right << std::setw(10) << "rows"
+              << std::setw(12) << "median ms" << std::setw(14) << "rows/s"
+              << std::setw(10) << "MB/s" << std::endl;
+  }
+
+  bool write_json(const std::string &filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      return false;
+    }
+
+    file << "{\n";
+    file << "  \"schema_version\": 1,\n";
+    file << "  \"timestamp\": " << std::time(nullptr) << ",\n";
+    file << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+    file << "  \"simd_kernel\": \""
+         << StructuralScanner::kernel_name(StructuralScanner::detect_kernel())
+         << "\",\n";
+    file << "  \"threads\": " << options.threads << ",\n";
+    file << "  \"iterations\": " << options.iterations << ",\n";
+    file << "  \"results\": [\n";
+    file << std::setprecision(6) << std::fixed;
+    for (size_t i = 0; i < results.size(); ++i) {
+      const BenchmarkResult &result = results[i];
+      file << "    {\"name\": \"" << result.name << "\", \"dataset\": \""
+           << result.dataset << "\", \"rows\": " << result.rows
+           << ", \"bytes\": " << result.bytes
+           << ", \"iterations\": " << result.iterations
+           << ", \"min_seconds\": " << result.min_seconds
+           << ", \"median_seconds\": " << result.median_seconds
+           << ", \"rows_per_second\": " << result.rows_per_second()
+           << ", \"mb_per_second\": " << result.megabytes_per_second() << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return file.good();
+  }
+
+private:
+  const BenchmarkOptions &options;
+  std::vector<BenchmarkResult> results;
+
+  void print(const BenchmarkResult &result) const {
+    std::cout << std::left << std::setw(24) << result.name << std::setw(10)
+              << result.dataset << std::right << std::setw(10) << result.rows
+              << std::setw(12) << std::fixed << std::setprecision(2)
+              << result.median_seconds * 1e3 << std::setw(14)
+              << std::setprecision(0) << result.rows_per_second()
+              << std::setw(10) << std::setprecision(1)
+              << result.megabytes_per_second() << std::endl;
+  }
+};
+
+bool load_dataset(const BenchmarkOptions &options, DatasetShape shape,
+                  Dataset &dataset) {
+  dataset.spec = make_dataset_spec(shape, options.rows);
+  dataset.name = dataset_shape_name(shape);
+  dataset.path = options.data_dir + "/" + dataset.name + ".csv";
+  dataset.csv = generate_csv(dataset.spec);
+
+  if (!write_dataset(dataset.spec, dataset.path)) {
+    std::cerr << "Error: Could not write dataset " << dataset.path
+              << std::endl;
+    return false;
+  }
+
+  QuietOutput quiet;
+  CsvParser parser;
+  parser.set_thread_count(options.threads);
+  if (!parser.load_file(dataset.path)) {
+    return false;
+  }
+  dataset.table = parser.take_table();
+  return true;
+}
+
+void run_dataset(BenchmarkRunner &runner, const BenchmarkOptions &options,
+                 const Dataset &dataset) {
+  const auto nothing = [] {};
+  Table table;
+  const auto copy_table = [&] { table = dataset.table; };
+
+  size_t records = 0;
+  runner.run("tokenize", dataset, nothing, [&] {
+    CsvTokenizer tokenizer(dataset.csv.data(),
+                           dataset.csv.data() + dataset.csv.size(), ',');
+    std::vector<std::string_view> cells;
+    records = 0;
+    while (tokenizer.next_record(cells)) {
+      ++records;
+    }
+  });
+
+  runner.run("parse", dataset, nothing, [&] {
+    CsvParser parser;
+    parser.set_thread_count(options.threads);
+    parser.load_file(dataset.path);
+  });
+
+  DataCleaner cleaner;
+  cleaner.set_thread_count(options.threads);
+  runner.run("remove_duplicate_rows", dataset, copy_table,
+             [&] { cleaner.remove_duplicate_rows(table); });
+  runner.run("handle_missing_values", dataset, copy_table,
+             [&] { cleaner.handle_missing_values(table); });
+  runner.run("normalize_formats", dataset, copy_table,
+             [&] { cleaner.normalize_formats(table); });
+
+  TimeAligner aligner;
+  aligner.set_thread_count(options.threads);
+  runner.run("align_time_series_data", dataset, copy_table,
+             [&] { aligner.align_time_series_data(table, "time", {}, {}); });
+
+  const std::string output = options.data_dir + "/output.csv";
+  runner.run("write_csv", dataset, nothing, [&] {
+    CsvWriter writer;
+    writer.open(output, ',');
+    writer.write_header(dataset.table.get_headers());
+    writer.write_table(dataset.table);
+    writer.close();
+  });
+  std::remove(output.c_str());
+}
+
+void print_usage() {
+  std::cout << "Usage: adapter_bench [options]" << std::endl;
+  std::cout << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --rows <n>              Rows per tall dataset (default: "
+               "100000)"
+            << std::endl;
+  std::cout << "  --iterations <n>        Timed runs per benchmark (default: 3)"
+            << std::endl;
+  std::cout << "  -j, --threads <n>       Worker threads (default: 1)"
+            << std::endl;
+  std::cout << "  --shape <name>          tall, wide, quoted or missing; "
+               "repeatable (default: all)"
+            << std::endl;
+  std::cout << "  --filter <text>         Only run benchmarks whose name "
+               "contains text"
+            << std::endl;
+  std::cout << "  --data-dir <dir>        Where datasets are written (default: "
+               "build/bench)"
+            << std::endl;
+  std::cout << "  --json <file>           Write results as JSON" << std::endl;
+  std::cout << "  --generate <shape> <file>  Write one dataset and exit"
+            << std::endl;
+  std::cout << "  -h, --help              Show this help message" << std::endl;
+}
+
+bool parse_count(const char *text, size_t &value) {
+  try {
+    long parsed = std::stol(text);
+    if (parsed <= 0) {
+      return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+} // namespace
+
+int run(int argc, char *argv[]) {
+  BenchmarkOptions options;
+  std::string generate_shape;
+  std::string generate_file;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool ok = true;
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return 0;
+    } else if (arg == "--rows" && i + 1 < argc) {
+      ok = parse_count(argv[++i], options.rows);
+    } else if (arg == "--iterations" && i + 1 < argc) {
+      ok = parse_count(argv[++i], options.iterations);
+    } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+      ok = parse_count(argv[++i], options.threads);
+    } else if (arg == "--shape" && i + 1 < argc) {
+      DatasetShape shape;
+      ok = parse_dataset_shape(argv[++i], shape);
+      options.shapes.push_back(shape);
+    } else if (arg == "--filter" && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (arg == "--data-dir" && i + 1 < argc) {
+      options.data_dir = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      options.json_file = argv[++i];
+    } else if (arg == "--generate" && i + 2 < argc) {
+      generate_shape = argv[++i];
+      generate_file = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return 1;
+    }
+    if (!ok) {
+      std::cerr << "Error: Invalid value for " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  if (!generate_file.empty()) {
+    DatasetShape shape;
+    if (!parse_dataset_shape(generate_shape, shape)) {
+      std::cerr << "Error: Unknown shape '" << generate_shape << "'"
+                << std::endl;
+      return 1;
+    }
+    if (!write_dataset(make_dataset_spec(shape, options.rows),
+                       generate_file)) {
+      std::cerr << "Error: Could not write " << generate_file << std::endl;
+      return 1;
+    }
+    std::cout << "Wrote " << generate_shape << " dataset to " << generate_file
+              << std::endl;
+    return 0;
+  }
+
+  if (options.shapes.empty()) {
+    options.shapes = {DatasetShape::TALL, DatasetShape::WIDE,
+                      DatasetShape::QUOTED, DatasetShape::MISSING_HEAVY};
+  }
+  std::filesystem::create_directories(options.data_dir);
+
+  BenchmarkRunner runner(options);
+  runner.print_header();
+  for (DatasetShape shape : options.shapes) {
+    Dataset dataset;
+    if (!load_dataset(options, shape, dataset)) {
+      std::cerr << "Error: Could not load " << dataset_shape_name(shape)
+                << " dataset" << std::endl;
+      return 1;
+    }
+    run_dataset(runner, options, dataset);
+  }
+
+  if (!options.json_file.empty()) {
+    if (!runner.write_json(options.json_file)) {
+      std::cerr << "Error: Could not write " << options.json_file << std::endl;
+      return 1;
+    }
+    std::cout << "Results written to: " << options.json_file << std::endl;
+  }
+  return 0;
+}
+
+} // namespace bench
+} // namespace adapter
+
+int main(int argc, char *argv[]) { return adapter::bench::run(argc, argv); }
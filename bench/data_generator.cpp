@@ -0,0 +1,161 @@
+#include "data_generator.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <random>
+
+namespace adapter {
+namespace bench {
+
+namespace {
+
+const char *const categories[] = {"pump_a", "pump_b", "valve_1", "valve_2",
+                                  "tank_n", "tank_s", "line_3", "line_4"};
+const char *const missing_tokens[] = {"", "NA", "NaN", "NULL"};
+const char *const quoted_text[] = {
+    "\"stage 3, east\"", "\"operator said \"\"ok\"\"\"",
+    "\"first line\nsecond line\"", "plain note", "\"a,b,c\"", "\"\"\"\""};
+
+void append_fixed(std::string &out, double value, int precision) {
+  char buffer[64];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                              std::chars_format::fixed, precision);
+  out.append(buffer, result.ptr);
+}
+
+void append_int(std::string &out, int64_t value) {
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+double missing_ratio(DatasetShape shape) {
+  switch (shape) {
+  case DatasetShape::MISSING_HEAVY:
+    return 0.4;
+  case DatasetShape::WIDE:
+    return 0.01;
+  default:
+    return 0.02;
+  }
+}
+
+void append_cell(std::string &out, DatasetShape shape, size_t col,
+                 size_t row, std::mt19937_64 &rng) {
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  if (unit(rng) < missing_ratio(shape)) {
+    out += missing_tokens[rng() % 4];
+    return;
+  }
+
+  if (shape == DatasetShape::WIDE) {
+    append_fixed(out, 100.0 * unit(rng) + static_cast<double>(col), 2);
+    return;
+  }
+  if (shape == DatasetShape::QUOTED && col % 2 == 1) {
+    out += quoted_text[rng() % 6];
+    return;
+  }
+
+  switch (col % 4) {
+  case 0:
+    append_int(out, static_cast<int64_t>(row % 1000) +
+                        static_cast<int64_t>(rng() % 50));
+    break;
+  case 1:
+    append_fixed(out, 20.0 + 5.0 * unit(rng), 2);
+    break;
+  case 2:
+    append_fixed(out, 1000.0 * unit(rng), 3);
+    break;
+  default:
+    out += categories[rng() % 8];
+    break;
+  }
+}
+
+} // namespace
+
+bool parse_dataset_shape(const std::string &name, DatasetShape &shape) {
+  if (name == "tall") {
+    shape = DatasetShape::TALL;
+  } else if (name == "wide") {
+    shape = DatasetShape::WIDE;
+  } else if (name == "quoted") {
+    shape = DatasetShape::QUOTED;
+  } else if (name == "missing") {
+    shape = DatasetShape::MISSING_HEAVY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string dataset_shape_name(DatasetShape shape) {
+  switch (shape) {
+  case DatasetShape::TALL:
+    return "tall";
+  case DatasetShape::WIDE:
+    return "wide";
+  case DatasetShape::QUOTED:
+    return "quoted";
+  case DatasetShape::MISSING_HEAVY:
+    return "missing";
+  }
+  return "tall";
+}
+
+DatasetSpec make_dataset_spec(DatasetShape shape, size_t rows) {
+  DatasetSpec spec;
+  spec.shape = shape;
+  spec.rows = rows;
+  if (shape == DatasetShape::WIDE) {
+    spec.columns = 400;
+    spec.rows = std::max<size_t>(1, rows * 8 / spec.columns);
+  }
+  return spec;
+}
+
+std::string generate_csv(const DatasetSpec &spec) {
+  std::mt19937_64 rng(spec.seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  std::string out = "time";
+  for (size_t col = 0; col < spec.columns; ++col) {
+    out += ",c";
+    append_int(out, static_cast<int64_t>(col));
+  }
+  out += '\n';
+  out.reserve(spec.rows * (spec.columns + 1) * 8);
+
+  std::string previous;
+  for (size_t row = 0; row < spec.rows; ++row) {
+    if (!previous.empty() && unit(rng) < spec.duplicate_ratio) {
+      out += previous;
+      continue;
+    }
+
+    const size_t start = out.size();
+    append_fixed(out, static_cast<double>(row) * 0.5, 1);
+    for (size_t col = 0; col < spec.columns; ++col) {
+      out += ',';
+      append_cell(out, spec.shape, col, row, rng);
+    }
+    out += '\n';
+    previous.assign(out, start, std::string::npos);
+  }
+  return out;
+}
+
+bool write_dataset(const DatasetSpec &spec, const std::string &filename) {
+  std::ofstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  const std::string csv = generate_csv(spec);
+  file.write(csv.data(), static_cast<std::streamsize>(csv.size()));
+  return file.good();
+}
+
+} // namespace bench
+} // namespace adapter
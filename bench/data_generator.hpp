@@ -0,0 +1,43 @@
+#ifndef ADAPTER_BENCH_DATA_GENERATOR_HPP
+#define ADAPTER_BENCH_DATA_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace adapter {
+namespace bench {
+
+enum class DatasetShape {
+  TALL,          // Many rows, a handful of typed columns
+  WIDE,          // Few rows, hundreds of numeric columns
+  QUOTED,        // Text cells with delimiters, quotes and line breaks
+  MISSING_HEAVY, // Every column is missing about 40% of its values
+};
+
+struct DatasetSpec {
+  DatasetShape shape = DatasetShape::TALL;
+  size_t rows = 100000;
+  // Value columns; the time column comes in addition
+  size_t columns = 8;
+  // Fraction of rows that repeat an earlier row
+  double duplicate_ratio = 0.02;
+  uint64_t seed = 42;
+};
+
+bool parse_dataset_shape(const std::string &name, DatasetShape &shape);
+std::string dataset_shape_name(DatasetShape shape);
+
+// Default spec for a shape, scaled so every shape is roughly the same
+// number of cells as a tall dataset with `rows` rows.
+DatasetSpec make_dataset_spec(DatasetShape shape, size_t rows);
+
+// Deterministic CSV text for the spec: a "time" column in seconds followed
+// by the value columns.
+std::string generate_csv(const DatasetSpec &spec);
+bool write_dataset(const DatasetSpec &spec, const std::string &filename);
+
+} // namespace bench
+} // namespace adapter
+
+#endif // ADAPTER_BENCH_DATA_GENERATOR_HPP
@@ -0,0 +1,474 @@
+#include "../data_generator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace adapter {
+namespace bench {
+
+namespace {
+
+struct StressOptions {
+  std::string adapter = "build/adapter";
+  std::string data_dir = "build/stress";
+  std::string json_file;
+  size_t min_rows = 10000;
+  size_t max_rows = 1000000;
+  size_t repeats = 2;
+  // Largest allowed growth exponent between two sizes of a sweep
+  double max_exponent = 1.25;
+  // Pairs whose smaller run is quicker than this are dominated by process
+  // start-up and are reported but not checked
+  double min_seconds = 0.05;
+  // Peak RSS ceilings per input byte, over a fixed allowance
+  double memory_ratio = 6.0;
+  double stream_memory_ratio = 1.5;
+  double base_megabytes = 64.0;
+  bool keep = false;
+};
+
+// One sweep varies a single dimension of the dataset and runs the same
+// command on every size.
+struct Sweep {
+  std::string name;
+  bool stream;
+  std::vector<DatasetSpec> specs;
+};
+
+struct StressResult {
+  std::string sweep;
+  size_t rows = 0;
+  size_t columns = 0;
+  uint64_t bytes = 0;
+  double seconds = 0.0;
+  uint64_t peak_rss_bytes = 0;
+  uint64_t rss_ceiling_bytes = 0;
+  // Growth from the previous size of the sweep; NAN for the first one
+  double time_exponent = NAN;
+  double memory_exponent = NAN;
+  bool ok = true;
+  std::string failure;
+
+  double cells() const { return static_cast<double>(rows) * (columns + 1); }
+};
+
+struct RunResult {
+  bool ok = false;
+  double seconds = 0.0;
+  uint64_t peak_rss_bytes = 0;
+};
+
+// Runs the adapter in its own process, so peak RSS is that run's alone and
+// not the high-water mark of everything the driver did before it.
+RunResult run_adapter(const std::vector<std::string> &args) {
+  RunResult result;
+  std::vector<char *> argv;
+  for (const std::string &arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  const pid_t pid = fork();
+  if (pid < 0) {
+    return result;
+  }
+  if (pid == 0) {
+    const int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+      dup2(null_fd, STDOUT_FILENO);
+      dup2(null_fd, STDERR_FILENO);
+      close(null_fd);
+    }
+    execv(argv[0], argv.data());
+    _exit(127);
+  }
+
+  int status = 0;
+  struct rusage usage {};
+  if (wait4(pid, &status, 0, &usage) != pid) {
+    return result;
+  }
+  const auto end = std::chrono::steady_clock::now();
+  result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  result.seconds = std::chrono::duration<double>(end - start).count();
+  // ru_maxrss is in kilobytes on Linux
+  result.peak_rss_bytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+  return result;
+}
+
+std::vector<Sweep> make_sweeps(const StressOptions &options) {
+  std::vector<Sweep> sweeps;
+  Sweep rows{"rows", false, {}};
+  Sweep stream{"stream", true, {}};
+  for (size_t count = options.min_rows; count <= options.max_rows;
+       count *= 10) {
+    DatasetSpec spec;
+    spec.rows = count;
+    spec.columns = 10;
+    rows.specs.push_back(spec);
+    stream.specs.push_back(spec);
+  }
+
+  // Columns grow at a fixed row count, from 10 to 1000
+  Sweep columns{"columns", false, {}};
+  for (size_t count = 10; count <= 1000; count *= 10) {
+    DatasetSpec spec;
+    spec.shape = DatasetShape::WIDE;
+    spec.rows = options.min_rows;
+    spec.columns = count;
+    columns.specs.push_back(spec);
+  }
+
+  sweeps.push_back(rows);
+  sweeps.push_back(columns);
+  sweeps.push_back(stream);
+  return sweeps;
+}
+
+double growth_exponent(double previous, double current, double previous_size,
+                       double current_size) {
+  if (previous <= 0.0 || current <= 0.0 || current_size <= previous_size) {
+    return NAN;
+  }
+  return std::log(current / previous) /
+         std::log(current_size / previous_size);
+}
+
+class StressRunner {
+public:
+  explicit StressRunner(const StressOptions &options) : options(options) {}
+
+  bool run(const Sweep &sweep) {
+    bool ok = true;
+    const StressResult *previous = nullptr;
+    for (const DatasetSpec &spec : sweep.specs) {
+      StressResult result;
+      if (!run_case(sweep, spec, result)) {
+        std::cerr << "Error: Could not write dataset for " << sweep.name
+                  << std::endl;
+        return false;
+      }
+      if (previous != nullptr) {
+        check_growth(*previous, result);
+      }
+      print(result);
+      ok = ok && result.ok;
+      results.push_back(result);
+      previous = &results.back();
+    }
+    return ok;
+  }
+
+  void print_header() const {
+    std::cout << std::left << std::setw(9) << "sweep" << std::right
+              << std::setw(10) << "rows" << std::setw(9) << "columns"
+              << std::setw(10) << "input MB" << std::setw(10) << "seconds"
+              << std::setw(10) << "peak MB" << std::setw(10) << "ceil MB"
+              << std::setw(8) << "time^" << std::setw(8) << "mem^"
+              << "  status" << std::endl;
+  }
+
+  bool write_json(const std::string &filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      return false;
+    }
+
+    file << "{\n";
+    file << "  \"schema_version\": 1,\n";
+    file << "  \"timestamp\": " << std::time(nullptr) << ",\n";
+    file << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+    file << "  \"max_exponent\": " << options.max_exponent << ",\n";
+    file << "  \"results\": [\n";
+    file << std::setprecision(6) << std::fixed;
+    for (size_t i = 0; i < results.size(); ++i) {
+      const StressResult &result = results[i];
+      file << "    {\"sweep\": \"" << result.sweep
+           << "\", \"rows\": " << result.rows
+           << ", \"columns\": " << result.columns
+           << ", \"bytes\": " << result.bytes
+           << ", \"seconds\": " << result.seconds
+           << ", \"peak_rss_bytes\": " << result.peak_rss_bytes
+           << ", \"rss_ceiling_bytes\": " << result.rss_ceiling_bytes
+           << ", \"time_exponent\": " << json_number(result.time_exponent)
+           << ", \"memory_exponent\": " << json_number(result.memory_exponent)
+           << ", \"ok\": " << (result.ok ? "true" : "false") << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return file.good();
+  }
+
+private:
+  const StressOptions &options;
+  std::vector<StressResult> results;
+
+  bool run_case(const Sweep &sweep, const DatasetSpec &spec,
+                StressResult &result) {
+    const std::string input = options.data_dir + "/" + sweep.name + "_" +
+                              std::to_string(spec.rows) + "x" +
+                              std::to_string(spec.columns) + ".csv";
+    const std::string output = options.data_dir + "/output.csv";
+    if (!write_dataset(spec, input)) {
+      return false;
+    }
+
+    result.sweep = sweep.name;
+    result.rows = spec.rows;
+    result.columns = spec.columns;
+    result.bytes = std::filesystem::file_size(input);
+    const double ratio =
+        sweep.stream ? options.stream_memory_ratio : options.memory_ratio;
+    result.rss_ceiling_bytes = static_cast<uint64_t>(
+        options.base_megabytes * 1024 * 1024 + ratio * result.bytes);
+
+    std::vector<std::string> args = {options.adapter, "-o", output};
+    if (sweep.stream) {
+      args.push_back("--stream");
+    } else {
+      args.push_back("-t");
+      args.push_back("time");
+    }
+    args.push_back(input);
+
+    // The fastest of the repeats is the least disturbed by the machine;
+    // the largest peak RSS is the one a ceiling has to hold for
+    for (size_t i = 0; i < options.repeats; ++i) {
+      const RunResult run = run_adapter(args);
+      if (!run.ok) {
+        result.ok = false;
+        result.failure = "adapter failed";
+        break;
+      }
+      if (i == 0 || run.seconds < result.seconds) {
+        result.seconds = run.seconds;
+      }
+      result.peak_rss_bytes = std::max(result.peak_rss_bytes,
+                                       run.peak_rss_bytes);
+    }
+    if (result.ok && result.peak_rss_bytes > result.rss_ceiling_bytes) {
+      result.ok = false;
+      result.failure = "peak RSS over ceiling";
+    }
+
+    std::remove(output.c_str());
+    if (!options.keep) {
+      std::remove(input.c_str());
+    }
+    return true;
+  }
+
+  // Work should grow with the number of cells. Time is only held to the
+  // bound once a run is long enough to be measured; memory always is.
+  void check_growth(const StressResult &previous, StressResult &result) const {
+    result.time_exponent = growth_exponent(previous.seconds, result.seconds,
+                                           previous.cells(), result.cells());
+    result.memory_exponent =
+        growth_exponent(static_cast<double>(previous.peak_rss_bytes),
+                        static_cast<double>(result.peak_rss_bytes),
+                        previous.cells(), result.cells());
+    if (!result.ok) {
+      return;
+    }
+    if (previous.seconds >= options.min_seconds &&
+        result.time_exponent > options.max_exponent) {
+      result.ok = false;
+      result.failure = "superlinear time";
+    } else if (result.memory_exponent > options.max_exponent) {
+      result.ok = false;
+      result.failure = "superlinear memory";
+    }
+  }
+
+  static std::string json_number(double value) {
+    if (std::isnan(value)) {
+      return "null";
+    }
+    std::ostringstream text;
+    text << std::setprecision(4) << std::fixed << value;
+    return text.str();
+  }
+
+  static std::string exponent_text(double value) {
+    if (std::isnan(value)) {
+      return "-";
+    }
+    std::ostringstream text;
+    text << std::setprecision(2) << std::fixed << value;
+    return text.str();
+  }
+
+  void print(const StressResult &result) const {
+    const double megabyte = 1024.0 * 1024.0;
+    std::cout << std::left << std::setw(9) << result.sweep << std::right
+              << std::setw(10) << result.rows << std::setw(9)
+              << result.columns << std::fixed << std::setprecision(1)
+              << std::setw(10) << result.bytes / megabyte
+              << std::setprecision(3) << std::setw(10) << result.seconds
+              << std::setprecision(1) << std::setw(10)
+              << result.peak_rss_bytes / megabyte << std::setw(10)
+              << result.rss_ceiling_bytes / megabyte << std::setw(8)
+              << exponent_text(result.time_exponent) << std::setw(8)
+              << exponent_text(result.memory_exponent) << "  "
+              << (result.ok ? "ok" : "FAIL: " + result.failure) << std::endl;
+  }
+};
+
+void print_usage() {
+  std::cout << "Usage: adapter_stress [options]" << std::endl;
+  std::cout << std::endl;
+  std::cout << "Runs the adapter on generated datasets of growing size and "
+               "fails when time or"
+            << std::endl;
+  std::cout << "memory grows faster than the input or peak RSS passes its "
+               "ceiling."
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --adapter <path>        Adapter executable (default: "
+               "build/adapter)"
+            << std::endl;
+  std::cout << "  --min-rows <n>          Smallest row count (default: 10000)"
+            << std::endl;
+  std::cout << "  --max-rows <n>          Largest row count, in steps of 10x "
+               "(default: 1000000)"
+            << std::endl;
+  std::cout << "  --repeats <n>           Runs per size (default: 2)"
+            << std::endl;
+  std::cout << "  --max-exponent <x>      Allowed growth exponent (default: "
+               "1.25)"
+            << std::endl;
+  std::cout << "  --memory-ratio <x>      Peak RSS per input byte in memory "
+               "(default: 6)"
+            << std::endl;
+  std::cout << "  --stream-memory-ratio <x>  Peak RSS per input byte in "
+               "stream mode (default: 1.5)"
+            << std::endl;
+  std::cout << "  --base-mb <n>           RSS allowance over the ratios "
+               "(default: 64)"
+            << std::endl;
+  std::cout << "  --data-dir <dir>        Where datasets are written "
+               "(default: build/stress)"
+            << std::endl;
+  std::cout << "  --keep                  Keep the generated datasets"
+            << std::endl;
+  std::cout << "  --json <file>           Write results as JSON" << std::endl;
+  std::cout << "  -h, --help              Show this help message" << std::endl;
+}
+
+bool parse_count(const char *text, size_t &value) {
+  try {
+    long parsed = std::stol(text);
+    if (parsed <= 0) {
+      return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+bool parse_positive(const char *text, double &value) {
+  try {
+    value = std::stod(text);
+    return value > 0.0;
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+} // namespace
+
+int run(int argc, char *argv[]) {
+  StressOptions options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool ok = true;
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return 0;
+    } else if (arg == "--adapter" && i + 1 < argc) {
+      options.adapter = argv[++i];
+    } else if (arg == "--min-rows" && i + 1 < argc) {
+      ok = parse_count(argv[++i], options.min_rows);
+    } else if (arg == "--max-rows" && i + 1 < argc) {
+      ok = parse_count(argv[++i], options.max_rows);
+    } else if (arg == "--repeats" && i + 1 < argc) {
+      ok = parse_count(argv[++i], options.repeats);
+    } else if (arg == "--max-exponent" && i + 1 < argc) {
+      ok = parse_positive(argv[++i], options.max_exponent);
+    } else if (arg == "--memory-ratio" && i + 1 < argc) {
+      ok = parse_positive(argv[++i], options.memory_ratio);
+    } else if (arg == "--stream-memory-ratio" && i + 1 < argc) {
+      ok = parse_positive(argv[++i], options.stream_memory_ratio);
+    } else if (arg == "--base-mb" && i + 1 < argc) {
+      ok = parse_positive(argv[++i], options.base_megabytes);
+    } else if (arg == "--data-dir" && i + 1 < argc) {
+      options.data_dir = argv[++i];
+    } else if (arg == "--keep") {
+      options.keep = true;
+    } else if (arg == "--json" && i + 1 < argc) {
+      options.json_file = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return 1;
+    }
+    if (!ok) {
+      std::cerr << "Error: Invalid value for " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  if (options.min_rows > options.max_rows) {
+    std::cerr << "Error: --min-rows is larger than --max-rows" << std::endl;
+    return 1;
+  }
+  if (access(options.adapter.c_str(), X_OK) != 0) {
+    std::cerr << "Error: Cannot run " << options.adapter << std::endl;
+    return 1;
+  }
+  std::filesystem::create_directories(options.data_dir);
+
+  StressRunner runner(options);
+  runner.print_header();
+  bool ok = true;
+  for (const Sweep &sweep : make_sweeps(options)) {
+    ok = runner.run(sweep) && ok;
+  }
+
+  if (!options.json_file.empty()) {
+    if (!runner.write_json(options.json_file)) {
+      std::cerr << "Error: Could not write " << options.json_file << std::endl;
+      return 1;
+    }
+    std::cout << "Results written to: " << options.json_file << std::endl;
+  }
+  if (!ok) {
+    std::cerr << "Stress suite failed" << std::endl;
+    return 1;
+  }
+  std::cout << "Stress suite passed" << std::endl;
+  return 0;
+}
+
+} // namespace bench
+} // namespace adapter
+
+int main(int argc, char *argv[]) { return adapter::bench::run(argc, argv); }
@@ -0,0 +1,29 @@
+#ifndef ADAPTER_ARROW_WRITER_HPP
+#define ADAPTER_ARROW_WRITER_HPP
+
+#include "adapter/table.hpp"
+#include <cstdint>
+#include <string>
+
+namespace adapter {
+
+enum class OutputFormat { CSV, ARROW };
+
+// Writes the table as an Arrow IPC file (Feather v2): a schema, one
+// dictionary batch per text column and a single record batch, followed by
+// the footer that indexes them. INT64 and FLOAT64 columns become int64 and
+// float64 arrays and text columns dictionary-encoded utf8 with int32
+// indices, so every array is written straight from the column's own
+// buffers and a reader can memory-map the file and use it in place. Arrays
+// start on 64-byte boundaries and are in host byte order, which the schema
+// records. Field metadata keeps each column's kind under adapter.kind and a
+// FLOAT64 column's rendering precision under adapter.precision.
+bool write_arrow_file(const Table &table, const std::string &path,
+                      uint64_t *bytes_written = nullptr);
+
+// Accepts csv, and arrow or feather.
+bool parse_output_format(const std::string &name, OutputFormat &format);
+
+} // namespace adapter
+
+#endif // ADAPTER_ARROW_WRITER_HPP
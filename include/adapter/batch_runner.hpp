@@ -0,0 +1,116 @@
+#ifndef ADAPTER_BATCH_RUNNER_HPP
+#define ADAPTER_BATCH_RUNNER_HPP
+
+#include "adapter/csv_parser.hpp"
+#include "adapter/csv_writer.hpp"
+#include "adapter/data_cleaner.hpp"
+#include "adapter/metrics.hpp"
+#include "adapter/pipeline_spec.hpp"
+#include "adapter/thread_pool.hpp"
+#include "adapter/time_aligner.hpp"
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+// One file for a batch run; an empty output takes the default name.
+struct BatchJob {
+  std::string input_file;
+  std::string output_file;
+};
+
+struct BatchResult {
+  BatchJob job;
+  bool ok = false;
+  std::string error;
+  size_t rows_in = 0;
+  size_t rows_out = 0;
+  double seconds = 0.0;
+  // The job's parse, clean, align and write stages
+  Metrics metrics;
+};
+
+// Reads "input [output]" from a manifest line. Blank lines and lines
+// starting with # hold no job.
+bool parse_batch_job(const std::string &line, BatchJob &job);
+// One line: "ok <input> <output> rows_in=... rows_out=... seconds=..."
+// followed by each stage's seconds, or "failed <input> <reason>".
+std::string format_batch_result(const BatchResult &result);
+
+// Runs the in-memory pipeline (parse, clean, align when a time column is
+// set, write) over many files in one process. Every job uses the same
+// spec, so settings are resolved once for the whole batch. Jobs run
+// concurrently on spec.thread_count workers with one thread each, which
+// suits many small files better than splitting each file across threads.
+class BatchRunner {
+public:
+  using ResultHandler = std::function<void(const BatchResult &)>;
+
+  explicit BatchRunner(const PipelineSpec &spec);
+  ~BatchRunner();
+
+  BatchRunner(const BatchRunner &) = delete;
+  BatchRunner &operator=(const BatchRunner &) = delete;
+
+  // Queues the job. The handler runs on the worker that finished it and
+  // never alongside another handler.
+  void submit(const BatchJob &job, ResultHandler on_done);
+  // Blocks until every submitted job has finished.
+  void wait();
+  // Runs one job on the calling thread.
+  BatchResult run(const BatchJob &job);
+
+  size_t get_worker_count() const;
+  size_t get_job_count() const;
+  size_t get_failed_count() const;
+  // The stages of every finished job, summed by name.
+  Metrics get_metrics() const;
+
+private:
+  // What a job runs through. A worker is handed from one job to the next,
+  // so the parser's arenas and the writer's buffer are allocated once per
+  // worker instead of once per file.
+  struct Worker {
+    CsvParser parser;
+    DataCleaner cleaner;
+    TimeAligner aligner;
+    CsvWriter writer;
+  };
+
+  PipelineSpec spec;
+  ThreadPool pool;
+  // Guards the idle workers and the totals, and serialises handlers
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<Worker>> idle_workers;
+  Metrics totals;
+  size_t job_count;
+  size_t failed_count;
+
+  std::unique_ptr<Worker> acquire_worker();
+  void finish_job(std::unique_ptr<Worker> worker, const BatchResult &result,
+                  const ResultHandler &on_done);
+  bool run_job(Worker &worker, BatchResult &result) const;
+  bool run_stages(Worker &worker, BatchResult &result) const;
+};
+
+// Reads jobs from input a line at a time and writes each one's result line
+// to report as it finishes, so a pipe can feed a warm process for as long
+// as it stays open. Returns false if any of these jobs failed.
+bool run_batch_stream(BatchRunner &runner, std::istream &input,
+                      std::ostream &report);
+
+// Serves jobs on a Unix domain socket at path. A client writes job lines
+// and reads a result line back for each job as it finishes; connections
+// are served one after another, and a connection's jobs have all finished
+// before it is closed. A "shutdown" line stops the server once the jobs of
+// that connection are done. Returns false if the socket cannot be set up.
+bool serve_batch_socket(BatchRunner &runner, const std::string &path);
+
+} // namespace adapter
+
+#endif // ADAPTER_BATCH_RUNNER_HPP
@@ -0,0 +1,81 @@
+#ifndef ADAPTER_BOUNDED_QUEUE_HPP
+#define ADAPTER_BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace adapter {
+
+// FIFO handoff between pipeline stages running on different threads. push
+// blocks while capacity items are waiting, which holds a fast producer back
+// to the pace of its consumer; closing wakes both sides so either can shut
+// the pipeline down.
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity)
+      : capacity(capacity == 0 ? 1 : capacity), closed(false),
+        blocked_pushes(0) {}
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  // Returns false, dropping the item, once the queue is closed.
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (items.size() >= capacity && !closed) {
+      ++blocked_pushes;
+      not_full.wait(lock,
+                    [this] { return items.size() < capacity || closed; });
+    }
+    if (closed) {
+      return false;
+    }
+    items.push_back(std::move(item));
+    not_empty.notify_one();
+    return true;
+  }
+
+  // Returns false once the queue is closed and drained.
+  bool pop(T &item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [this] { return !items.empty() || closed; });
+    if (items.empty()) {
+      return false;
+    }
+    item = std::move(items.front());
+    items.pop_front();
+    not_full.notify_one();
+    return true;
+  }
+
+  // Items already queued can still be popped.
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_empty.notify_all();
+    not_full.notify_all();
+  }
+
+  // Pushes that had to wait for room: how often the consumer was the
+  // bottleneck.
+  size_t get_blocked_pushes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return blocked_pushes;
+  }
+
+private:
+  const size_t capacity;
+  mutable std::mutex mutex;
+  std::condition_variable not_empty;
+  std::condition_variable not_full;
+  std::deque<T> items;
+  bool closed;
+  size_t blocked_pushes;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_BOUNDED_QUEUE_HPP
@@ -0,0 +1,53 @@
+#ifndef ADAPTER_CELL_ARENA_HPP
+#define ADAPTER_CELL_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace adapter {
+
+// Bump allocator for cell text. Bytes are appended to large blocks and
+// released all at once, so a parsed chunk costs a handful of allocations
+// however many cells it holds. Views returned by store stay valid until
+// clear, across moves and absorb.
+class CellArena {
+public:
+  static constexpr size_t default_block_size = 1 << 20;
+
+  explicit CellArena(size_t block_size = default_block_size);
+
+  CellArena(const CellArena &) = delete;
+  CellArena &operator=(const CellArena &) = delete;
+  CellArena(CellArena &&other) noexcept;
+  CellArena &operator=(CellArena &&other) noexcept;
+
+  // Copies text into the arena. Empty cells take no space.
+  std::string_view store(std::string_view text);
+  // Takes ownership of other's blocks; views into them stay valid.
+  void absorb(CellArena &&other);
+  void clear();
+  // Forgets every cell like clear but keeps the first block, so an arena
+  // that is filled again and again allocates once.
+  void reset();
+
+  size_t get_bytes_used() const;
+  size_t get_block_count() const;
+
+private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t capacity = 0;
+  };
+
+  size_t block_size;
+  // The last block is the one being filled
+  std::vector<Block> blocks;
+  size_t block_used;
+  size_t bytes_used;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_CELL_ARENA_HPP
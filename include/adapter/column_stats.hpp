@@ -0,0 +1,91 @@
+#ifndef ADAPTER_COLUMN_STATS_HPP
+#define ADAPTER_COLUMN_STATS_HPP
+
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace adapter {
+
+// Summary of one column. The numeric fields cover the values that parsed
+// as numbers and are only meaningful when numeric_count is non-zero.
+struct ColumnStats {
+  bool numeric = false;
+  // Non-missing cells, numeric or not
+  size_t valid_count = 0;
+  size_t null_count = 0;
+  size_t numeric_count = 0;
+  double sum = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  double mean = 0.0;
+  // Sample variance (n - 1 denominator); 0 for fewer than two values
+  double variance = 0.0;
+  // Only filled when the median was requested
+  bool has_median = false;
+  double median = 0.0;
+};
+
+// Median of a stream of values: exact while at most exact_limit values have
+// been seen (selected with nth_element), then a P-square estimate (Jain &
+// Chlamtac, 1985) whose five markers need constant memory.
+class MedianEstimator {
+public:
+  static constexpr size_t default_exact_limit = 1 << 16;
+
+  explicit MedianEstimator(size_t exact_limit = default_exact_limit);
+
+  void add(double value);
+  double get_median();
+
+private:
+  size_t exact_limit;
+  size_t count;
+  std::vector<double> values;
+  double heights[5];
+  double positions[5];
+  double desired[5];
+
+  void start_markers();
+  void add_to_markers(double value);
+  double parabolic(int i, double step) const;
+};
+
+// Gathers ColumnStats in one sweep: count, sum, min and max directly,
+// variance with Welford's update, and the median through a
+// MedianEstimator when asked for.
+class ColumnStatsAccumulator {
+public:
+  explicit ColumnStatsAccumulator(
+      bool track_median = false,
+      size_t exact_median_limit = MedianEstimator::default_exact_limit);
+
+  void add_value(double value);
+  // A valid cell that is not a number
+  void add_text();
+  void add_null();
+
+  // numeric is set when every valid cell was a number.
+  ColumnStats finish();
+
+private:
+  ColumnStats stats;
+  bool track_median;
+  double welford_mean;
+  double welford_m2;
+  MedianEstimator median;
+};
+
+// Statistics of a typed column; the median, when requested, is exact.
+ColumnStats compute_column_stats(const Column &column,
+                                 bool with_median = false);
+
+// Statistics of two disjoint sets of cells taken together; the variances
+// are pooled with Chan's update. Medians cannot be combined, so the result
+// keeps later's median, if any.
+ColumnStats merge_column_stats(const ColumnStats &earlier,
+                               const ColumnStats &later);
+
+} // namespace adapter
+
+#endif // ADAPTER_COLUMN_STATS_HPP
@@ -0,0 +1,70 @@
+#ifndef ADAPTER_COMPRESSED_STREAM_HPP
+#define ADAPTER_COMPRESSED_STREAM_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+enum class StreamCompression { NONE, GZIP, ZSTD };
+
+// Judged by the gzip and zstd magic numbers, so a renamed file still reads.
+StreamCompression detect_stream_compression(const char *data, size_t size);
+// .gz and .gzip are gzip, .zst and .zstd are zstd.
+StreamCompression stream_compression_for_path(const std::string &path);
+const char *stream_compression_name(StreamCompression compression);
+// gzip needs a build with ADAPTER_HAVE_ZLIB and zstd one with
+// ADAPTER_HAVE_ZSTD.
+bool stream_compression_available(StreamCompression compression);
+
+// Decodes a whole compressed file. Files made of independent blocks whose
+// sizes the format records, BGZF gzip (what CsvWriter and bgzip write) and
+// zstd frames that state their content size, are decoded on up to
+// thread_count threads straight into their place in output; anything else
+// is decoded serially.
+bool decompress_buffer(const char *data, size_t size,
+                       StreamCompression compression,
+                       std::vector<char> &output, size_t thread_count = 1);
+
+// Incremental decoder for reading through a fixed buffer. Concatenated
+// gzip members and zstd frames decode as one stream.
+class StreamDecompressor {
+public:
+  virtual ~StreamDecompressor() = default;
+
+  // Starts over on a new stream.
+  virtual void reset() = 0;
+  // Consumes from input, advancing it, and writes up to output_size bytes.
+  // Output still buffered inside the decoder comes out even when input is
+  // empty; no progress with room left means more input is needed. Returns
+  // false on corrupt data.
+  virtual bool decompress(const char *&input, const char *input_end,
+                          char *output, size_t output_size,
+                          size_t &produced) = 0;
+  // Whether the input so far ended on a member or frame boundary, which
+  // tells a complete file from a truncated one.
+  virtual bool finished() const = 0;
+};
+
+// Encoder for CsvWriter. Each call compresses its data as independent
+// blocks that record their own sizes, so the output decodes in parallel.
+class StreamCompressor {
+public:
+  virtual ~StreamCompressor() = default;
+
+  // Appends the compressed data to output; final ends the stream.
+  virtual bool compress(const char *data, size_t size, bool final,
+                        std::vector<char> &output) = 0;
+};
+
+// Both return nullptr for NONE or a format this build lacks.
+std::unique_ptr<StreamDecompressor>
+make_stream_decompressor(StreamCompression compression);
+std::unique_ptr<StreamCompressor>
+make_stream_compressor(StreamCompression compression);
+
+} // namespace adapter
+
+#endif // ADAPTER_COMPRESSED_STREAM_HPP
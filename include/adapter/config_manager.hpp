@@ -1,6 +1,7 @@
 #ifndef ADAPTER_CONFIG_MANAGER_HPP
 #define ADAPTER_CONFIG_MANAGER_HPP
 
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -22,6 +23,11 @@ public:
   void set_time_column(const std::string &column_name);
   void set_delimiter(char delimiter);
   void set_target_time_interval(double interval);
+  void set_thread_count(size_t count);
+  void set_snapshot_file(const std::string &filename);
+  void set_project_columns(bool enabled);
+  void set_state_file(const std::string &filename);
+  void set_output_format(const std::string &format);
 
   std::string get_input_file() const;
   std::string get_output_file() const;
@@ -30,6 +36,44 @@ public:
   std::string get_time_column() const;
   char get_delimiter() const;
   double get_target_time_interval() const;
+  std::string get_solver_method() const;
+  std::string get_spline_boundary() const;
+  std::vector<std::string> get_derivative_columns() const;
+  // Seconds between samples beyond which the aligner leaves nulls; 0 = off.
+  double get_max_gap() const;
+  // none, mean, min, max or last; see TimeAligner::set_aggregation.
+  std::string get_aggregation() const;
+  int get_numeric_precision() const;
+  // See DataCleaner::set_missing_value_strategies.
+  std::vector<std::string> get_missing_value_strategies() const;
+  // column:kind pairs fixing a column's kind; see InferenceOptions.
+  std::vector<std::string> get_column_types() const;
+  // Rows type inference samples (0 = all), or the fraction of them when
+  // infer_sample_fraction is above 0.
+  size_t get_infer_sample_rows() const;
+  double get_infer_sample_fraction() const;
+  std::vector<std::string> get_dedup_key_columns() const;
+  bool get_dedup_verify() const;
+  // Worker threads for parsing, cleaning and alignment; 0 means all cores.
+  size_t get_thread_count() const;
+  // Write output files with O_DIRECT, bypassing the page cache.
+  bool get_direct_io() const;
+  // Batches queued between the stream mode's read, clean and write
+  // threads; 0 runs them one after another on one thread.
+  size_t get_pipeline_depth() const;
+  // Binary snapshot of the parsed input, reused while the input is
+  // unchanged; empty disables it.
+  std::string get_snapshot_file() const;
+  // none or zlib.
+  std::string get_snapshot_compression() const;
+  // Parse only the columns the job references (time, dependent,
+  // independent, derivative and dedup key columns).
+  bool get_project_columns() const;
+  // State kept between incremental runs over a growing input; empty means
+  // every run processes the whole file.
+  std::string get_state_file() const;
+  // csv, or arrow (also accepted as feather) for an Arrow IPC file.
+  std::string get_output_format() const;
 
   void print_configuration() const;
 
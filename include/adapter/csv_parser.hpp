@@ -1,8 +1,12 @@
 #ifndef ADAPTER_CSV_PARSER_HPP
 #define ADAPTER_CSV_PARSER_HPP
 
+#include "adapter/structural_scanner.hpp"
+#include "adapter/table.hpp"
+#include "adapter/table_snapshot.hpp"
+#include <cstddef>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace adapter {
@@ -15,25 +19,100 @@ public:
   bool load_file(const std::string &filename);
   bool parse_data();
 
-  std::vector<std::string> get_headers() const;
+  const std::vector<std::string> &get_headers() const;
+  // Row-major copies of the parsed cells as text.
   std::vector<std::vector<std::string>> get_data() const;
   std::vector<std::string> get_column(const std::string &column_name) const;
+  const Table &get_table() const;
+  // Moves the parsed table out without copying; the parser keeps its
+  // headers but holds no rows afterwards.
+  Table take_table();
 
   size_t get_row_count() const;
   size_t get_column_count() const;
+  // Counts from the last load_file.
+  size_t get_malformed_count() const;
+  size_t get_bytes_read() const;
 
   void set_delimiter(char delimiter);
+  // Files of at least min_parallel_bytes are split into record-aligned
+  // chunks and parsed on this many threads.
+  void set_thread_count(size_t count);
+  size_t get_thread_count() const;
+
+  // With a snapshot file set, load_file reads the table from it when it
+  // was built from the same source, and otherwise parses the CSV and
+  // writes a fresh snapshot.
+  void set_snapshot_file(const std::string &path);
+  void set_snapshot_compression(SnapshotCompression compression);
+  bool is_from_snapshot() const;
+
+  // Limits the table to the named columns, kept in file order. Fields of
+  // other columns are tokenized but never copied or typed. Names missing
+  // from the header are reported and ignored; an empty list keeps every
+  // column. Snapshots always hold every column and are projected on load.
+  void set_projection(const std::vector<std::string> &columns);
+
+  // Parses only the records from this byte offset on (the header row is
+  // still read from the start) and stops after the last complete line, so
+  // a record still being written is left for a later load. Snapshots are
+  // not used for such partial loads.
+  void set_start_offset(size_t offset);
+  // Where the records parsed by the last load_file end; parsing the whole
+  // file ends at its size.
+  size_t get_end_offset() const;
+  // Types the table's columns (after projection) with this schema instead
+  // of inferring it from the rows; empty restores inference.
+  void set_schema(const std::vector<ColumnSchema> &schema);
+  // Sampling and per-column kinds for inference. A snapshot whose column
+  // types disagree with the fixed kinds is parsed again.
+  void set_inference(const InferenceOptions &options);
+
+  static constexpr size_t min_parallel_bytes = 1 << 20;
 
 private:
+  struct ChunkResult {
+    TableBuilder builder;
+    size_t record_count = 0;
+    // (record index within the chunk, cell count)
+    std::vector<std::pair<size_t, size_t>> malformed_rows;
+  };
+
   std::string filename;
   char delimiter;
+  size_t thread_count;
+  size_t malformed_count;
+  size_t bytes_read;
+  std::string snapshot_file;
+  SnapshotCompression snapshot_compression;
+  bool from_snapshot;
+  std::vector<std::string> projection;
+  // Fields per record in the file, and the ones copied into the table
+  // (empty when every field is)
+  size_t field_count;
+  std::vector<size_t> projected_fields;
+  bool partial;
+  size_t start_offset;
+  size_t end_offset;
+  std::vector<ColumnSchema> schema;
+  InferenceOptions inference;
   std::vector<std::string> headers;
-  std::vector<std::vector<std::string>> data;
-  std::unordered_map<std::string, size_t> column_indices;
+  Table table;
+  // Kept between loads, so a parser reused for many files refills the
+  // same arena blocks instead of allocating new ones for every file
+  std::vector<ChunkResult> chunks;
 
-  void parse_headers(const std::string &line);
+  bool load_snapshot(const SnapshotSource &source);
+  // Fills projected_fields from the file's header row.
+  void resolve_projection(const std::vector<std::string> &file_headers);
+  void project_table();
   std::vector<std::string> split_line(const std::string &line) const;
-  void build_column_indices();
+  void parse_records(const char *begin, const char *end,
+                     const StructuralScanner &scanner,
+                     ChunkResult &result) const;
+  std::vector<size_t>
+  find_chunk_boundaries(const char *data, size_t begin, size_t end,
+                        const StructuralScanner &scanner) const;
 };
 
 } // namespace adapter
@@ -0,0 +1,82 @@
+#ifndef ADAPTER_CSV_STREAM_READER_HPP
+#define ADAPTER_CSV_STREAM_READER_HPP
+
+#include "adapter/compressed_stream.hpp"
+#include "adapter/csv_tokenizer.hpp"
+#include "adapter/structural_scanner.hpp"
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace adapter {
+
+// Reads a CSV file record by record through a fixed-size buffer, so memory
+// use depends on the buffer and batch size rather than the file size.
+// gzip and zstd files are decoded on the fly as the buffer fills.
+class CsvStreamReader {
+public:
+  CsvStreamReader();
+  ~CsvStreamReader();
+
+  CsvStreamReader(const CsvStreamReader &) = delete;
+  CsvStreamReader &operator=(const CsvStreamReader &) = delete;
+
+  bool open(const std::string &filename, char delimiter);
+  void close();
+  // Restarts at the first data record.
+  bool rewind();
+
+  const std::vector<std::string> &get_headers() const;
+  void set_buffer_size(size_t bytes);
+
+  // Cells stay valid until the next call.
+  bool next_record(std::vector<std::string_view> &cells);
+  // Like next_record, but skips (and by default reports) rows whose cell
+  // count differs from the header.
+  bool next_row(std::vector<std::string_view> &cells);
+  // Appends up to max_rows well-formed rows and returns how many it added.
+  size_t read_batch(TableBuilder &builder, size_t max_rows);
+  void set_report_malformed(bool report);
+
+  size_t get_record_count() const;
+  size_t get_malformed_count() const;
+  // CSV bytes read since open(), across rewinds, counted after decoding.
+  size_t get_bytes_read() const;
+  StreamCompression get_compression() const;
+
+private:
+  int fd;
+  size_t buffer_size;
+  std::vector<char> buffer;
+  size_t region_end;
+  size_t buffer_end;
+  bool at_eof;
+  StructuralScanner scanner;
+  std::unique_ptr<CsvTokenizer> tokenizer;
+  std::vector<std::string> headers;
+  std::vector<std::string_view> batch_cells;
+  size_t record_count;
+  size_t malformed_count;
+  size_t bytes_read;
+  bool report_malformed;
+  StreamCompression compression;
+  std::unique_ptr<StreamDecompressor> decompressor;
+  // Compressed bytes read from the file but not yet decoded
+  std::vector<char> compressed;
+  size_t compressed_begin;
+  size_t compressed_end;
+  bool source_eof;
+
+  bool fill();
+  // Like ::read, but through the decompressor if there is one.
+  ssize_t read_source(char *destination, size_t size);
+  bool read_headers();
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_CSV_STREAM_READER_HPP
@@ -0,0 +1,65 @@
+#ifndef ADAPTER_CSV_TOKENIZER_HPP
+#define ADAPTER_CSV_TOKENIZER_HPP
+
+#include "adapter/structural_scanner.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adapter {
+
+// Splits a character buffer into records and cells without copying.
+// Cells are string_views into the buffer; only cells whose quotes need
+// unescaping are materialized, in scratch space that stays valid until the
+// next call to next_record(). Structural characters are located with
+// StructuralScanner one 64-byte block at a time.
+class CsvTokenizer {
+public:
+  CsvTokenizer(const char *begin, const char *end, char delimiter);
+  CsvTokenizer(const char *begin, const char *end,
+               const StructuralScanner &scanner);
+
+  bool next_record(std::vector<std::string_view> &cells);
+  size_t get_offset() const;
+
+private:
+  struct ScratchCell {
+    size_t index;
+    size_t offset;
+    size_t length;
+  };
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  const char *begin;
+  size_t length;
+  size_t cursor;
+  StructuralScanner scanner;
+
+  // Scan state of the current block
+  bool block_loaded;
+  size_t block_offset;
+  uint64_t structural_bits;
+  uint64_t quote_bits;
+  uint64_t quote_carry;
+  size_t last_quote;
+
+  std::string scratch;
+  std::vector<ScratchCell> scratch_cells;
+
+  bool next_structural(size_t &position);
+  bool load_next_block();
+  void add_cell(std::vector<std::string_view> &cells, size_t cell_begin,
+                size_t cell_end);
+};
+
+// Offset just past the last unquoted newline in [begin, end), or 0 if the
+// buffer holds no complete record. begin must be a record boundary.
+size_t find_last_record_end(const char *begin, const char *end,
+                            const StructuralScanner &scanner);
+
+} // namespace adapter
+
+#endif // ADAPTER_CSV_TOKENIZER_HPP
@@ -0,0 +1,89 @@
+#ifndef ADAPTER_CSV_WRITER_HPP
+#define ADAPTER_CSV_WRITER_HPP
+
+#include "adapter/compressed_stream.hpp"
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adapter {
+
+// Writes tables as CSV through one large user-space buffer. Numbers are
+// formatted with std::to_chars straight into the buffer and string columns
+// are escaped once per dictionary entry, so writing a row allocates
+// nothing. Fields containing the delimiter, a quote or a line break are
+// quoted with embedded quotes doubled, and read back unchanged by
+// CsvParser. A filename ending in .gz or .zst compresses the output one
+// buffer at a time into independently decodable blocks.
+class CsvWriter {
+public:
+  static constexpr size_t default_buffer_size = 1 << 20;
+
+  CsvWriter();
+  ~CsvWriter();
+
+  CsvWriter(const CsvWriter &) = delete;
+  CsvWriter &operator=(const CsvWriter &) = delete;
+
+  // Both take effect at the next open(). The buffer is rounded up to the
+  // direct I/O block size.
+  void set_buffer_size(size_t bytes);
+  // Bypass the page cache with O_DIRECT. Falls back to buffered writes when
+  // the platform or file system does not support it.
+  void set_direct_io(bool enabled);
+
+  // Appending keeps what the file holds and always writes through the page
+  // cache, since O_DIRECT needs block-aligned file offsets. Compressed
+  // output does too, and appends a new gzip member or zstd frame.
+  bool open(const std::string &filename, char delimiter, bool append = false);
+  // Flushes the buffer; returns false if any write failed.
+  bool close();
+  bool is_open() const;
+  bool is_direct() const;
+  StreamCompression get_compression() const;
+
+  bool write_header(const std::vector<std::string> &headers);
+  bool write_row(const std::vector<std::string> &cells);
+  bool write_table(const Table &table);
+
+  size_t get_rows_written() const;
+  // Bytes that reached the file, after compression.
+  size_t get_bytes_written() const;
+
+private:
+  int fd;
+  bool direct;
+  bool direct_requested;
+  bool failed;
+  char delimiter;
+  size_t rows_written;
+  size_t bytes_written;
+  size_t buffer_size;
+  // Backing store for the block-aligned buffer
+  std::vector<char> storage;
+  char *buffer;
+  size_t used;
+  StreamCompression compression;
+  std::unique_ptr<StreamCompressor> compressor;
+  std::vector<char> compressed;
+
+  bool needs_quotes(std::string_view field) const;
+  std::string escape(std::string_view field) const;
+  void append_field(std::string_view field);
+  void append(const char *data, size_t size);
+  // Makes room for at least size contiguous bytes.
+  char *reserve(size_t size);
+  // A final flush writes everything; otherwise direct I/O keeps the
+  // partial trailing block in the buffer.
+  void flush(bool final);
+  void write_fully(const char *data, size_t size);
+  void write_two(const char *first, size_t first_size, const char *second,
+                 size_t second_size);
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_CSV_WRITER_HPP
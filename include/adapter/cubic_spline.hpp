@@ -0,0 +1,48 @@
+#ifndef ADAPTER_CUBIC_SPLINE_HPP
+#define ADAPTER_CUBIC_SPLINE_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace adapter {
+
+enum class SplineBoundary { NATURAL, CLAMPED };
+
+// Interpolating cubic spline. Coefficients for every segment are solved
+// once with the Thomas algorithm and kept in separate contiguous arrays, so
+// evaluating a whole grid is a cursor walk followed by a flat polynomial
+// loop.
+class CubicSpline {
+public:
+  CubicSpline();
+
+  // x must be strictly increasing. Clamped splines take their end slopes
+  // from the first and last secant when none are given.
+  bool fit(const std::vector<double> &x, const std::vector<double> &y,
+           SplineBoundary boundary = SplineBoundary::NATURAL);
+  bool fit(const std::vector<double> &x, const std::vector<double> &y,
+           double start_slope, double end_slope);
+
+  // Evaluates at ascending targets; outside the knots the end values hold.
+  void evaluate(const std::vector<double> &targets,
+                std::vector<double> &values) const;
+  // Single-point evaluation for non-decreasing t; cursor starts at 0.
+  double evaluate_at(double t, size_t &cursor) const;
+
+  size_t get_knot_count() const;
+
+private:
+  std::vector<double> knots;
+  std::vector<double> a;
+  std::vector<double> b;
+  std::vector<double> c;
+  std::vector<double> d;
+
+  bool solve(const std::vector<double> &x, const std::vector<double> &y,
+             bool clamped, double start_slope, double end_slope);
+  size_t find_segment(double t, size_t cursor) const;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_CUBIC_SPLINE_HPP
@@ -1,13 +1,45 @@
 #ifndef ADAPTER_DATA_CLEANER_HPP
 #define ADAPTER_DATA_CLEANER_HPP
 
-#include <set>
+#include "adapter/column_stats.hpp"
+#include "adapter/row_deduplicator.hpp"
+#include "adapter/table.hpp"
+#include "adapter/table_stage.hpp"
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
 namespace adapter {
 
-class DataCleaner {
+enum class MissingValueStrategy { NONE, MEAN, MEDIAN, ZERO };
+
+const char *missing_value_strategy_name(MissingValueStrategy strategy);
+// mean, median and zero; none and the empty name turn imputation off, and
+// any other name fills with zero.
+MissingValueStrategy parse_missing_value_strategy(const std::string &name);
+
+// One missing_value_strategies entry, for the named column or, with no
+// name, by position.
+struct MissingValueRule {
+  std::string column;
+  MissingValueStrategy strategy = MissingValueStrategy::NONE;
+};
+
+std::vector<MissingValueRule>
+parse_missing_value_rules(const std::vector<std::string> &entries);
+
+// Replacement for the null cells of one column.
+struct MissingValueFill {
+  bool enabled = false;
+  bool numeric = false;
+  // Strategy that produced the value, for reporting
+  MissingValueStrategy strategy = MissingValueStrategy::NONE;
+  double numeric_value = 0.0;
+  std::string text_value;
+};
+
+class DataCleaner : public TableStage {
 public:
   DataCleaner();
   ~DataCleaner();
@@ -17,22 +49,74 @@ public:
   void handle_missing_values(std::vector<std::vector<std::string>> &data);
   void normalize_formats(std::vector<std::vector<std::string>> &data);
 
+  void clean_data(Table &table);
+  void remove_duplicate_rows(Table &table);
+  void handle_missing_values(Table &table);
+  void normalize_formats(Table &table);
+
+  // Runs clean_data as a pipeline stage.
+  std::string get_stage_name() const override;
+  bool apply(Table &table) override;
+
+  // Fill for a column from its whole-column statistics; streaming runs
+  // gather these in a separate pass before any batch is cleaned.
+  MissingValueFill make_missing_value_fill(const ColumnStats &stats,
+                                           size_t column,
+                                           const std::string &column_name) const;
+  // Returns the number of cells filled; imputed, when given, is increased
+  // by the count for each fill strategy.
+  size_t fill_missing_values(
+      Table &table, const std::vector<MissingValueFill> &fills,
+      std::map<std::string, size_t> *imputed = nullptr) const;
+
+  // Entries are mean, median, zero or none. "column:strategy" applies to
+  // the named column; other entries apply by position, the last of them
+  // to every remaining column. Columns matching no entry are not imputed.
   void set_missing_value_strategies(const std::vector<std::string> &strategies);
+  void set_missing_value_rules(const std::vector<MissingValueRule> &rules);
+  MissingValueStrategy
+  resolve_missing_value_strategy(size_t column,
+                                 const std::string &column_name) const;
+  // The name of the resolved strategy.
+  std::string get_missing_value_strategy(size_t column,
+                                         const std::string &column_name) const;
   void set_date_format(const std::string &format);
   void set_numeric_precision(int precision);
+  // Rows count as duplicates when these columns match; empty means all.
+  void set_dedup_key_columns(const std::vector<std::string> &columns);
+  // Compare rows cell by cell when their fingerprints collide.
+  void set_dedup_verify(bool verify);
+  // Columns are imputed and normalized on this many threads. The result
+  // does not depend on the count.
+  void set_thread_count(size_t count);
+  size_t get_thread_count() const;
+
+  // A deduplicator configured like this cleaner, e.g. for streaming runs.
+  RowDeduplicator make_deduplicator() const;
+
+  // Counts from the last Table clean; each call to a step resets its own.
+  size_t get_duplicates_removed() const;
+  const std::map<std::string, size_t> &get_imputed_cells() const;
+  // Per-column statistics gathered for imputation, before any cell was
+  // filled.
+  const std::vector<ColumnStats> &get_column_stats() const;
 
 private:
-  std::vector<std::string> missing_value_strategies;
+  std::vector<MissingValueRule> missing_value_rules;
   std::string date_format;
   int numeric_precision;
+  std::vector<std::string> dedup_key_columns;
+  bool dedup_verify;
+  size_t thread_count;
+  size_t duplicates_removed;
+  std::map<std::string, size_t> imputed_cells;
+  std::vector<ColumnStats> column_stats;
 
-  bool is_numeric(const std::string &value) const;
-  bool is_date(const std::string &value) const;
-  bool is_numeric_column(const std::vector<std::string> &column) const;
-  std::string normalize_date_format(const std::string &value) const;
-  std::string normalize_numeric_format(const std::string &value) const;
-  std::string calculate_mean(const std::vector<std::string> &column) const;
-  std::string calculate_median(const std::vector<std::string> &column) const;
+  // Runs body(col) for every column, in parallel when more than one thread
+  // is configured. Each call must only touch its own column.
+  void for_each_column(size_t column_count,
+                       const std::function<void(size_t)> &body) const;
+  double round_to_precision(double value) const;
 };
 
 } // namespace adapter
@@ -0,0 +1,85 @@
+#ifndef ADAPTER_INCREMENTAL_PIPELINE_HPP
+#define ADAPTER_INCREMENTAL_PIPELINE_HPP
+
+#include "adapter/data_cleaner.hpp"
+#include "adapter/incremental_state.hpp"
+#include "adapter/table.hpp"
+#include "adapter/time_aligner.hpp"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+// Processes a CSV that only ever grows. Each run parses the records
+// appended since the last one, cleans them against the state that run
+// saved, and appends the result to the output, so a job over a growing log
+// costs time in proportion to what was added. The first run, or any run
+// whose source or output no longer matches the state, starts over.
+//
+// Rows are deduplicated against every earlier row and mean imputation uses
+// the statistics of all rows so far; medians cover the new rows only. The
+// first run fixes each column's type. With alignment, the grid continues
+// from the last point written, interpolating across the boundary from the
+// saved tail samples; the last aggregation bucket is held back until a
+// later sample closes it, and spline fits only see the tail and new rows.
+class IncrementalPipeline {
+public:
+  IncrementalPipeline();
+
+  void set_delimiter(char delimiter);
+  void set_projection(const std::vector<std::string> &columns);
+  void set_thread_count(size_t count);
+  // See CsvParser::set_inference.
+  void set_inference(const InferenceOptions &options);
+  void set_direct_io(bool enabled);
+
+  // aligner, when given, is configured for the job; its grid origin is set
+  // here.
+  bool run(const std::string &input_file, const std::string &output_file,
+           const std::string &state_file, DataCleaner &cleaner,
+           TimeAligner *aligner = nullptr);
+
+  // Counts from the last run.
+  bool was_resumed() const;
+  size_t get_rows_read() const;
+  size_t get_rows_written() const;
+  size_t get_malformed_count() const;
+  size_t get_duplicates_removed() const;
+  const std::map<std::string, size_t> &get_imputed_cells() const;
+  size_t get_bytes_read() const;
+  size_t get_bytes_written() const;
+
+private:
+  char delimiter;
+  std::vector<std::string> projection;
+  InferenceOptions inference;
+  size_t thread_count;
+  bool direct_io;
+  bool resumed;
+  size_t rows_read;
+  size_t rows_written;
+  size_t malformed_count;
+  size_t duplicates_removed;
+  size_t bytes_read;
+  size_t bytes_written;
+  std::map<std::string, size_t> imputed_cells;
+
+  // Loads the state and checks it still describes the source and output;
+  // otherwise state is reset for a fresh run.
+  bool load_state(const std::string &input_file,
+                  const std::string &output_file,
+                  const std::string &state_file,
+                  IncrementalState &state) const;
+  bool parse(const std::string &input_file, IncrementalState &state,
+             Table &table, size_t &end_offset);
+  void clean(Table &table, DataCleaner &cleaner, IncrementalState &state);
+  // Aligns the tail and the new rows, keeping only grid points not written
+  // before and saving the new tail.
+  bool align(Table &table, TimeAligner &aligner, IncrementalState &state);
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_INCREMENTAL_PIPELINE_HPP
@@ -0,0 +1,58 @@
+#ifndef ADAPTER_INCREMENTAL_STATE_HPP
+#define ADAPTER_INCREMENTAL_STATE_HPP
+
+#include "adapter/column_stats.hpp"
+#include "adapter/row_deduplicator.hpp"
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace adapter {
+
+// What an incremental run leaves for the next one: how far into the source
+// it got, fingerprints of the distinct rows so far, the column statistics
+// behind mean imputation, and where the aligned grid stopped together with
+// the cleaned samples the next grid points are interpolated from.
+struct IncrementalState {
+  // Bytes of the source already processed, and a hash of the bytes before
+  // that point which tells an appended file from a rewritten one
+  uint64_t source_offset = 0;
+  uint64_t source_hash = 0;
+  char delimiter = ',';
+  // Size of the output after the last run; an output changed since then
+  // is rebuilt from scratch
+  uint64_t output_size = 0;
+  // Parsed columns and the types the first run gave them
+  std::vector<std::string> headers;
+  std::vector<ColumnSchema> schema;
+  // Per parsed column, over every distinct row so far
+  std::vector<ColumnStats> stats;
+  std::vector<RowFingerprint> fingerprints;
+  // Last grid point written, and each integral column's value there
+  bool has_grid = false;
+  double grid_time = 0.0;
+  std::vector<std::pair<std::string, double>> integrals;
+  // Cleaned rows from the last sample at or before grid_time onwards
+  Table tail;
+};
+
+// Source bytes covered by the hash: this many at the start of the file and
+// this many just before the offset.
+constexpr size_t incremental_check_bytes = 1 << 16;
+
+// Fails when the file is missing or shorter than offset.
+bool hash_incremental_source(const std::string &csv_file, uint64_t offset,
+                             uint64_t &hash);
+// Writes through a temporary file that is renamed into place, so a failed
+// run leaves the previous state intact.
+bool write_incremental_state(const IncrementalState &state,
+                             const std::string &path);
+// Fails, leaving state empty, when the file is missing or damaged.
+bool read_incremental_state(const std::string &path, IncrementalState &state);
+
+} // namespace adapter
+
+#endif // ADAPTER_INCREMENTAL_STATE_HPP
@@ -0,0 +1,49 @@
+#ifndef ADAPTER_MAPPED_FILE_HPP
+#define ADAPTER_MAPPED_FILE_HPP
+
+#include "adapter/compressed_stream.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+// Read-only view of a whole file. Regular files are memory-mapped so the
+// page cache backs the contents; anything that cannot be mapped is read
+// into a private buffer instead.
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  bool open(const std::string &filename);
+  // Like open, but a gzip or zstd file, recognised by its magic number, is
+  // decoded into the private buffer on up to thread_count threads.
+  bool open_decompressed(const std::string &filename, size_t thread_count = 1);
+  void close();
+
+  bool is_open() const;
+  bool is_mapped() const;
+  const char *data() const;
+  size_t size() const;
+  // How the file on disk was compressed; data() is always decoded.
+  StreamCompression get_compression() const;
+
+private:
+  bool opened;
+  void *mapping;
+  size_t length;
+  std::vector<char> buffer;
+  StreamCompression compression;
+
+  bool read_into_buffer(int fd);
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_MAPPED_FILE_HPP
@@ -0,0 +1,98 @@
+#ifndef ADAPTER_MERGE_ALIGNER_HPP
+#define ADAPTER_MERGE_ALIGNER_HPP
+
+#include "adapter/csv_stream_reader.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adapter {
+
+// Aligns several CSV files, one per sensor, onto a single uniform grid in
+// one streaming pass. Every file must be sorted by its own time column;
+// samples from all of them are merged in time order through a min-heap,
+// and each grid point is written as soon as every file has a sample at or
+// after it. Memory is one read buffer and two samples per file, however
+// long the files are.
+//
+// The output holds the time column followed by every other column of each
+// file in input order. Names that occur in more than one file are prefixed
+// with the file's stem ("left.temp"). Numeric values are interpolated
+// linearly and text takes the nearest sample; grid points outside a file's
+// time range, or inside a gap longer than max_gap, are left empty.
+class MergeAligner {
+public:
+  MergeAligner();
+  ~MergeAligner();
+
+  void set_delimiter(char delimiter);
+  void set_time_column(const std::string &name);
+  void set_target_time_interval(double interval_seconds);
+  // 0 disables the gap check.
+  void set_max_gap(double seconds);
+  // Read buffer per input file.
+  void set_buffer_size(size_t bytes);
+  void set_direct_io(bool enabled);
+
+  bool run(const std::vector<std::string> &input_files,
+           const std::string &output_file);
+
+  // Counts from the last run.
+  size_t get_rows_read() const;
+  size_t get_rows_written() const;
+  size_t get_malformed_count() const;
+  size_t get_unparsed_time_count() const;
+  // Samples dropped because their time went backwards within a file
+  size_t get_out_of_order_count() const;
+  size_t get_bytes_read() const;
+  size_t get_bytes_written() const;
+
+private:
+  struct Sample {
+    double time = 0.0;
+    std::vector<std::string> cells;
+    std::vector<double> numbers;
+    std::vector<char> numeric;
+  };
+
+  struct Source {
+    std::string filename;
+    std::unique_ptr<CsvStreamReader> reader;
+    size_t time_field = 0;
+    std::vector<size_t> value_fields;
+    std::vector<std::string_view> cells;
+    Sample previous;
+    Sample next;
+    bool has_previous = false;
+    bool has_next = false;
+  };
+
+  char delimiter;
+  std::string time_column;
+  double target_time_interval;
+  double max_gap;
+  size_t buffer_size;
+  bool direct_io;
+  size_t rows_read;
+  size_t rows_written;
+  size_t malformed_count;
+  size_t unparsed_time_count;
+  size_t out_of_order_count;
+  size_t bytes_read;
+  size_t bytes_written;
+
+  bool open_sources(const std::vector<std::string> &input_files,
+                    std::vector<Source> &sources,
+                    std::vector<std::string> &headers) const;
+  // Reads the next sample of the source into its next slot.
+  bool read_sample(Source &source);
+  // Appends the source's cells for grid time t to row.
+  void fill_row(const Source &source, double t,
+                std::vector<std::string> &row) const;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_MERGE_ALIGNER_HPP
@@ -0,0 +1,98 @@
+#ifndef ADAPTER_METRICS_HPP
+#define ADAPTER_METRICS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+enum class MetricsFormat { TABLE, JSON, PROMETHEUS };
+
+// A named count with at most one label, e.g. cells_imputed{strategy=mean}.
+struct MetricCounter {
+  std::string name;
+  std::string label_name;
+  std::string label_value;
+  uint64_t value = 0;
+};
+
+struct StageMetrics {
+  std::string name;
+  double wall_seconds = 0.0;
+  // User plus system time of the whole process, all threads included
+  double cpu_seconds = 0.0;
+  // Process high-water mark at the end of the stage
+  size_t peak_rss_bytes = 0;
+  size_t bytes_read = 0;
+  size_t bytes_written = 0;
+  size_t rows_in = 0;
+  size_t rows_out = 0;
+  std::vector<MetricCounter> counters;
+};
+
+// Records wall time, CPU time and peak memory per pipeline stage, along
+// with byte, row and event counts the stages report. Components expose
+// their counts through getters; the caller copies them in, so the library
+// itself never depends on a Metrics instance. Not thread-safe.
+class Metrics {
+public:
+  Metrics();
+
+  // Starts timing a new stage and returns its index.
+  size_t begin_stage(const std::string &name);
+  void end_stage(size_t stage);
+
+  StageMetrics &get_stage(size_t stage);
+  const std::vector<StageMetrics> &get_stages() const;
+  // Adds to the counter, creating it on first use.
+  void add_counter(size_t stage, const std::string &name, uint64_t value,
+                   const std::string &label_name = "",
+                   const std::string &label_value = "");
+  // Adds another run's stages to the stages of the same name, appending
+  // the ones this has not seen. Times, bytes, rows and counters are summed
+  // and peak RSS is the larger of the two.
+  void merge(const Metrics &other);
+
+  std::string format(MetricsFormat format) const;
+  std::string to_table() const;
+  std::string to_json() const;
+  std::string to_prometheus() const;
+
+  // Accepts table, json and prometheus.
+  static bool parse_format(const std::string &name, MetricsFormat &format);
+  static double process_cpu_seconds();
+  static size_t peak_rss_bytes();
+
+private:
+  struct OpenStage {
+    std::chrono::steady_clock::time_point wall_start;
+    double cpu_start = 0.0;
+  };
+
+  std::vector<StageMetrics> stages;
+  std::vector<OpenStage> open_stages;
+};
+
+// Times one stage for the lifetime of the object.
+class ScopedStage {
+public:
+  ScopedStage(Metrics &metrics, const std::string &name);
+  ~ScopedStage();
+
+  ScopedStage(const ScopedStage &) = delete;
+  ScopedStage &operator=(const ScopedStage &) = delete;
+
+  size_t index() const;
+  StageMetrics &stage();
+
+private:
+  Metrics &metrics;
+  size_t stage_index;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_METRICS_HPP
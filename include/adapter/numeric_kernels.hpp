@@ -0,0 +1,21 @@
+#ifndef ADAPTER_NUMERIC_KERNELS_HPP
+#define ADAPTER_NUMERIC_KERNELS_HPP
+
+#include "adapter/structural_scanner.hpp"
+#include <cstddef>
+
+namespace adapter {
+
+// Rounds every value to `precision` decimal places, halves away from zero,
+// exactly as std::round(value * 10^precision) / 10^precision would. NaN and
+// infinities pass through unchanged. Whole arrays are processed with SSE4.1
+// or AVX where the CPU has them, using the same kernel levels (and the
+// same ADAPTER_SIMD cap) as the structural scanner.
+void round_to_precision(double *values, size_t count, int precision);
+// Runs the given kernel, which must be supported by the CPU.
+void round_to_precision(double *values, size_t count, int precision,
+                        ScannerKernel kernel);
+
+} // namespace adapter
+
+#endif // ADAPTER_NUMERIC_KERNELS_HPP
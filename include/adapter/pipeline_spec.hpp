@@ -0,0 +1,67 @@
+#ifndef ADAPTER_PIPELINE_SPEC_HPP
+#define ADAPTER_PIPELINE_SPEC_HPP
+
+#include "adapter/arrow_writer.hpp"
+#include "adapter/config_manager.hpp"
+#include "adapter/cubic_spline.hpp"
+#include "adapter/data_cleaner.hpp"
+#include "adapter/table.hpp"
+#include "adapter/table_snapshot.hpp"
+#include "adapter/time_aligner.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+// A run's settings, read from the configuration once and resolved into
+// typed values. Stages are configured from it, so none of them looks a
+// setting up or compares a name while it works.
+struct PipelineSpec {
+  // Parsing and output
+  char delimiter = ',';
+  size_t thread_count = 1;
+  bool direct_io = false;
+  size_t pipeline_depth = 2;
+  std::string snapshot_file;
+  SnapshotCompression snapshot_compression = SnapshotCompression::NONE;
+  // Columns the job reads, or none when it needs every column
+  std::vector<std::string> projected_columns;
+  std::string state_file;
+  OutputFormat output_format = OutputFormat::CSV;
+  InferenceOptions inference;
+
+  // Cleaning
+  std::vector<MissingValueRule> missing_value_rules;
+  std::vector<std::string> dedup_key_columns;
+  bool dedup_verify = false;
+  int numeric_precision = 2;
+
+  // Alignment
+  std::string time_column;
+  std::vector<std::string> dependent_variables;
+  std::vector<std::string> independent_variables;
+  double target_time_interval = 1.0;
+  SolverMethod solver_method = SolverMethod::LINEAR_INTERPOLATION;
+  SplineBoundary spline_boundary = SplineBoundary::NATURAL;
+  ResampleAggregation aggregation = ResampleAggregation::NONE;
+  double max_gap = 0.0;
+  std::vector<std::string> derivative_columns;
+
+  void configure(DataCleaner &cleaner) const;
+  void configure(TimeAligner &aligner) const;
+};
+
+// Unknown solver, aggregation, snapshot compression and column kind names
+// are reported and replaced by their defaults. An unknown output format is
+// reported and fails, since it would write the wrong file.
+bool resolve_pipeline_spec(const ConfigManager &config, PipelineSpec &spec);
+
+// The input's name with its extension replaced by _cleaned.csv, or
+// _cleaned.arrow for Arrow output.
+std::string default_output_file(const std::string &input_file,
+                                OutputFormat format);
+
+} // namespace adapter
+
+#endif // ADAPTER_PIPELINE_SPEC_HPP
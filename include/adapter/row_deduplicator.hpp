@@ -0,0 +1,81 @@
+#ifndef ADAPTER_ROW_DEDUPLICATOR_HPP
+#define ADAPTER_ROW_DEDUPLICATOR_HPP
+
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adapter {
+
+struct RowFingerprint {
+  uint64_t low;
+  uint64_t high;
+};
+
+// Detects repeated rows by hashing each row once into a 128-bit fingerprint.
+// Fingerprints are kept with the index of the row that produced them in an
+// open-addressing table, so no row is copied. With exact verification on,
+// rows whose fingerprints match are also compared cell by cell.
+//
+// Rows seen by earlier calls stay in the table, which lets a stream of
+// batches be deduplicated against everything before it.
+class RowDeduplicator {
+public:
+  RowDeduplicator();
+
+  // Only these columns decide whether two rows are equal; empty means all.
+  void set_key_columns(const std::vector<std::string> &columns);
+  const std::vector<std::string> &get_key_columns() const;
+  // Takes effect for rows added after the call.
+  void set_exact_verify(bool verify);
+  bool get_exact_verify() const;
+
+  void clear();
+  size_t get_unique_count() const;
+
+  // Removes rows that repeat an earlier row and returns how many it removed.
+  size_t deduplicate(Table &table);
+  // Row-based form; data[0] is the header row and is always kept.
+  size_t deduplicate(std::vector<std::vector<std::string>> &data);
+
+  // Streaming form: set_headers resolves the key columns, then insert
+  // returns true for the first occurrence of a row. Cells hash the way they
+  // will be typed (numbers by value, missing tokens as null). Rows are not
+  // retained, so these fingerprints are never verified.
+  void set_headers(const std::vector<std::string> &headers);
+  bool insert(const std::vector<std::string_view> &cells);
+
+  // Every fingerprint held, in slot order, for saving between runs.
+  // Fingerprints added back count as earlier input: rows matching them
+  // are dropped without verification.
+  std::vector<RowFingerprint> get_fingerprints() const;
+  void add_fingerprints(const std::vector<RowFingerprint> &fingerprints);
+
+private:
+  std::vector<std::string> key_columns;
+  std::vector<size_t> key_indices;
+  bool exact_verify;
+  // An all-zero fingerprint marks an empty slot. Row indices are only
+  // kept when exact verification needs them.
+  std::vector<RowFingerprint> slots;
+  std::vector<size_t> slot_rows;
+  size_t used;
+  // Global index of the first row of the current call; slots below it
+  // belong to earlier input and cannot be verified.
+  size_t row_base;
+  size_t next_row;
+
+  bool resolve_key_columns(const std::vector<std::string> &headers);
+  // Resizes the slot array so it can hold min_entries fingerprints.
+  void grow(size_t min_entries);
+  template <typename Equal>
+  bool insert_fingerprint(const RowFingerprint &fingerprint, size_t row,
+                          const Equal &equal);
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_ROW_DEDUPLICATOR_HPP
@@ -0,0 +1,51 @@
+#ifndef ADAPTER_SPAN_HPP
+#define ADAPTER_SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace adapter {
+
+// Non-owning view of a contiguous array, a small stand-in for C++20
+// std::span. The viewed storage must outlive the span and must not be
+// resized while it is in use.
+template <typename T> class Span {
+public:
+  using value_type = std::remove_cv_t<T>;
+
+  Span() : pointer(nullptr), length(0) {}
+  Span(T *data, size_t size) : pointer(data), length(size) {}
+  Span(std::vector<value_type> &values)
+      : pointer(values.data()), length(values.size()) {}
+  template <typename U = T,
+            typename = std::enable_if_t<std::is_const<U>::value>>
+  Span(const std::vector<value_type> &values)
+      : pointer(values.data()), length(values.size()) {}
+
+  T *data() const { return pointer; }
+  size_t size() const { return length; }
+  bool empty() const { return length == 0; }
+  T &operator[](size_t index) const { return pointer[index]; }
+  T *begin() const { return pointer; }
+  T *end() const { return pointer + length; }
+
+  // Clamped to the end of the view.
+  Span subspan(size_t offset, size_t count) const {
+    if (offset > length) {
+      offset = length;
+    }
+    if (count > length - offset) {
+      count = length - offset;
+    }
+    return Span(pointer + offset, count);
+  }
+
+private:
+  T *pointer;
+  size_t length;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_SPAN_HPP
@@ -0,0 +1,85 @@
+#ifndef ADAPTER_STREAM_PIPELINE_HPP
+#define ADAPTER_STREAM_PIPELINE_HPP
+
+#include "adapter/csv_stream_reader.hpp"
+#include "adapter/data_cleaner.hpp"
+#include "adapter/row_deduplicator.hpp"
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace adapter {
+
+// Cleans and writes a CSV file in fixed-size row batches. A first pass over
+// the file fixes each column's type and gathers the statistics that mean and
+// median imputation need; the second pass cleans and writes batch by batch.
+//
+// In the second pass a reader thread parses batches, the calling thread
+// cleans them and a writer thread writes them out, handing batches on
+// through bounded queues so reading, cleaning and writing overlap. Batches
+// keep their order, so the output does not depend on the queue depth.
+class StreamingPipeline {
+public:
+  static constexpr size_t default_batch_size = 65536;
+  static constexpr size_t default_queue_depth = 2;
+
+  StreamingPipeline();
+
+  void set_delimiter(char delimiter);
+  void set_batch_size(size_t rows);
+  size_t get_batch_size() const;
+  // Write the output with O_DIRECT where supported.
+  void set_direct_io(bool enabled);
+  // Batches each queue holds before its producer waits; 0 runs every stage
+  // on the calling thread.
+  void set_queue_depth(size_t batches);
+  size_t get_queue_depth() const;
+  // Only the fixed column kinds apply: the first pass already types each
+  // column from every row.
+  void set_inference(const InferenceOptions &options);
+
+  bool run(const std::string &input_file, const std::string &output_file,
+           DataCleaner &cleaner);
+
+  size_t get_rows_read() const;
+  size_t get_rows_written() const;
+  size_t get_batch_count() const;
+  size_t get_malformed_count() const;
+  size_t get_duplicates_removed() const;
+  // Cells filled per imputation strategy
+  const std::map<std::string, size_t> &get_imputed_cells() const;
+  // Input bytes over both passes, and output bytes
+  size_t get_bytes_read() const;
+  size_t get_bytes_written() const;
+  // Times the reader, and the cleaner, waited for the next stage
+  size_t get_reader_stalls() const;
+  size_t get_cleaner_stalls() const;
+
+private:
+  char delimiter;
+  size_t batch_size;
+  bool direct_io;
+  size_t queue_depth;
+  InferenceOptions inference;
+  size_t rows_read;
+  size_t rows_written;
+  size_t batch_count;
+  size_t malformed_count;
+  size_t duplicates_removed;
+  size_t bytes_read;
+  size_t bytes_written;
+  size_t reader_stalls;
+  size_t cleaner_stalls;
+  std::map<std::string, size_t> imputed_cells;
+
+  void collect_statistics(CsvStreamReader &reader, const DataCleaner &cleaner,
+                          RowDeduplicator &deduplicator,
+                          std::vector<ColumnSchema> &schema,
+                          std::vector<ColumnStats> &stats) const;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_STREAM_PIPELINE_HPP
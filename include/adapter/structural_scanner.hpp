@@ -0,0 +1,64 @@
+#ifndef ADAPTER_STRUCTURAL_SCANNER_HPP
+#define ADAPTER_STRUCTURAL_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace adapter {
+
+enum class ScannerKernel { SCALAR, SSE42, AVX2 };
+
+// Bit i of each mask is set when byte i of a 64-byte block is a quote,
+// delimiter or newline respectively.
+struct StructuralMasks {
+  uint64_t quotes;
+  uint64_t delimiters;
+  uint64_t newlines;
+};
+
+// Classifies CSV text 64 bytes at a time. The kernel is picked at runtime
+// from what the CPU supports, so binaries built without -march=native
+// still use the widest available instructions.
+class StructuralScanner {
+public:
+  static constexpr size_t block_size = 64;
+
+  explicit StructuralScanner(char delimiter);
+  StructuralScanner(char delimiter, ScannerKernel kernel);
+
+  // Scans exactly block_size bytes starting at data.
+  StructuralMasks scan_block(const char *data) const;
+  // Scans fewer than block_size bytes; the missing tail is treated as
+  // ordinary text.
+  StructuralMasks scan_partial_block(const char *data, size_t length) const;
+
+  ScannerKernel get_kernel() const;
+  char get_delimiter() const;
+
+  static ScannerKernel detect_kernel();
+  static bool is_kernel_supported(ScannerKernel kernel);
+  static const char *kernel_name(ScannerKernel kernel);
+
+private:
+  using ScanFunction = StructuralMasks (*)(const char *, char);
+
+  char delimiter;
+  ScannerKernel kernel;
+  ScanFunction scan_function;
+};
+
+// Bit i of the result is the XOR of bits 0..i of the input. Applied to a
+// quote mask it yields the bytes that sit inside a quoted region.
+inline uint64_t prefix_xor(uint64_t bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+} // namespace adapter
+
+#endif // ADAPTER_STRUCTURAL_SCANNER_HPP
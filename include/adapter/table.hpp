@@ -0,0 +1,231 @@
+#ifndef ADAPTER_TABLE_HPP
+#define ADAPTER_TABLE_HPP
+
+#include "adapter/cell_arena.hpp"
+#include "adapter/span.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace adapter {
+
+class ThreadPool;
+
+enum class ColumnType { INT64, FLOAT64, STRING };
+
+bool is_missing_token(std::string_view value);
+
+struct ColumnSchema {
+  ColumnType type = ColumnType::STRING;
+  int precision = -1;
+};
+
+// What a column holds, as opposed to how it is stored: INT and FLOAT are the
+// numeric types, and text splits into RFC 3339 timestamps, categories (few
+// distinct values) and free text.
+enum class ColumnKind { INT, FLOAT, TIMESTAMP, CATEGORICAL, TEXT };
+
+const char *column_kind_name(ColumnKind kind);
+// Accepts the names column_kind_name gives: int, float, timestamp,
+// categorical and text.
+bool parse_column_kind(std::string_view name, ColumnKind &kind);
+ColumnType column_kind_storage(ColumnKind kind);
+
+// How TableBuilder types columns that have no fixed schema. The type is
+// inferred from a sample of the cells and confirmed while every cell is
+// converted; a cell that does not fit sends the column back through
+// inference over all of them, so the sample decides how much work is done
+// but never the result.
+struct InferenceOptions {
+  static constexpr size_t default_sample_rows = 10000;
+
+  // Leading rows inferred from; 0 means every row.
+  size_t sample_rows = default_sample_rows;
+  // Above 0, the sample is this fraction of the rows spread evenly through
+  // the column instead.
+  double sample_fraction = 0.0;
+  // Kinds fixed by column name, which win over inference and any schema.
+  // int and float turn cells that do not parse into nulls; the text kinds
+  // keep every cell as written, so e.g. zip codes are never normalized.
+  std::unordered_map<std::string, ColumnKind> column_kinds;
+};
+
+// Tracks the narrowest column type that fits every cell observed so far.
+class ColumnTypeInference {
+public:
+  ColumnTypeInference();
+
+  void observe(std::string_view cell);
+  ColumnSchema get_schema() const;
+
+private:
+  bool all_int;
+  bool all_numeric;
+  bool uniform_precision;
+  int precision;
+  size_t non_missing;
+};
+
+// Raw arrays behind a column; only the ones matching its type are used.
+struct ColumnBuffers {
+  std::vector<uint64_t> validity;
+  std::vector<int64_t> ints;
+  std::vector<double> doubles;
+  std::vector<uint32_t> codes;
+  std::vector<std::string> dictionary;
+};
+
+// A typed column: numeric values live in contiguous arrays, strings are
+// dictionary-encoded, and a validity bitmap marks null (missing) cells.
+class Column {
+public:
+  Column();
+  Column(const std::string &name, ColumnType type);
+
+  const std::string &get_name() const;
+  void set_name(const std::string &name);
+  ColumnType get_type() const;
+  bool is_numeric() const;
+  // Follows the type unless set; TableBuilder classifies text columns.
+  ColumnKind get_kind() const;
+  void set_kind(ColumnKind kind);
+
+  size_t size() const;
+  size_t get_null_count() const;
+
+  // Number of fractional digits used when rendering FLOAT64 cells;
+  // -1 selects the shortest round-trip representation.
+  int get_precision() const;
+  void set_precision(int precision);
+
+  bool is_valid(size_t row) const;
+  int64_t get_int(size_t row) const;
+  double get_double(size_t row) const;
+  const std::string &get_string(size_t row) const;
+  std::string to_string(size_t row) const;
+
+  void reserve(size_t rows);
+  void append_null();
+  void append_int(int64_t value);
+  void append_double(double value);
+  void append_string(const std::string &value);
+
+  void set_null(size_t row);
+  void set_int(size_t row, int64_t value);
+  void set_double(size_t row, double value);
+  void set_string(size_t row, const std::string &value);
+  // Store value in every null cell, as set_double and set_string would,
+  // but visit only the nulls: 64 rows are tested at once.
+  void fill_nulls(double value);
+  void fill_nulls(const std::string &value);
+
+  void convert_to_double();
+  void keep_rows(const std::vector<size_t> &rows);
+
+  std::vector<int64_t> &get_ints();
+  const std::vector<int64_t> &get_ints() const;
+  std::vector<double> &get_doubles();
+  const std::vector<double> &get_doubles() const;
+  const std::vector<uint32_t> &get_codes() const;
+  const std::vector<std::string> &get_dictionary() const;
+
+  // One bit per row, least significant bit first; set means valid.
+  const std::vector<uint64_t> &get_validity() const;
+  // Takes over raw arrays, e.g. from a snapshot. Returns false, leaving the
+  // column empty, when they do not hold `rows` cells of the column's type.
+  bool adopt_buffers(size_t rows, ColumnBuffers buffers);
+
+  // Views of the value arrays; only the one matching the type is filled.
+  Span<const int64_t> get_int_span() const;
+  Span<const double> get_double_span() const;
+  Span<const uint32_t> get_code_span() const;
+
+private:
+  std::string name;
+  ColumnType type;
+  ColumnKind kind;
+  size_t length;
+  size_t null_count;
+  int precision;
+  std::vector<uint64_t> validity;
+  std::vector<int64_t> int_values;
+  std::vector<double> double_values;
+  std::vector<uint32_t> string_codes;
+  std::vector<std::string> dictionary;
+  std::unordered_map<std::string, uint32_t> dictionary_index;
+
+  void push_validity(bool valid);
+  void set_validity(size_t row, bool valid);
+  uint32_t intern(const std::string &value);
+};
+
+class Table {
+public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  Table();
+
+  static Table from_rows(const std::vector<std::string> &headers,
+                         const std::vector<std::vector<std::string>> &rows);
+  std::vector<std::vector<std::string>> to_rows() const;
+
+  std::vector<std::string> get_headers() const;
+  size_t get_row_count() const;
+  size_t get_column_count() const;
+  bool empty() const;
+
+  size_t find_column(const std::string &name) const;
+  Column &get_column(size_t index);
+  const Column &get_column(size_t index) const;
+
+  bool add_column(Column column);
+  void keep_rows(const std::vector<size_t> &rows);
+  void clear();
+
+private:
+  std::vector<Column> columns;
+  std::unordered_map<std::string, size_t> column_indices;
+  size_t row_count;
+};
+
+// Collects raw cell text column by column and types each column once all
+// rows have been seen, unless a fixed schema is supplied up front. Each
+// column's kind is decided here once, so later stages dispatch on it. Cell
+// bytes live in an arena owned by the builder; cells are views into it, so
+// a row costs no allocation of its own and finish frees the text at once.
+class TableBuilder {
+public:
+  TableBuilder();
+  explicit TableBuilder(const std::vector<std::string> &headers);
+
+  void append_row(std::vector<std::string> row);
+  void append_row(const std::vector<std::string_view> &row);
+  // Moves other's rows after these ones; its arena is taken over, not
+  // copied.
+  void append_rows(TableBuilder &&other);
+  void set_schema(const std::vector<ColumnSchema> &schema);
+  void set_inference(const InferenceOptions &options);
+  // Starts over with these headers and no rows, keeping the arena's first
+  // block for the cells to come.
+  void reset(const std::vector<std::string> &headers);
+  size_t get_row_count() const;
+  size_t get_cell_bytes() const;
+  // Types every column; columns are built concurrently when a pool is given.
+  // The builder is left empty, as after reset.
+  Table finish(ThreadPool *pool = nullptr);
+
+private:
+  std::vector<std::string> headers;
+  std::vector<std::vector<std::string_view>> cells;
+  CellArena arena;
+  std::vector<ColumnSchema> schema;
+  InferenceOptions inference;
+  size_t row_count;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_TABLE_HPP
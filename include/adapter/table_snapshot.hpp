@@ -0,0 +1,63 @@
+#ifndef ADAPTER_TABLE_SNAPSHOT_HPP
+#define ADAPTER_TABLE_SNAPSHOT_HPP
+
+#include "adapter/table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace adapter {
+
+enum class SnapshotCompression { NONE, ZLIB };
+
+// Identifies the CSV a snapshot was built from. The hash covers the file
+// size and its first and last snapshot_sample_bytes, so checking whether a
+// snapshot is current never reads the whole source.
+struct SnapshotSource {
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+  uint64_t hash = 0;
+  char delimiter = ',';
+};
+
+struct SnapshotInfo {
+  SnapshotSource source;
+  SnapshotCompression compression = SnapshotCompression::NONE;
+  uint64_t row_count = 0;
+  uint32_t column_count = 0;
+  uint64_t file_size = 0;
+};
+
+constexpr size_t snapshot_sample_bytes = 1 << 20;
+
+// A snapshot stores a parsed Table column by column in host byte order:
+// a fixed header, then for each column its name, type and precision
+// followed by the validity bitmap and the value array (codes plus
+// dictionary for text). Every array starts on a 64-byte boundary and,
+// when uncompressed, is stored exactly as it sits in memory, so a mapped
+// snapshot is loaded with one copy per array. Compressed snapshots deflate
+// each array separately.
+bool describe_snapshot_source(const std::string &csv_file, char delimiter,
+                              SnapshotSource &source);
+// Writes through a temporary file that is renamed into place, so readers
+// never see a partial snapshot.
+bool write_table_snapshot(const Table &table, const SnapshotSource &source,
+                          const std::string &path,
+                          SnapshotCompression compression =
+                              SnapshotCompression::NONE);
+// Fails, leaving table empty, when the file is missing or damaged or was
+// built from a source other than expected.
+bool read_table_snapshot(const std::string &path,
+                         const SnapshotSource &expected, Table &table,
+                         SnapshotInfo *info = nullptr);
+bool read_snapshot_info(const std::string &path, SnapshotInfo &info);
+
+// Accepts none and zlib.
+bool parse_snapshot_compression(const std::string &name,
+                                SnapshotCompression &compression);
+// zlib needs a build with ADAPTER_HAVE_ZLIB.
+bool snapshot_compression_available(SnapshotCompression compression);
+
+} // namespace adapter
+
+#endif // ADAPTER_TABLE_SNAPSHOT_HPP
@@ -0,0 +1,23 @@
+#ifndef ADAPTER_TABLE_STAGE_HPP
+#define ADAPTER_TABLE_STAGE_HPP
+
+#include "adapter/table.hpp"
+#include <string>
+
+namespace adapter {
+
+// A pipeline step that rewrites a table in place, so a dataset can pass
+// through any number of stages without being copied.
+class TableStage {
+public:
+  virtual ~TableStage() = default;
+
+  virtual std::string get_stage_name() const = 0;
+  // Returns false when the stage could not be applied; the table is then
+  // left as it was.
+  virtual bool apply(Table &table) = 0;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_TABLE_STAGE_HPP
@@ -0,0 +1,67 @@
+#ifndef ADAPTER_THREAD_POOL_HPP
+#define ADAPTER_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace adapter {
+
+// Fixed-size work-stealing pool. Every worker owns a deque: tasks submitted
+// from a worker go to the back of its own deque and are taken LIFO, tasks
+// from other threads are dealt round-robin, and an idle worker steals from
+// the front of the others' deques. A pool of one thread runs every task
+// inline on the caller, so serial and parallel code share one path.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t get_thread_count() const;
+
+  void submit(std::function<void()> task);
+  // Blocks until every submitted task has finished and rethrows the first
+  // exception a task raised.
+  void wait();
+  void parallel_for(size_t count, const std::function<void(size_t)> &body);
+
+  static size_t default_thread_count();
+
+private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  // Tasks sitting in any queue, and tasks submitted but not yet finished.
+  // Both change under a queue lock or the pool mutex, which is what keeps
+  // sleeping workers from missing a wakeup.
+  std::atomic<size_t> queued;
+  std::atomic<size_t> pending;
+  std::atomic<size_t> next_queue;
+  std::mutex mutex;
+  std::condition_variable task_available;
+  std::condition_variable tasks_done;
+  bool stopping;
+  std::exception_ptr first_error;
+
+  void worker_loop(size_t index);
+  bool take_task(size_t index, std::function<void()> &task);
+  void run_task(const std::function<void()> &task);
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_THREAD_POOL_HPP
@@ -1,7 +1,12 @@
 #ifndef ADAPTER_TIME_ALIGNER_HPP
 #define ADAPTER_TIME_ALIGNER_HPP
 
+#include "adapter/cubic_spline.hpp"
+#include "adapter/table.hpp"
+#include "adapter/table_stage.hpp"
+#include "adapter/time_index.hpp"
 #include <chrono>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -9,7 +14,11 @@ namespace adapter {
 
 enum class SolverMethod { LINEAR_INTERPOLATION, RK4, HEUN, CUBIC_SPLINE };
 
-class TimeAligner {
+// How samples are reduced onto a grid coarser than the source rate. NONE
+// interpolates at each grid point instead.
+enum class ResampleAggregation { NONE, MEAN, MIN, MAX, LAST };
+
+class TimeAligner : public TableStage {
 public:
   TimeAligner();
   ~TimeAligner();
@@ -20,29 +29,98 @@ public:
                          const std::vector<std::string> &dependent_columns,
                          const std::vector<std::string> &independent_columns);
 
+  // Replaces the table with the aligned columns. Returns false, leaving
+  // the table untouched, when there is no usable time column.
+  bool
+  align_time_series_data(Table &table, const std::string &time_column_name,
+                         const std::vector<std::string> &dependent_columns,
+                         const std::vector<std::string> &independent_columns);
+
+  // Columns used when the aligner runs as a TableStage.
+  void set_alignment_columns(const std::string &time_column_name,
+                             const std::vector<std::string> &dependent_columns,
+                             const std::vector<std::string> &independent_columns);
+  std::string get_stage_name() const override;
+  bool apply(Table &table) override;
+
   void set_target_time_interval(double interval_seconds);
   void set_solver_method(SolverMethod method);
   void set_time_format(const std::string &format);
+  void set_spline_boundary(SplineBoundary boundary);
+  // Numeric columns holding a rate of change. Each gets a <name>_integral
+  // column, integrated over the target grid with RK4 (or Heun when that is
+  // the solver method).
+  void set_derivative_columns(const std::vector<std::string> &columns);
+  // Columns are aligned on this many threads; the output is the same for
+  // any count.
+  void set_thread_count(size_t count);
+  // Grid points between two samples more than this many seconds apart are
+  // left null rather than interpolated across the outage; 0 disables it.
+  void set_max_gap(double seconds);
+  // With an aggregation, grid point k holds the mean, min, max or last
+  // valid value of the samples in [t_k, t_k+1) (text columns always take
+  // the last), computed in one pass; empty buckets are null.
+  void set_aggregation(ResampleAggregation aggregation);
+  ResampleAggregation get_aggregation() const;
+  // Starts the grid at this time instead of the first sample, so a run
+  // over appended rows continues an earlier run's grid. Samples before the
+  // origin still bracket the first grid points.
+  void set_grid_origin(double time);
+  const std::string &get_alignment_time_column() const;
+
+  // Counts from the last alignment.
+  size_t get_aligned_point_count() const;
+  size_t get_unparsed_time_count() const;
+  size_t get_gap_point_count() const;
+  // Time of each row of the last aligned table.
+  const std::vector<double> &get_grid_times() const;
+
+  // Accepts linear, rk4, heun and cubic_spline.
+  static bool parse_solver_method(const std::string &name,
+                                  SolverMethod &method);
+  // Accepts none, mean, min, max and last.
+  static bool parse_aggregation(const std::string &name,
+                                ResampleAggregation &aggregation);
 
 private:
+  std::string alignment_time_column;
+  std::vector<std::string> alignment_dependent_columns;
+  std::vector<std::string> alignment_independent_columns;
   double target_time_interval;
   SolverMethod solver_method;
   std::string time_format;
+  SplineBoundary spline_boundary;
+  std::vector<std::string> derivative_columns;
+  size_t thread_count;
+  double max_gap;
+  ResampleAggregation aggregation;
+  bool has_grid_origin;
+  double grid_origin;
+  std::vector<double> grid_times;
+  size_t aligned_point_count;
+  size_t unparsed_time_count;
+  size_t gap_point_count;
+
+  void for_each_column(size_t column_count,
+                       const std::function<void(size_t)> &body) const;
 
   std::vector<double>
   parse_time_column(const std::vector<std::string> &time_column) const;
+  bool parse_time_value(const std::string &time_str, double &time_value) const;
   std::string format_time_value(double time_value) const;
   std::vector<double> create_uniform_time_grid(double start_time,
                                                double end_time) const;
+  // original_values are in the index's time order.
   std::vector<std::string>
-  interpolate_values(const std::vector<double> &original_times,
+  interpolate_values(const TimeIndex &index,
                      const std::vector<std::string> &original_values,
                      const std::vector<double> &target_times) const;
+  // One value per bucket of TimeIndex::bucket.
+  Column aggregate_column(const Column &source, const TimeIndex &index,
+                          const std::vector<size_t> &starts) const;
 
   double linear_interpolation(double x, double x1, double y1, double x2,
                               double y2) const;
-  double runge_kutta_step(double x, double y, double h) const;
-  double heun_step(double x, double y, double h) const;
   std::vector<double>
   cubic_spline_interpolation(const std::vector<double> &x,
                              const std::vector<double> &y,
@@ -0,0 +1,57 @@
+#ifndef ADAPTER_TIME_INDEX_HPP
+#define ADAPTER_TIME_INDEX_HPP
+
+#include "adapter/thread_pool.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace adapter {
+
+// Parsed timestamps in ascending order, each with the row it came from.
+// Equal times keep their input order.
+class TimeIndex {
+public:
+  // Inputs this long are sorted in parallel when a pool is given.
+  static constexpr size_t min_parallel_sort = 1 << 16;
+
+  TimeIndex();
+
+  // Checks the times for order in one pass and sorts them (with their
+  // rows) only when they are out of order.
+  void build(std::vector<double> times, std::vector<size_t> rows,
+             ThreadPool *pool = nullptr);
+
+  const std::vector<double> &get_times() const;
+  const std::vector<size_t> &get_rows() const;
+  size_t size() const;
+  bool empty() const;
+  // Whether build found the times already in order.
+  bool was_sorted() const;
+
+  // For each target, the first sample interval containing it, found in one
+  // forward pass while the targets ascend. Targets outside the samples get
+  // the first and last sample.
+  void bracket(const std::vector<double> &targets,
+               std::vector<size_t> &lower_indices,
+               std::vector<size_t> &upper_indices) const;
+  // Splits the samples into buckets [grid[k], grid[k + 1]), the last one
+  // closed at the final sample; samples of bucket k are
+  // [starts[k], starts[k + 1]). The grid must ascend from the first sample.
+  void bucket(const std::vector<double> &grid,
+              std::vector<size_t> &starts) const;
+  // Whether target lies strictly between two bracketing samples that are
+  // more than max_gap apart. A max_gap of zero or less never reports one.
+  bool in_gap(double target, size_t lower, size_t upper,
+              double max_gap) const;
+
+private:
+  std::vector<double> times;
+  std::vector<size_t> rows;
+  bool sorted;
+
+  void sort_order(std::vector<size_t> &order, ThreadPool *pool) const;
+};
+
+} // namespace adapter
+
+#endif // ADAPTER_TIME_INDEX_HPP
@@ -0,0 +1,69 @@
+#ifndef ADAPTER_VALUE_PARSER_HPP
+#define ADAPTER_VALUE_PARSER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace adapter {
+
+// Shape of a numeric literal accepted by classify_number.
+struct NumberFormat {
+  bool has_point = false;
+  bool has_exponent = false;
+  int fraction_digits = 0;
+};
+
+// Recognises [+-]? (digits | digits? '.' digits) ([eE] [+-]? digits)? in a
+// single pass. A trailing point ("5.") and bare signs are rejected.
+bool classify_number(std::string_view text, NumberFormat *format = nullptr);
+
+// Classify, then convert with std::from_chars. Both fail on anything
+// classify_number rejects, so "inf", "0x1p3" or "12abc" never parse.
+// format, when given, receives the classification.
+bool parse_number(std::string_view text, double &value,
+                  NumberFormat *format = nullptr);
+bool parse_integer(std::string_view text, int64_t &value);
+
+// Fixed notation with the given number of fractional digits, matching
+// std::fixed << std::setprecision(precision) without a stream.
+std::string format_fixed(double value, int precision);
+
+struct DateTimeFields {
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  bool has_time = false;
+};
+
+// Finds the first YYYY-MM-DD[T ]HH:MM:SS in text, or failing that the
+// first YYYY-MM-DD, anywhere in the string.
+bool find_iso_datetime(std::string_view text, DateTimeFields &fields);
+bool contains_iso_date(std::string_view text);
+
+// Days between 1970-01-01 and a proleptic Gregorian date, and back, using
+// Hinnant's days_from_civil arithmetic rather than libc or the time zone.
+int64_t days_from_civil(int64_t year, int month, int day);
+void civil_from_days(int64_t days, int64_t &year, int &month, int &day);
+
+// Parses an RFC 3339 timestamp filling the whole of text: YYYY-MM-DD,
+// optionally followed by [Tt ]HH:MM[:SS[.fraction]] and Z or +-HH[:MM].
+// Times without an offset are UTC. The result is seconds since the Unix
+// epoch, with fractions kept to nanoseconds.
+bool parse_iso_timestamp(std::string_view text, double &seconds);
+
+// Seconds since the epoch from a time cell: a plain number, an RFC 3339
+// timestamp, or failing those the first ISO date and time anywhere in the
+// text (read as UTC).
+bool parse_timestamp(std::string_view text, double &seconds);
+
+// YYYY-MM-DDTHH:MM:SS in UTC, followed by up to six fractional digits when
+// the value is not a whole second.
+std::string format_iso_timestamp(double seconds);
+
+} // namespace adapter
+
+#endif // ADAPTER_VALUE_PARSER_HPP
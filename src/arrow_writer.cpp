@@ -0,0 +1,538 @@
+#include "adapter/arrow_writer.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+namespace adapter {
+
+namespace {
+
+const char arrow_magic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+constexpr size_t arrow_alignment = 64;
+
+// Values of the Arrow schema enums and unions used here
+constexpr uint64_t metadata_version_v5 = 4;
+constexpr uint64_t header_schema = 1;
+constexpr uint64_t header_dictionary_batch = 2;
+constexpr uint64_t header_record_batch = 3;
+constexpr uint64_t type_int = 2;
+constexpr uint64_t type_floating_point = 3;
+constexpr uint64_t type_utf8 = 5;
+constexpr uint64_t type_large_utf8 = 20;
+constexpr uint64_t precision_double = 2;
+
+size_t padded(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+bool host_is_big_endian() {
+  const uint16_t probe = 1;
+  uint8_t first = 0;
+  std::memcpy(&first, &probe, 1);
+  return first == 0;
+}
+
+// One inline field of a flatbuffer table. Size 0 marks an offset to an
+// object written later.
+struct FlatField {
+  size_t id;
+  size_t size;
+  uint64_t value;
+};
+
+// Builds a flatbuffer front to back. Each table is preceded by its vtable
+// and leaves placeholders for its offset fields, which are patched once the
+// objects they refer to have been appended; offsets therefore always point
+// forward, as the format requires. Scalars are little-endian.
+class FlatBuilder {
+public:
+  // The root offset comes first
+  FlatBuilder() : data(4, 0) {}
+
+  // Returns the table's position; slots[id] is where offset field id sits.
+  size_t table(std::vector<FlatField> fields, std::vector<size_t> &slots) {
+    size_t field_count = 0;
+    for (const auto &field : fields) {
+      field_count = std::max(field_count, field.id + 1);
+    }
+    slots.assign(field_count, 0);
+
+    align(2);
+    const size_t vtable = data.size();
+    const size_t vtable_size = 4 + 2 * field_count;
+    data.resize(data.size() + vtable_size, 0);
+
+    align(4);
+    const size_t table = data.size();
+    put(table - vtable, 4);
+    // Widest first keeps the padding down
+    std::stable_sort(fields.begin(), fields.end(),
+                     [](const FlatField &a, const FlatField &b) {
+                       return width(a) > width(b);
+                     });
+    for (const auto &field : fields) {
+      align(width(field));
+      const size_t position = data.size();
+      put(field.value, width(field));
+      store(vtable + 4 + 2 * field.id, position - table, 2);
+      if (field.size == 0) {
+        slots[field.id] = position;
+      }
+    }
+    store(vtable, vtable_size, 2);
+    store(vtable + 2, data.size() - table, 2);
+    return table;
+  }
+
+  size_t string(const std::string &value) {
+    align(4);
+    const size_t position = data.size();
+    put(value.size(), 4);
+    data.insert(data.end(), value.begin(), value.end());
+    data.push_back(0);
+    return position;
+  }
+
+  // Vector of structs already laid out in bytes
+  size_t struct_vector(const std::vector<uint8_t> &items, size_t count,
+                       size_t alignment) {
+    align(4);
+    while ((data.size() + 4) % alignment != 0) {
+      data.push_back(0);
+    }
+    const size_t position = data.size();
+    put(count, 4);
+    data.insert(data.end(), items.begin(), items.end());
+    return position;
+  }
+
+  // Vector of offsets; slots[i] is where element i sits.
+  size_t offset_vector(size_t count, std::vector<size_t> &slots) {
+    align(4);
+    const size_t position = data.size();
+    put(count, 4);
+    slots.clear();
+    for (size_t i = 0; i < count; ++i) {
+      slots.push_back(data.size());
+      put(0, 4);
+    }
+    return position;
+  }
+
+  void patch(size_t slot, size_t target) { store(slot, target - slot, 4); }
+  void set_root(size_t table) { patch(0, table); }
+
+  const std::vector<uint8_t> &bytes() const { return data; }
+
+private:
+  std::vector<uint8_t> data;
+
+  static size_t width(const FlatField &field) {
+    return field.size == 0 ? 4 : field.size;
+  }
+
+  void align(size_t alignment) {
+    while (data.size() % alignment != 0) {
+      data.push_back(0);
+    }
+  }
+
+  void put(uint64_t value, size_t size) {
+    data.resize(data.size() + size);
+    store(data.size() - size, value, size);
+  }
+
+  void store(size_t position, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      data[position + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+  }
+};
+
+// Little-endian struct fields for FieldNode, Buffer and Block
+void append_struct_field(std::vector<uint8_t> &items, uint64_t value,
+                         size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    items.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+// One array in a message body
+struct BodyBuffer {
+  const void *data;
+  size_t size;
+};
+
+struct FieldNode {
+  uint64_t length;
+  uint64_t null_count;
+};
+
+// What a record or dictionary batch lays out in its body
+struct BatchLayout {
+  uint64_t length = 0;
+  std::vector<FieldNode> nodes;
+  std::vector<BodyBuffer> buffers;
+
+  uint64_t body_size() const {
+    uint64_t size = 0;
+    for (const auto &buffer : buffers) {
+      size += padded(buffer.size, arrow_alignment);
+    }
+    return size;
+  }
+};
+
+// Location of a message in the file, as the footer lists it
+struct FileBlock {
+  uint64_t offset;
+  uint64_t metadata_size;
+  uint64_t body_size;
+};
+
+// Utf8 offsets and bytes of a dictionary. Writing them needs a copy, as
+// the dictionary holds separate strings.
+struct DictionaryValues {
+  bool large = false;
+  std::vector<int32_t> offsets;
+  std::vector<int64_t> large_offsets;
+  std::string bytes;
+};
+
+DictionaryValues build_dictionary(const Column &column) {
+  DictionaryValues values;
+  size_t total = 0;
+  for (const auto &entry : column.get_dictionary()) {
+    total += entry.size();
+  }
+  values.large = total > static_cast<size_t>(INT32_MAX);
+  values.bytes.reserve(total);
+  if (values.large) {
+    values.large_offsets.push_back(0);
+  } else {
+    values.offsets.push_back(0);
+  }
+  for (const auto &entry : column.get_dictionary()) {
+    values.bytes += entry;
+    if (values.large) {
+      values.large_offsets.push_back(static_cast<int64_t>(values.bytes.size()));
+    } else {
+      values.offsets.push_back(static_cast<int32_t>(values.bytes.size()));
+    }
+  }
+  return values;
+}
+
+size_t write_int_type(FlatBuilder &builder, uint64_t bit_width) {
+  std::vector<size_t> slots;
+  return builder.table({{0, 4, bit_width}, {1, 1, 1}}, slots);
+}
+
+size_t write_field(FlatBuilder &builder, const Column &column, size_t id,
+                   const DictionaryValues *dictionary) {
+  uint64_t type_type = type_utf8;
+  if (column.get_type() == ColumnType::INT64) {
+    type_type = type_int;
+  } else if (column.get_type() == ColumnType::FLOAT64) {
+    type_type = type_floating_point;
+  } else if (dictionary != nullptr && dictionary->large) {
+    type_type = type_large_utf8;
+  }
+  // The column's kind says which text columns hold timestamps or
+  // categories, which the Arrow type alone cannot
+  std::vector<std::pair<std::string, std::string>> metadata = {
+      {"adapter.kind", column_kind_name(column.get_kind())}};
+  if (column.get_type() == ColumnType::FLOAT64 && column.get_precision() >= 0) {
+    metadata.emplace_back("adapter.precision",
+                          std::to_string(column.get_precision()));
+  }
+
+  std::vector<FlatField> fields = {
+      {0, 0, 0}, {1, 1, 1}, {2, 1, type_type}, {3, 0, 0}, {5, 0, 0}};
+  if (column.get_type() == ColumnType::STRING) {
+    fields.push_back({4, 0, 0});
+  }
+  fields.push_back({6, 0, 0});
+  std::vector<size_t> slots;
+  const size_t field = builder.table(fields, slots);
+
+  builder.patch(slots[0], builder.string(column.get_name()));
+  std::vector<size_t> type_slots;
+  if (type_type == type_int) {
+    builder.patch(slots[3], write_int_type(builder, 64));
+  } else if (type_type == type_floating_point) {
+    builder.patch(slots[3],
+                  builder.table({{0, 2, precision_double}}, type_slots));
+  } else {
+    builder.patch(slots[3], builder.table({}, type_slots));
+  }
+
+  if (column.get_type() == ColumnType::STRING) {
+    std::vector<size_t> encoding_slots;
+    builder.patch(slots[4],
+                  builder.table({{0, 8, id}, {1, 0, 0}}, encoding_slots));
+    builder.patch(encoding_slots[1], write_int_type(builder, 32));
+  }
+
+  // Readers expect a children vector even when it is empty
+  std::vector<size_t> children;
+  builder.patch(slots[5], builder.offset_vector(0, children));
+
+  std::vector<size_t> items;
+  builder.patch(slots[6], builder.offset_vector(metadata.size(), items));
+  for (size_t i = 0; i < metadata.size(); ++i) {
+    std::vector<size_t> pair_slots;
+    builder.patch(items[i],
+                  builder.table({{0, 0, 0}, {1, 0, 0}}, pair_slots));
+    builder.patch(pair_slots[0], builder.string(metadata[i].first));
+    builder.patch(pair_slots[1], builder.string(metadata[i].second));
+  }
+  return field;
+}
+
+size_t write_schema(FlatBuilder &builder, const Table &table,
+                    const std::vector<DictionaryValues> &dictionaries) {
+  std::vector<size_t> slots;
+  const size_t schema = builder.table(
+      {{0, 2, host_is_big_endian() ? 1u : 0u}, {1, 0, 0}}, slots);
+  std::vector<size_t> items;
+  builder.patch(slots[1],
+                builder.offset_vector(table.get_column_count(), items));
+  for (size_t col = 0; col < table.get_column_count(); ++col) {
+    const Column &column = table.get_column(col);
+    builder.patch(items[col],
+                  write_field(builder, column, col,
+                              column.get_type() == ColumnType::STRING
+                                  ? &dictionaries[col]
+                                  : nullptr));
+  }
+  return schema;
+}
+
+size_t write_record_batch(FlatBuilder &builder, const BatchLayout &layout) {
+  std::vector<size_t> slots;
+  const size_t batch =
+      builder.table({{0, 8, layout.length}, {1, 0, 0}, {2, 0, 0}}, slots);
+
+  std::vector<uint8_t> nodes;
+  for (const auto &node : layout.nodes) {
+    append_struct_field(nodes, node.length, 8);
+    append_struct_field(nodes, node.null_count, 8);
+  }
+  builder.patch(slots[1],
+                builder.struct_vector(nodes, layout.nodes.size(), 8));
+
+  std::vector<uint8_t> buffers;
+  uint64_t offset = 0;
+  for (const auto &buffer : layout.buffers) {
+    append_struct_field(buffers, offset, 8);
+    append_struct_field(buffers, buffer.size, 8);
+    offset += padded(buffer.size, arrow_alignment);
+  }
+  builder.patch(slots[2],
+                builder.struct_vector(buffers, layout.buffers.size(), 8));
+  return batch;
+}
+
+// Wraps a message header in a Message table.
+std::vector<uint8_t> build_message(uint64_t header_type,
+                                   const Table *schema_table,
+                                   const std::vector<DictionaryValues> *dicts,
+                                   const BatchLayout *layout,
+                                   uint64_t dictionary_id) {
+  FlatBuilder builder;
+  std::vector<size_t> slots;
+  const uint64_t body_size = layout != nullptr ? layout->body_size() : 0;
+  builder.set_root(builder.table({{0, 2, metadata_version_v5},
+                                  {1, 1, header_type},
+                                  {2, 0, 0},
+                                  {3, 8, body_size}},
+                                 slots));
+  if (header_type == header_schema) {
+    builder.patch(slots[2], write_schema(builder, *schema_table, *dicts));
+  } else if (header_type == header_record_batch) {
+    builder.patch(slots[2], write_record_batch(builder, *layout));
+  } else {
+    std::vector<size_t> batch_slots;
+    builder.patch(slots[2],
+                  builder.table({{0, 8, dictionary_id}, {1, 0, 0}, {2, 1, 0}},
+                                batch_slots));
+    builder.patch(batch_slots[1], write_record_batch(builder, *layout));
+  }
+  return builder.bytes();
+}
+
+class ArrowFileWriter {
+public:
+  explicit ArrowFileWriter(const std::string &path)
+      : out(path, std::ios::binary | std::ios::trunc), offset(0) {}
+
+  bool good() const { return out.good(); }
+  uint64_t get_offset() const { return offset; }
+
+  void write(const void *data, size_t size) {
+    out.write(static_cast<const char *>(data),
+              static_cast<std::streamsize>(size));
+    offset += size;
+  }
+
+  void pad(size_t alignment) {
+    static const char zeros[arrow_alignment] = {};
+    write(zeros, padded(offset, alignment) - offset);
+  }
+
+  void write_le32(uint32_t value) {
+    uint8_t bytes[4];
+    for (size_t i = 0; i < 4; ++i) {
+      bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    write(bytes, 4);
+  }
+
+  // Continuation marker, metadata size, the flatbuffer padded so that the
+  // body starts on an alignment boundary, then the body.
+  FileBlock write_message(const std::vector<uint8_t> &metadata,
+                          const BatchLayout *layout) {
+    FileBlock block;
+    block.offset = offset;
+    const size_t metadata_end =
+        padded(offset + 8 + metadata.size(), arrow_alignment);
+    const size_t metadata_size = metadata_end - offset - 8;
+    write_le32(0xffffffffu);
+    write_le32(static_cast<uint32_t>(metadata_size));
+    write(metadata.data(), metadata.size());
+    pad(arrow_alignment);
+    block.metadata_size = 8 + metadata_size;
+
+    block.body_size = 0;
+    if (layout != nullptr) {
+      for (const auto &buffer : layout->buffers) {
+        write(buffer.data, buffer.size);
+        pad(arrow_alignment);
+      }
+      block.body_size = layout->body_size();
+    }
+    return block;
+  }
+
+private:
+  std::ofstream out;
+  uint64_t offset;
+};
+
+void append_blocks(FlatBuilder &builder, size_t slot,
+                   const std::vector<FileBlock> &blocks) {
+  std::vector<uint8_t> items;
+  for (const auto &block : blocks) {
+    append_struct_field(items, block.offset, 8);
+    append_struct_field(items, block.metadata_size, 4);
+    append_struct_field(items, 0, 4);
+    append_struct_field(items, block.body_size, 8);
+  }
+  builder.patch(slot, builder.struct_vector(items, blocks.size(), 8));
+}
+
+} // namespace
+
+bool write_arrow_file(const Table &table, const std::string &path,
+                      uint64_t *bytes_written) {
+  const size_t column_count = table.get_column_count();
+  const size_t row_count = table.get_row_count();
+  std::vector<DictionaryValues> dictionaries(column_count);
+  for (size_t col = 0; col < column_count; ++col) {
+    if (table.get_column(col).get_type() == ColumnType::STRING) {
+      dictionaries[col] = build_dictionary(table.get_column(col));
+    }
+  }
+
+  ArrowFileWriter writer(path);
+  writer.write(arrow_magic, sizeof(arrow_magic));
+  writer.write_message(
+      build_message(header_schema, &table, &dictionaries, nullptr, 0),
+      nullptr);
+
+  std::vector<FileBlock> dictionary_blocks;
+  for (size_t col = 0; col < column_count; ++col) {
+    const Column &column = table.get_column(col);
+    if (column.get_type() != ColumnType::STRING) {
+      continue;
+    }
+    const DictionaryValues &values = dictionaries[col];
+    BatchLayout layout;
+    layout.length = column.get_dictionary().size();
+    layout.nodes.push_back({layout.length, 0});
+    layout.buffers.push_back({nullptr, 0});
+    if (values.large) {
+      layout.buffers.push_back({values.large_offsets.data(),
+                                values.large_offsets.size() * 8});
+    } else {
+      layout.buffers.push_back(
+          {values.offsets.data(), values.offsets.size() * 4});
+    }
+    layout.buffers.push_back({values.bytes.data(), values.bytes.size()});
+    dictionary_blocks.push_back(writer.write_message(
+        build_message(header_dictionary_batch, nullptr, nullptr, &layout,
+                      col),
+        &layout));
+  }
+
+  // The validity bitmap, least significant bit first, is already Arrow's
+  BatchLayout layout;
+  layout.length = row_count;
+  for (size_t col = 0; col < column_count; ++col) {
+    const Column &column = table.get_column(col);
+    const size_t nulls = column.get_null_count();
+    layout.nodes.push_back({row_count, nulls});
+    layout.buffers.push_back(
+        {column.get_validity().data(), nulls > 0 ? (row_count + 7) / 8 : 0});
+    switch (column.get_type()) {
+    case ColumnType::INT64:
+      layout.buffers.push_back({column.get_ints().data(), row_count * 8});
+      break;
+    case ColumnType::FLOAT64:
+      layout.buffers.push_back({column.get_doubles().data(), row_count * 8});
+      break;
+    case ColumnType::STRING:
+      layout.buffers.push_back({column.get_codes().data(), row_count * 4});
+      break;
+    }
+  }
+  const FileBlock batch_block = writer.write_message(
+      build_message(header_record_batch, nullptr, nullptr, &layout, 0),
+      &layout);
+
+  // End of stream, then the footer and its size
+  writer.write_le32(0xffffffffu);
+  writer.write_le32(0);
+  FlatBuilder footer;
+  std::vector<size_t> slots;
+  footer.set_root(footer.table(
+      {{0, 2, metadata_version_v5}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}}, slots));
+  footer.patch(slots[1], write_schema(footer, table, dictionaries));
+  append_blocks(footer, slots[2], dictionary_blocks);
+  append_blocks(footer, slots[3], {batch_block});
+  writer.write(footer.bytes().data(), footer.bytes().size());
+  writer.write_le32(static_cast<uint32_t>(footer.bytes().size()));
+  writer.write(arrow_magic, 6);
+
+  if (bytes_written != nullptr) {
+    *bytes_written = writer.get_offset();
+  }
+  return writer.good();
+}
+
+bool parse_output_format(const std::string &name, OutputFormat &format) {
+  if (name == "csv") {
+    format = OutputFormat::CSV;
+  } else if (name == "arrow" || name == "feather") {
+    format = OutputFormat::ARROW;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace adapter
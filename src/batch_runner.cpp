@@ -0,0 +1,349 @@
+#include "adapter/batch_runner.hpp"
+#include "adapter/arrow_writer.hpp"
+#include "adapter/table_stage.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace adapter {
+
+namespace {
+
+size_t run_stage(Metrics &metrics, TableStage &stage, Table &table) {
+  ScopedStage scope(metrics, stage.get_stage_name());
+  scope.stage().rows_in = table.get_row_count();
+  stage.apply(table);
+  scope.stage().rows_out = table.get_row_count();
+  return scope.index();
+}
+
+std::string trim(const std::string &text) {
+  const size_t begin = text.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return std::string();
+  }
+  const size_t end = text.find_last_not_of(" \t\r\n");
+  return text.substr(begin, end - begin + 1);
+}
+
+bool send_all(int fd, const std::string &text) {
+  size_t sent = 0;
+  while (sent < text.size()) {
+    // A client that went away must not take the server down with SIGPIPE
+    const ssize_t count =
+        ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+} // namespace
+
+bool parse_batch_job(const std::string &line, BatchJob &job) {
+  const std::string text = trim(line);
+  if (text.empty() || text[0] == '#') {
+    return false;
+  }
+
+  std::istringstream fields(text);
+  job = BatchJob();
+  fields >> job.input_file >> job.output_file;
+  return true;
+}
+
+std::string format_batch_result(const BatchResult &result) {
+  std::ostringstream line;
+  if (!result.ok) {
+    line << "failed " << result.job.input_file << " " << result.error;
+    return line.str();
+  }
+
+  line << "ok " << result.job.input_file << " " << result.job.output_file
+       << " rows_in=" << result.rows_in << " rows_out=" << result.rows_out
+       << std::fixed << std::setprecision(6) << " seconds=" << result.seconds;
+  for (const StageMetrics &stage : result.metrics.get_stages()) {
+    line << " " << stage.name << "=" << stage.wall_seconds;
+  }
+  return line.str();
+}
+
+BatchRunner::BatchRunner(const PipelineSpec &spec)
+    : spec(spec), pool(std::max<size_t>(1, spec.thread_count)), job_count(0),
+      failed_count(0) {
+  // Jobs are the unit of parallelism; each runs on a single thread
+  this->spec.thread_count = 1;
+  this->spec.snapshot_file.clear();
+}
+
+BatchRunner::~BatchRunner() {
+  // Queued jobs use the members destroyed before the pool
+  try {
+    pool.wait();
+  } catch (const std::exception &) {
+  }
+}
+
+void BatchRunner::submit(const BatchJob &job, ResultHandler on_done) {
+  pool.submit([this, job, on_done] {
+    std::unique_ptr<Worker> worker = acquire_worker();
+    BatchResult result;
+    result.job = job;
+    result.ok = run_job(*worker, result);
+    finish_job(std::move(worker), result, on_done);
+  });
+}
+
+void BatchRunner::wait() { pool.wait(); }
+
+BatchResult BatchRunner::run(const BatchJob &job) {
+  std::unique_ptr<Worker> worker = acquire_worker();
+  BatchResult result;
+  result.job = job;
+  result.ok = run_job(*worker, result);
+  finish_job(std::move(worker), result, ResultHandler());
+  return result;
+}
+
+size_t BatchRunner::get_worker_count() const {
+  return pool.get_thread_count();
+}
+
+size_t BatchRunner::get_job_count() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return job_count;
+}
+
+size_t BatchRunner::get_failed_count() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return failed_count;
+}
+
+Metrics BatchRunner::get_metrics() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return totals;
+}
+
+std::unique_ptr<BatchRunner::Worker> BatchRunner::acquire_worker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!idle_workers.empty()) {
+      std::unique_ptr<Worker> worker = std::move(idle_workers.back());
+      idle_workers.pop_back();
+      return worker;
+    }
+  }
+
+  std::unique_ptr<Worker> worker(new Worker());
+  worker->parser.set_delimiter(spec.delimiter);
+  worker->parser.set_thread_count(spec.thread_count);
+  worker->parser.set_projection(spec.projected_columns);
+  worker->parser.set_inference(spec.inference);
+  spec.configure(worker->cleaner);
+  if (!spec.time_column.empty()) {
+    spec.configure(worker->aligner);
+  }
+  worker->writer.set_direct_io(spec.direct_io);
+  return worker;
+}
+
+void BatchRunner::finish_job(std::unique_ptr<Worker> worker,
+                             const BatchResult &result,
+                             const ResultHandler &on_done) {
+  std::lock_guard<std::mutex> lock(mutex);
+  idle_workers.push_back(std::move(worker));
+  ++job_count;
+  if (!result.ok) {
+    ++failed_count;
+  }
+  totals.merge(result.metrics);
+  if (on_done) {
+    on_done(result);
+  }
+}
+
+bool BatchRunner::run_job(Worker &worker, BatchResult &result) const {
+  const auto start = std::chrono::steady_clock::now();
+  const bool ok = run_stages(worker, result);
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return ok;
+}
+
+bool BatchRunner::run_stages(Worker &worker, BatchResult &result) const {
+  BatchJob &job = result.job;
+  if (job.output_file.empty()) {
+    job.output_file = default_output_file(job.input_file, spec.output_format);
+  }
+  Metrics &metrics = result.metrics;
+
+  try {
+    {
+      ScopedStage stage(metrics, "parse");
+      if (!worker.parser.load_file(job.input_file)) {
+        result.error = "could not load input";
+        return false;
+      }
+      stage.stage().bytes_read = worker.parser.get_bytes_read();
+      stage.stage().rows_out = worker.parser.get_row_count();
+      metrics.add_counter(stage.index(), "malformed_rows",
+                          worker.parser.get_malformed_count());
+    }
+    result.rows_in = worker.parser.get_row_count();
+
+    Table table = worker.parser.take_table();
+    const size_t clean_stage = run_stage(metrics, worker.cleaner, table);
+    metrics.add_counter(clean_stage, "duplicate_rows",
+                        worker.cleaner.get_duplicates_removed());
+    if (!spec.time_column.empty()) {
+      run_stage(metrics, worker.aligner, table);
+    }
+
+    {
+      ScopedStage stage(metrics, "write");
+      uint64_t bytes_written = 0;
+      bool written = false;
+      if (spec.output_format == OutputFormat::ARROW) {
+        written = write_arrow_file(table, job.output_file, &bytes_written);
+      } else {
+        CsvWriter &writer = worker.writer;
+        written = writer.open(job.output_file, spec.delimiter) &&
+                  writer.write_header(table.get_headers()) &&
+                  writer.write_table(table);
+        written = writer.close() && written;
+        bytes_written = writer.get_bytes_written();
+      }
+      stage.stage().rows_in = table.get_row_count();
+      stage.stage().rows_out = written ? table.get_row_count() : 0;
+      stage.stage().bytes_written = bytes_written;
+      if (!written) {
+        result.error = "could not write output";
+        return false;
+      }
+    }
+    result.rows_out = table.get_row_count();
+  } catch (const std::exception &error) {
+    result.error = error.what();
+    return false;
+  }
+  return true;
+}
+
+bool run_batch_stream(BatchRunner &runner, std::istream &input,
+                      std::ostream &report) {
+  // Handlers never run concurrently, so the count needs no lock of its own
+  size_t failed = 0;
+  const auto on_done = [&report, &failed](const BatchResult &result) {
+    if (!result.ok) {
+      ++failed;
+    }
+    report << format_batch_result(result) << std::endl;
+  };
+
+  std::string line;
+  BatchJob job;
+  while (std::getline(input, line)) {
+    if (parse_batch_job(line, job)) {
+      runner.submit(job, on_done);
+    }
+  }
+  runner.wait();
+  return failed == 0;
+}
+
+bool serve_batch_socket(BatchRunner &runner, const std::string &path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Error: Invalid socket path '" << path << "'" << std::endl;
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+
+  const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listener < 0) {
+    std::cerr << "Error: Could not create socket" << std::endl;
+    return false;
+  }
+  // A socket file left by an earlier server would make bind fail
+  ::unlink(path.c_str());
+  if (::bind(listener, reinterpret_cast<const sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(listener, 16) != 0) {
+    std::cerr << "Error: Could not listen on " << path << ": "
+              << std::strerror(errno) << std::endl;
+    ::close(listener);
+    return false;
+  }
+
+  bool stopping = false;
+  while (!stopping) {
+    const int connection = ::accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Error: Could not accept a connection: "
+                << std::strerror(errno) << std::endl;
+      break;
+    }
+
+    const auto on_done = [connection](const BatchResult &result) {
+      send_all(connection, format_batch_result(result) + "\n");
+    };
+    const auto handle_line = [&](const std::string &line) {
+      BatchJob job;
+      if (trim(line) == "shutdown") {
+        stopping = true;
+      } else if (parse_batch_job(line, job)) {
+        runner.submit(job, on_done);
+      }
+    };
+    std::string pending;
+    char buffer[4096];
+    while (true) {
+      const ssize_t count = ::read(connection, buffer, sizeof(buffer));
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        break;
+      }
+      pending.append(buffer, static_cast<size_t>(count));
+
+      size_t line_start = 0;
+      size_t line_end;
+      while ((line_end = pending.find('\n', line_start)) !=
+             std::string::npos) {
+        handle_line(pending.substr(line_start, line_end - line_start));
+        line_start = line_end + 1;
+      }
+      pending.erase(0, line_start);
+    }
+    handle_line(pending);
+
+    runner.wait();
+    ::close(connection);
+  }
+
+  ::close(listener);
+  ::unlink(path.c_str());
+  return true;
+}
+
+} // namespace adapter
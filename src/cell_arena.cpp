@@ -0,0 +1,91 @@
+#include "adapter/cell_arena.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace adapter {
+
+CellArena::CellArena(size_t block_size)
+    : block_size(std::max<size_t>(block_size, 64)), block_used(0),
+      bytes_used(0) {}
+
+CellArena::CellArena(CellArena &&other) noexcept
+    : block_size(other.block_size), blocks(std::move(other.blocks)),
+      block_used(other.block_used), bytes_used(other.bytes_used) {
+  other.blocks.clear();
+  other.block_used = 0;
+  other.bytes_used = 0;
+}
+
+CellArena &CellArena::operator=(CellArena &&other) noexcept {
+  if (this != &other) {
+    block_size = other.block_size;
+    blocks = std::move(other.blocks);
+    block_used = other.block_used;
+    bytes_used = other.bytes_used;
+    other.blocks.clear();
+    other.block_used = 0;
+    other.bytes_used = 0;
+  }
+  return *this;
+}
+
+std::string_view CellArena::store(std::string_view text) {
+  if (text.empty()) {
+    return std::string_view();
+  }
+
+  if (blocks.empty() || blocks.back().capacity - block_used < text.size()) {
+    // Oversized cells get a block of their own
+    Block block;
+    block.capacity = std::max(block_size, text.size());
+    block.data.reset(new char[block.capacity]);
+    blocks.push_back(std::move(block));
+    block_used = 0;
+  }
+
+  char *destination = blocks.back().data.get() + block_used;
+  std::memcpy(destination, text.data(), text.size());
+  block_used += text.size();
+  bytes_used += text.size();
+  return std::string_view(destination, text.size());
+}
+
+void CellArena::absorb(CellArena &&other) {
+  if (other.blocks.empty()) {
+    return;
+  }
+  if (blocks.empty()) {
+    *this = std::move(other);
+    return;
+  }
+
+  // Keep the partly filled block last so store can keep bumping into it
+  blocks.insert(blocks.end() - 1,
+                std::make_move_iterator(other.blocks.begin()),
+                std::make_move_iterator(other.blocks.end()));
+  bytes_used += other.bytes_used;
+  other.blocks.clear();
+  other.block_used = 0;
+  other.bytes_used = 0;
+}
+
+void CellArena::clear() {
+  std::vector<Block>().swap(blocks);
+  block_used = 0;
+  bytes_used = 0;
+}
+
+void CellArena::reset() {
+  if (blocks.size() > 1) {
+    blocks.erase(blocks.begin() + 1, blocks.end());
+  }
+  block_used = 0;
+  bytes_used = 0;
+}
+
+size_t CellArena::get_bytes_used() const { return bytes_used; }
+
+size_t CellArena::get_block_count() const { return blocks.size(); }
+
+} // namespace adapter
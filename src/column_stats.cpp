@@ -0,0 +1,237 @@
+#include "adapter/column_stats.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace adapter {
+
+MedianEstimator::MedianEstimator(size_t exact_limit)
+    : exact_limit(exact_limit), count(0) {}
+
+void MedianEstimator::add(double value) {
+  if (count < exact_limit) {
+    values.push_back(value);
+    ++count;
+    return;
+  }
+  if (count == exact_limit) {
+    start_markers();
+  }
+  ++count;
+  add_to_markers(value);
+}
+
+double MedianEstimator::get_median() {
+  if (count > exact_limit) {
+    return heights[2];
+  }
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  const size_t size = values.size();
+  std::nth_element(values.begin(), values.begin() + size / 2, values.end());
+  const double upper = values[size / 2];
+  if (size % 2 != 0) {
+    return upper;
+  }
+  const double lower =
+      *std::max_element(values.begin(), values.begin() + size / 2);
+  return (lower + upper) / 2.0;
+}
+
+void MedianEstimator::start_markers() {
+  // Seed the markers from the exact prefix, then drop it
+  std::sort(values.begin(), values.end());
+  const double size = static_cast<double>(values.size() - 1);
+  const double quantiles[5] = {0.0, 0.25, 0.5, 0.75, 1.0};
+  for (int i = 0; i < 5; ++i) {
+    positions[i] = quantiles[i] * size;
+    desired[i] = positions[i];
+    heights[i] = values[static_cast<size_t>(positions[i])];
+  }
+  std::vector<double>().swap(values);
+}
+
+void MedianEstimator::add_to_markers(double value) {
+  int cell;
+  if (value < heights[0]) {
+    heights[0] = value;
+    cell = 0;
+  } else if (value >= heights[4]) {
+    heights[4] = std::max(heights[4], value);
+    cell = 3;
+  } else {
+    cell = 0;
+    while (cell < 3 && value >= heights[cell + 1]) {
+      ++cell;
+    }
+  }
+
+  for (int i = cell + 1; i < 5; ++i) {
+    positions[i] += 1.0;
+  }
+  const double increments[5] = {0.0, 0.25, 0.5, 0.75, 1.0};
+  for (int i = 0; i < 5; ++i) {
+    desired[i] += increments[i];
+  }
+
+  for (int i = 1; i < 4; ++i) {
+    const double offset = desired[i] - positions[i];
+    if ((offset >= 1.0 && positions[i + 1] - positions[i] > 1.0) ||
+        (offset <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+      const double step = offset >= 0.0 ? 1.0 : -1.0;
+      double height = parabolic(i, step);
+      if (height <= heights[i - 1] || height >= heights[i + 1]) {
+        const int neighbour = step > 0.0 ? i + 1 : i - 1;
+        height = heights[i] + step * (heights[neighbour] - heights[i]) /
+                                  (positions[neighbour] - positions[i]);
+      }
+      heights[i] = height;
+      positions[i] += step;
+    }
+  }
+}
+
+double MedianEstimator::parabolic(int i, double step) const {
+  const double span = positions[i + 1] - positions[i - 1];
+  const double upper = (positions[i] - positions[i - 1] + step) *
+                       (heights[i + 1] - heights[i]) /
+                       (positions[i + 1] - positions[i]);
+  const double lower = (positions[i + 1] - positions[i] - step) *
+                       (heights[i] - heights[i - 1]) /
+                       (positions[i] - positions[i - 1]);
+  return heights[i] + step / span * (upper + lower);
+}
+
+ColumnStatsAccumulator::ColumnStatsAccumulator(bool track_median,
+                                               size_t exact_median_limit)
+    : track_median(track_median), welford_mean(0.0), welford_m2(0.0),
+      median(exact_median_limit) {}
+
+void ColumnStatsAccumulator::add_value(double value) {
+  ++stats.valid_count;
+  ++stats.numeric_count;
+  stats.sum += value;
+  if (stats.numeric_count == 1) {
+    stats.min = value;
+    stats.max = value;
+  } else {
+    stats.min = std::min(stats.min, value);
+    stats.max = std::max(stats.max, value);
+  }
+
+  const double delta = value - welford_mean;
+  welford_mean += delta / static_cast<double>(stats.numeric_count);
+  welford_m2 += delta * (value - welford_mean);
+
+  if (track_median) {
+    median.add(value);
+  }
+}
+
+void ColumnStatsAccumulator::add_text() { ++stats.valid_count; }
+
+void ColumnStatsAccumulator::add_null() { ++stats.null_count; }
+
+ColumnStats ColumnStatsAccumulator::finish() {
+  ColumnStats result = stats;
+  result.numeric =
+      result.numeric_count > 0 && result.numeric_count == result.valid_count;
+  if (result.numeric_count > 0) {
+    // The plain quotient keeps imputed means identical to a direct sum
+    result.mean = result.sum / static_cast<double>(result.numeric_count);
+  }
+  if (result.numeric_count > 1) {
+    result.variance =
+        welford_m2 / static_cast<double>(result.numeric_count - 1);
+  }
+  if (track_median) {
+    result.has_median = true;
+    result.median = median.get_median();
+  }
+  return result;
+}
+
+ColumnStats compute_column_stats(const Column &column, bool with_median) {
+  ColumnStatsAccumulator accumulator(with_median,
+                                     std::numeric_limits<size_t>::max());
+  const size_t rows = column.size();
+  switch (column.get_type()) {
+  case ColumnType::INT64: {
+    const std::vector<int64_t> &values = column.get_ints();
+    for (size_t row = 0; row < rows; ++row) {
+      if (column.is_valid(row)) {
+        accumulator.add_value(static_cast<double>(values[row]));
+      } else {
+        accumulator.add_null();
+      }
+    }
+    break;
+  }
+  case ColumnType::FLOAT64: {
+    const std::vector<double> &values = column.get_doubles();
+    for (size_t row = 0; row < rows; ++row) {
+      if (column.is_valid(row)) {
+        accumulator.add_value(values[row]);
+      } else {
+        accumulator.add_null();
+      }
+    }
+    break;
+  }
+  case ColumnType::STRING:
+    for (size_t row = 0; row < rows; ++row) {
+      if (column.is_valid(row)) {
+        accumulator.add_text();
+      } else {
+        accumulator.add_null();
+      }
+    }
+    break;
+  }
+  return accumulator.finish();
+}
+
+ColumnStats merge_column_stats(const ColumnStats &earlier,
+                               const ColumnStats &later) {
+  if (earlier.valid_count == 0 && earlier.null_count == 0) {
+    return later;
+  }
+  if (later.valid_count == 0 && later.null_count == 0) {
+    ColumnStats merged = earlier;
+    merged.has_median = false;
+    return merged;
+  }
+
+  ColumnStats merged;
+  merged.valid_count = earlier.valid_count + later.valid_count;
+  merged.null_count = earlier.null_count + later.null_count;
+  merged.numeric_count = earlier.numeric_count + later.numeric_count;
+  merged.numeric = merged.numeric_count > 0 &&
+                   merged.numeric_count == merged.valid_count;
+  merged.sum = earlier.sum + later.sum;
+  merged.has_median = later.has_median;
+  merged.median = later.median;
+  if (earlier.numeric_count == 0 || later.numeric_count == 0) {
+    const ColumnStats &only = earlier.numeric_count > 0 ? earlier : later;
+    merged.min = only.min;
+    merged.max = only.max;
+    merged.mean = only.mean;
+    merged.variance = only.variance;
+    return merged;
+  }
+
+  merged.min = std::min(earlier.min, later.min);
+  merged.max = std::max(earlier.max, later.max);
+  merged.mean = merged.sum / static_cast<double>(merged.numeric_count);
+  const double n_a = static_cast<double>(earlier.numeric_count);
+  const double n_b = static_cast<double>(later.numeric_count);
+  const double delta = later.mean - earlier.mean;
+  const double m2 = earlier.variance * (n_a - 1.0) +
+                    later.variance * (n_b - 1.0) +
+                    delta * delta * n_a * n_b / (n_a + n_b);
+  merged.variance = m2 / (n_a + n_b - 1.0);
+  return merged;
+}
+
+} // namespace adapter
@@ -0,0 +1,565 @@
+#include "adapter/compressed_stream.hpp"
+#include "adapter/thread_pool.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#ifdef ADAPTER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ADAPTER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace adapter {
+
+namespace {
+
+bool ends_with(const std::string &value, const char *suffix) {
+  const size_t length = std::strlen(suffix);
+  return value.size() >= length &&
+         value.compare(value.size() - length, length, suffix) == 0;
+}
+
+// Decodes with a stream decoder, growing output as it fills
+bool decompress_serial(const char *data, size_t size,
+                       StreamCompression compression,
+                       std::vector<char> &output, size_t size_hint) {
+  std::unique_ptr<StreamDecompressor> decompressor =
+      make_stream_decompressor(compression);
+  if (!decompressor) {
+    return false;
+  }
+
+  output.resize(std::max<size_t>({size_hint, size * 4, 1 << 16}));
+  const char *input = data;
+  const char *input_end = data + size;
+  size_t used = 0;
+  while (true) {
+    if (used == output.size()) {
+      output.resize(output.size() * 2);
+    }
+    const char *before = input;
+    size_t produced = 0;
+    if (!decompressor->decompress(input, input_end, output.data() + used,
+                                  output.size() - used, produced)) {
+      output.clear();
+      return false;
+    }
+    used += produced;
+    if (produced == 0 && input == before) {
+      break;
+    }
+  }
+  output.resize(used);
+  return input == input_end && decompressor->finished();
+}
+
+// Where one independently decodable block sits in the compressed input
+// and in the output
+struct Block {
+  size_t begin = 0;
+  size_t size = 0;
+  size_t output_begin = 0;
+  size_t output_size = 0;
+  uint32_t crc = 0;
+};
+
+#ifdef ADAPTER_HAVE_ZLIB
+
+// gzip member header with the BGZF extra field, which records the size of
+// the whole member so the next one can be found without decoding
+constexpr size_t bgzf_header_size = 18;
+constexpr size_t gzip_trailer_size = 8;
+// Input per member; compressing this much always fits the 16-bit size
+constexpr size_t bgzf_block_input = 0xff00;
+constexpr size_t bgzf_max_block = 1 << 16;
+
+const unsigned char bgzf_header[bgzf_header_size - 2] = {
+    0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0};
+// Empty member bgzip ends its files with
+const unsigned char bgzf_eof[28] = {
+    0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C',
+    2,    0,    0x1b, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0,  0};
+
+uint32_t read_le32(const unsigned char *bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         static_cast<uint32_t>(bytes[1]) << 8 |
+         static_cast<uint32_t>(bytes[2]) << 16 |
+         static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+void append_le32(std::vector<char> &output, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    output.push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+// Fails unless every member carries a BGZF size
+bool split_bgzf_blocks(const char *data, size_t size,
+                       std::vector<Block> &blocks, size_t &total) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  total = 0;
+  size_t offset = 0;
+  while (offset < size) {
+    const unsigned char *member = bytes + offset;
+    const size_t remaining = size - offset;
+    if (remaining < bgzf_header_size || member[0] != 0x1f ||
+        member[1] != 0x8b || member[2] != 8 || member[3] != 4) {
+      return false;
+    }
+    const size_t extra_size = member[10] | member[11] << 8;
+    const size_t header_size = 12 + extra_size;
+    size_t member_size = 0;
+    for (size_t field = 12; field + 4 <= header_size;) {
+      const size_t field_size = member[field + 2] | member[field + 3] << 8;
+      if (member[field] == 'B' && member[field + 1] == 'C' &&
+          field_size == 2 && field + 6 <= header_size) {
+        member_size = (member[field + 4] | member[field + 5] << 8) + 1;
+      }
+      field += 4 + field_size;
+    }
+    if (member_size < header_size + gzip_trailer_size ||
+        member_size > remaining) {
+      return false;
+    }
+
+    Block block;
+    block.begin = offset + header_size;
+    block.size = member_size - header_size - gzip_trailer_size;
+    block.output_begin = total;
+    block.output_size = read_le32(member + member_size - 4);
+    block.crc = read_le32(member + member_size - 8);
+    if (block.output_size > bgzf_max_block) {
+      return false;
+    }
+    total += block.output_size;
+    blocks.push_back(block);
+    offset += member_size;
+  }
+  return true;
+}
+
+bool inflate_block(const char *data, const Block &block, char *output) {
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+    return false;
+  }
+  stream.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(data + block.begin));
+  stream.avail_in = static_cast<uInt>(block.size);
+  stream.next_out = reinterpret_cast<Bytef *>(output);
+  stream.avail_out = static_cast<uInt>(block.output_size);
+  const int status = inflate(&stream, Z_FINISH);
+  const bool complete = status == Z_STREAM_END &&
+                        stream.total_out == block.output_size;
+  inflateEnd(&stream);
+  return complete &&
+         crc32(0L, reinterpret_cast<const Bytef *>(output),
+               static_cast<uInt>(block.output_size)) == block.crc;
+}
+
+class GzipDecompressor : public StreamDecompressor {
+public:
+  GzipDecompressor() : member_end(false) {
+    std::memset(&stream, 0, sizeof(stream));
+    // 16 selects the gzip wrapper
+    initialized = inflateInit2(&stream, MAX_WBITS + 16) == Z_OK;
+  }
+  ~GzipDecompressor() override {
+    if (initialized) {
+      inflateEnd(&stream);
+    }
+  }
+
+  void reset() override {
+    if (initialized) {
+      inflateReset(&stream);
+    }
+    member_end = false;
+  }
+
+  bool decompress(const char *&input, const char *input_end, char *output,
+                  size_t output_size, size_t &produced) override {
+    produced = 0;
+    if (!initialized) {
+      return false;
+    }
+    while (produced < output_size) {
+      if (member_end) {
+        // Anything after a member's trailer is the next member
+        if (input == input_end) {
+          break;
+        }
+        inflateReset(&stream);
+        member_end = false;
+      }
+
+      stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input));
+      stream.avail_in = static_cast<uInt>(
+          std::min<size_t>(static_cast<size_t>(input_end - input), UINT_MAX));
+      stream.next_out = reinterpret_cast<Bytef *>(output + produced);
+      stream.avail_out =
+          static_cast<uInt>(std::min<size_t>(output_size - produced, UINT_MAX));
+      const int status = inflate(&stream, Z_NO_FLUSH);
+      input = reinterpret_cast<const char *>(stream.next_in);
+      produced = static_cast<size_t>(
+          reinterpret_cast<char *>(stream.next_out) - output);
+
+      if (status == Z_STREAM_END) {
+        member_end = true;
+      } else if (status == Z_BUF_ERROR) {
+        // Out of input
+        break;
+      } else if (status != Z_OK) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool finished() const override { return member_end; }
+
+private:
+  z_stream stream;
+  bool initialized;
+  bool member_end;
+};
+
+class GzipCompressor : public StreamCompressor {
+public:
+  GzipCompressor() {
+    std::memset(&stream, 0, sizeof(stream));
+    // Raw deflate, the BGZF wrapper is written here. The fastest level,
+    // as for snapshots, keeps compression from dominating the write
+    initialized = deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED,
+                               -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+  }
+  ~GzipCompressor() override {
+    if (initialized) {
+      deflateEnd(&stream);
+    }
+  }
+
+  bool compress(const char *data, size_t size, bool final,
+                std::vector<char> &output) override {
+    if (!initialized) {
+      return false;
+    }
+    while (size > 0) {
+      const size_t chunk = std::min(size, bgzf_block_input);
+      if (!compress_block(data, chunk, output)) {
+        return false;
+      }
+      data += chunk;
+      size -= chunk;
+    }
+    if (final) {
+      output.insert(output.end(), std::begin(bgzf_eof), std::end(bgzf_eof));
+    }
+    return true;
+  }
+
+private:
+  z_stream stream;
+  bool initialized;
+
+  bool compress_block(const char *data, size_t size,
+                      std::vector<char> &output) {
+    const size_t start = output.size();
+    const size_t bound = deflateBound(&stream, static_cast<uLong>(size));
+    output.resize(start + bgzf_header_size + bound);
+
+    deflateReset(&stream);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out =
+        reinterpret_cast<Bytef *>(output.data() + start + bgzf_header_size);
+    stream.avail_out = static_cast<uInt>(bound);
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+      output.resize(start);
+      return false;
+    }
+
+    const size_t member_size =
+        bgzf_header_size + stream.total_out + gzip_trailer_size;
+    if (member_size > bgzf_max_block) {
+      output.resize(start);
+      return false;
+    }
+    std::memcpy(output.data() + start, bgzf_header, sizeof(bgzf_header));
+    output[start + 16] = static_cast<char>((member_size - 1) & 0xff);
+    output[start + 17] = static_cast<char>((member_size - 1) >> 8);
+    output.resize(start + bgzf_header_size + stream.total_out);
+    append_le32(output, static_cast<uint32_t>(crc32(
+                            0L, reinterpret_cast<const Bytef *>(data),
+                            static_cast<uInt>(size))));
+    append_le32(output, static_cast<uint32_t>(size));
+    return true;
+  }
+};
+
+#endif // ADAPTER_HAVE_ZLIB
+
+#ifdef ADAPTER_HAVE_ZSTD
+
+// Fails unless every frame states its content size
+bool split_zstd_frames(const char *data, size_t size,
+                       std::vector<Block> &blocks, size_t &total) {
+  total = 0;
+  size_t offset = 0;
+  while (offset < size) {
+    const size_t frame_size =
+        ZSTD_findFrameCompressedSize(data + offset, size - offset);
+    if (ZSTD_isError(frame_size)) {
+      return false;
+    }
+    const unsigned long long content =
+        ZSTD_getFrameContentSize(data + offset, frame_size);
+    if (content == ZSTD_CONTENTSIZE_UNKNOWN ||
+        content == ZSTD_CONTENTSIZE_ERROR) {
+      return false;
+    }
+
+    Block block;
+    block.begin = offset;
+    block.size = frame_size;
+    block.output_begin = total;
+    block.output_size = static_cast<size_t>(content);
+    total += block.output_size;
+    blocks.push_back(block);
+    offset += frame_size;
+  }
+  return true;
+}
+
+bool decompress_frame(const char *data, const Block &block, char *output) {
+  const size_t written = ZSTD_decompress(output, block.output_size,
+                                         data + block.begin, block.size);
+  return !ZSTD_isError(written) && written == block.output_size;
+}
+
+class ZstdDecompressor : public StreamDecompressor {
+public:
+  ZstdDecompressor() : stream(ZSTD_createDStream()), frame_end(true) {}
+  ~ZstdDecompressor() override { ZSTD_freeDStream(stream); }
+
+  void reset() override {
+    if (stream != nullptr) {
+      ZSTD_DCtx_reset(stream, ZSTD_reset_session_only);
+    }
+    frame_end = true;
+  }
+
+  bool decompress(const char *&input, const char *input_end, char *output,
+                  size_t output_size, size_t &produced) override {
+    produced = 0;
+    if (stream == nullptr) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input, static_cast<size_t>(input_end - input), 0};
+    ZSTD_outBuffer out = {output, output_size, 0};
+    while (out.pos < out.size) {
+      const size_t in_before = in.pos;
+      const size_t out_before = out.pos;
+      const size_t status = ZSTD_decompressStream(stream, &out, &in);
+      if (ZSTD_isError(status)) {
+        return false;
+      }
+      // Zero once a frame is decoded and flushed
+      frame_end = status == 0;
+      if (in.pos == in_before && out.pos == out_before) {
+        break;
+      }
+    }
+    input += in.pos;
+    produced = out.pos;
+    return true;
+  }
+
+  bool finished() const override { return frame_end; }
+
+private:
+  ZSTD_DStream *stream;
+  bool frame_end;
+};
+
+class ZstdCompressor : public StreamCompressor {
+public:
+  ZstdCompressor() : context(ZSTD_createCCtx()) {
+    if (context != nullptr) {
+      ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel,
+                             ZSTD_CLEVEL_DEFAULT);
+    }
+  }
+  ~ZstdCompressor() override { ZSTD_freeCCtx(context); }
+
+  // One frame per call; a one-shot frame records its content size
+  bool compress(const char *data, size_t size, bool,
+                std::vector<char> &output) override {
+    if (context == nullptr) {
+      return false;
+    }
+    if (size == 0) {
+      return true;
+    }
+    const size_t start = output.size();
+    output.resize(start + ZSTD_compressBound(size));
+    const size_t written = ZSTD_compress2(context, output.data() + start,
+                                          output.size() - start, data, size);
+    if (ZSTD_isError(written)) {
+      output.resize(start);
+      return false;
+    }
+    output.resize(start + written);
+    return true;
+  }
+
+private:
+  ZSTD_CCtx *context;
+};
+
+#endif // ADAPTER_HAVE_ZSTD
+
+} // namespace
+
+StreamCompression detect_stream_compression(const char *data, size_t size) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  if (size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) {
+    return StreamCompression::GZIP;
+  }
+  if (size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f &&
+      bytes[3] == 0xfd) {
+    return StreamCompression::ZSTD;
+  }
+  return StreamCompression::NONE;
+}
+
+StreamCompression stream_compression_for_path(const std::string &path) {
+  if (ends_with(path, ".gz") || ends_with(path, ".gzip")) {
+    return StreamCompression::GZIP;
+  }
+  if (ends_with(path, ".zst") || ends_with(path, ".zstd")) {
+    return StreamCompression::ZSTD;
+  }
+  return StreamCompression::NONE;
+}
+
+const char *stream_compression_name(StreamCompression compression) {
+  switch (compression) {
+  case StreamCompression::GZIP:
+    return "gzip";
+  case StreamCompression::ZSTD:
+    return "zstd";
+  case StreamCompression::NONE:
+    break;
+  }
+  return "none";
+}
+
+bool stream_compression_available(StreamCompression compression) {
+  switch (compression) {
+  case StreamCompression::NONE:
+    return true;
+  case StreamCompression::GZIP:
+#ifdef ADAPTER_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  case StreamCompression::ZSTD:
+#ifdef ADAPTER_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+bool decompress_buffer(const char *data, size_t size,
+                       StreamCompression compression,
+                       std::vector<char> &output, size_t thread_count) {
+  output.clear();
+  if (compression == StreamCompression::NONE) {
+    output.assign(data, data + size);
+    return true;
+  }
+
+  std::vector<Block> blocks;
+  size_t total = 0;
+  bool split = false;
+  size_t size_hint = 0;
+  bool (*decode_block)(const char *, const Block &, char *) = nullptr;
+#ifdef ADAPTER_HAVE_ZLIB
+  if (compression == StreamCompression::GZIP) {
+    split = split_bgzf_blocks(data, size, blocks, total);
+    decode_block = inflate_block;
+    // A single member's trailer holds its size modulo 4 GiB; deflate
+    // never expands data more than about a thousandfold
+    if (size >= gzip_trailer_size) {
+      size_hint = std::min<size_t>(
+          read_le32(reinterpret_cast<const unsigned char *>(data + size - 4)),
+          size * 1032);
+    }
+  }
+#endif
+#ifdef ADAPTER_HAVE_ZSTD
+  if (compression == StreamCompression::ZSTD) {
+    split = split_zstd_frames(data, size, blocks, total);
+    decode_block = decompress_frame;
+  }
+#endif
+  if (!split || blocks.empty()) {
+    return decompress_serial(data, size, compression, output, size_hint);
+  }
+
+  output.resize(total);
+  std::vector<char> decoded(blocks.size(), 0);
+  ThreadPool pool(std::max<size_t>(1, std::min(thread_count, blocks.size())));
+  pool.parallel_for(blocks.size(), [&](size_t index) {
+    decoded[index] = decode_block(data, blocks[index],
+                                  output.data() + blocks[index].output_begin);
+  });
+  if (std::find(decoded.begin(), decoded.end(), 0) != decoded.end()) {
+    output.clear();
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<StreamDecompressor>
+make_stream_decompressor(StreamCompression compression) {
+#ifdef ADAPTER_HAVE_ZLIB
+  if (compression == StreamCompression::GZIP) {
+    return std::unique_ptr<StreamDecompressor>(new GzipDecompressor());
+  }
+#endif
+#ifdef ADAPTER_HAVE_ZSTD
+  if (compression == StreamCompression::ZSTD) {
+    return std::unique_ptr<StreamDecompressor>(new ZstdDecompressor());
+  }
+#endif
+  (void)compression;
+  return nullptr;
+}
+
+std::unique_ptr<StreamCompressor>
+make_stream_compressor(StreamCompression compression) {
+#ifdef ADAPTER_HAVE_ZLIB
+  if (compression == StreamCompression::GZIP) {
+    return std::unique_ptr<StreamCompressor>(new GzipCompressor());
+  }
+#endif
+#ifdef ADAPTER_HAVE_ZSTD
+  if (compression == StreamCompression::ZSTD) {
+    return std::unique_ptr<StreamCompressor>(new ZstdCompressor());
+  }
+#endif
+  (void)compression;
+  return nullptr;
+}
+
+} // namespace adapter
@@ -1,4 +1,5 @@
 #include "adapter/config_manager.hpp"
+#include "adapter/table.hpp"
 #include <algorithm>
 #include <fstream>
 #include <iostream>
@@ -112,6 +113,26 @@ void ConfigManager::set_target_time_interval(double interval) {
   settings["target_time_interval"] = std::to_string(interval);
 }
 
+void ConfigManager::set_thread_count(size_t count) {
+  settings["threads"] = std::to_string(count);
+}
+
+void ConfigManager::set_snapshot_file(const std::string &filename) {
+  settings["snapshot_file"] = filename;
+}
+
+void ConfigManager::set_project_columns(bool enabled) {
+  settings["project_columns"] = enabled ? "true" : "false";
+}
+
+void ConfigManager::set_state_file(const std::string &filename) {
+  settings["state_file"] = filename;
+}
+
+void ConfigManager::set_output_format(const std::string &format) {
+  settings["output_format"] = format;
+}
+
 std::string ConfigManager::get_input_file() const {
   auto it = settings.find("input_file");
   return (it != settings.end()) ? it->second : "";
@@ -156,6 +177,158 @@ double ConfigManager::get_target_time_interval() const {
   return 1.0;
 }
 
+std::string ConfigManager::get_solver_method() const {
+  auto it = settings.find("solver_method");
+  return (it != settings.end()) ? it->second : "linear";
+}
+
+std::string ConfigManager::get_spline_boundary() const {
+  auto it = settings.find("spline_boundary");
+  return (it != settings.end()) ? it->second : "natural";
+}
+
+double ConfigManager::get_max_gap() const {
+  auto it = settings.find("max_gap");
+  if (it != settings.end()) {
+    try {
+      return std::stod(it->second);
+    } catch (const std::exception &) {
+      return 0.0; // Default fallback
+    }
+  }
+  return 0.0;
+}
+
+std::string ConfigManager::get_aggregation() const {
+  auto it = settings.find("aggregation");
+  return (it != settings.end()) ? it->second : "none";
+}
+
+std::vector<std::string> ConfigManager::get_derivative_columns() const {
+  auto it = settings.find("derivative_columns");
+  return (it != settings.end()) ? parse_string_list(it->second)
+                                : std::vector<std::string>();
+}
+
+int ConfigManager::get_numeric_precision() const {
+  auto it = settings.find("numeric_precision");
+  if (it != settings.end()) {
+    try {
+      return std::stoi(it->second);
+    } catch (const std::exception &) {
+      return 2; // Default fallback
+    }
+  }
+  return 2;
+}
+
+std::vector<std::string> ConfigManager::get_missing_value_strategies() const {
+  auto it = settings.find("missing_value_strategies");
+  return (it != settings.end()) ? parse_string_list(it->second)
+                                : std::vector<std::string>{"mean"};
+}
+
+std::vector<std::string> ConfigManager::get_column_types() const {
+  auto it = settings.find("column_types");
+  return (it != settings.end()) ? parse_string_list(it->second)
+                                : std::vector<std::string>();
+}
+
+size_t ConfigManager::get_infer_sample_rows() const {
+  auto it = settings.find("infer_sample_rows");
+  if (it != settings.end()) {
+    try {
+      long rows = std::stol(it->second);
+      return rows > 0 ? static_cast<size_t>(rows) : 0;
+    } catch (const std::exception &) {
+      return InferenceOptions::default_sample_rows; // Default fallback
+    }
+  }
+  return InferenceOptions::default_sample_rows;
+}
+
+double ConfigManager::get_infer_sample_fraction() const {
+  auto it = settings.find("infer_sample_fraction");
+  if (it != settings.end()) {
+    try {
+      return std::stod(it->second);
+    } catch (const std::exception &) {
+      return 0.0; // Default fallback
+    }
+  }
+  return 0.0;
+}
+
+std::vector<std::string> ConfigManager::get_dedup_key_columns() const {
+  auto it = settings.find("dedup_key_columns");
+  return (it != settings.end()) ? parse_string_list(it->second)
+                                : std::vector<std::string>();
+}
+
+bool ConfigManager::get_dedup_verify() const {
+  auto it = settings.find("dedup_verify");
+  return it != settings.end() &&
+         (it->second == "true" || it->second == "1" || it->second == "yes");
+}
+
+size_t ConfigManager::get_thread_count() const {
+  auto it = settings.find("threads");
+  if (it != settings.end()) {
+    try {
+      long count = std::stol(it->second);
+      return count > 0 ? static_cast<size_t>(count) : 0;
+    } catch (const std::exception &) {
+      return 1; // Default fallback
+    }
+  }
+  return 1;
+}
+
+size_t ConfigManager::get_pipeline_depth() const {
+  auto it = settings.find("pipeline_depth");
+  if (it != settings.end()) {
+    try {
+      long depth = std::stol(it->second);
+      return depth > 0 ? static_cast<size_t>(depth) : 0;
+    } catch (const std::exception &) {
+      return 2; // Default fallback
+    }
+  }
+  return 2;
+}
+
+bool ConfigManager::get_direct_io() const {
+  auto it = settings.find("direct_io");
+  return it != settings.end() &&
+         (it->second == "true" || it->second == "1" || it->second == "yes");
+}
+
+std::string ConfigManager::get_snapshot_file() const {
+  auto it = settings.find("snapshot_file");
+  return (it != settings.end()) ? it->second : "";
+}
+
+std::string ConfigManager::get_snapshot_compression() const {
+  auto it = settings.find("snapshot_compression");
+  return (it != settings.end()) ? it->second : "none";
+}
+
+bool ConfigManager::get_project_columns() const {
+  auto it = settings.find("project_columns");
+  return it != settings.end() &&
+         (it->second == "true" || it->second == "1" || it->second == "yes");
+}
+
+std::string ConfigManager::get_state_file() const {
+  auto it = settings.find("state_file");
+  return (it != settings.end()) ? it->second : "";
+}
+
+std::string ConfigManager::get_output_format() const {
+  auto it = settings.find("output_format");
+  return (it != settings.end()) ? it->second : "csv";
+}
+
 void ConfigManager::print_configuration() const {
   std::cout << "=== Current Configuration ===" << std::endl;
   std::cout << "Input File: " << get_input_file() << std::endl;
@@ -192,8 +365,26 @@ void ConfigManager::set_default_values() {
   settings["delimiter"] = ",";
   settings["target_time_interval"] = "1.0";
   settings["solver_method"] = "linear";
+  settings["spline_boundary"] = "natural";
+  settings["derivative_columns"] = "";
+  settings["max_gap"] = "0";
+  settings["aggregation"] = "none";
   settings["numeric_precision"] = "2";
   settings["date_format"] = "%Y-%m-%d";
+  settings["missing_value_strategies"] = "mean";
+  settings["column_types"] = "";
+  settings["infer_sample_rows"] = "10000";
+  settings["infer_sample_fraction"] = "0";
+  settings["dedup_key_columns"] = "";
+  settings["dedup_verify"] = "false";
+  settings["threads"] = "1";
+  settings["direct_io"] = "false";
+  settings["pipeline_depth"] = "2";
+  settings["snapshot_file"] = "";
+  settings["snapshot_compression"] = "none";
+  settings["project_columns"] = "false";
+  settings["state_file"] = "";
+  settings["output_format"] = "csv";
 }
 
 std::vector<std::string>
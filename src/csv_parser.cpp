@@ -1,56 +1,219 @@
 #include "adapter/csv_parser.hpp"
+#include "adapter/csv_tokenizer.hpp"
+#include "adapter/mapped_file.hpp"
+#include "adapter/thread_pool.hpp"
 #include <algorithm>
-#include <fstream>
 #include <iostream>
-#include <sstream>
 
 namespace adapter {
 
-CsvParser::CsvParser() : delimiter(',') {}
+namespace {
+
+// End of the last record in [begin, end) that a newline outside quotes
+// terminates, or begin if there is none.
+size_t complete_records_end(const char *data, size_t begin, size_t end) {
+  size_t quotes =
+      static_cast<size_t>(std::count(data + begin, data + end, '"'));
+  size_t position = end;
+  while (position > begin) {
+    const char c = data[--position];
+    if (c == '"') {
+      --quotes;
+    } else if (c == '\n' && quotes % 2 == 0) {
+      return position + 1;
+    }
+  }
+  return begin;
+}
+
+} // namespace
+
+CsvParser::CsvParser()
+    : delimiter(','), thread_count(1), malformed_count(0), bytes_read(0),
+      snapshot_compression(SnapshotCompression::NONE), from_snapshot(false),
+      field_count(0), partial(false), start_offset(0), end_offset(0) {}
 
 CsvParser::~CsvParser() {}
 
 bool CsvParser::load_file(const std::string &filename) {
   this->filename = filename;
-  std::ifstream file(filename);
+  table.clear();
+  headers.clear();
+  malformed_count = 0;
+  bytes_read = 0;
+  from_snapshot = false;
+  field_count = 0;
+  projected_fields.clear();
+  end_offset = 0;
+
+  SnapshotSource source;
+  const bool snapshot_usable =
+      !snapshot_file.empty() && !partial &&
+      describe_snapshot_source(filename, delimiter, source);
+  if (snapshot_usable && load_snapshot(source)) {
+    project_table();
+    return true;
+  }
 
-  if (!file.is_open()) {
+  // Compressed input is decoded in memory and tokenized from there
+  MappedFile file;
+  if (!file.open_decompressed(filename, thread_count)) {
     std::cerr << "Error: Could not open file " << filename << std::endl;
     return false;
   }
+  const char *data = file.data();
+  size_t size = file.size();
+  StructuralScanner scanner(delimiter);
+
+  CsvTokenizer header_tokenizer(data, data + size, scanner);
+  std::vector<std::string_view> cells;
+  if (header_tokenizer.next_record(cells)) {
+    headers.assign(cells.begin(), cells.end());
+  }
+  field_count = headers.size();
+  // A snapshot must serve any projection, so it is parsed in full
+  if (!snapshot_usable) {
+    resolve_projection(headers);
+  }
+  size_t data_begin = header_tokenizer.get_offset();
+  if (partial) {
+    data_begin = std::min(std::max(data_begin, start_offset), size);
+    size = complete_records_end(data, data_begin, size);
+  }
+  bytes_read = size - (partial ? data_begin : 0);
+  end_offset = size;
+
+  // Split the data section into chunks that start on record boundaries
+  std::vector<size_t> boundaries = {data_begin, size};
+  const size_t data_size = size - data_begin;
+  if (thread_count > 1 && data_size >= min_parallel_bytes) {
+    boundaries = find_chunk_boundaries(data, data_begin, size, scanner);
+  }
 
-  data.clear();
-  headers.clear();
-  column_indices.clear();
+  const size_t chunk_count = boundaries.size() - 1;
+  chunks.resize(chunk_count);
+  for (auto &chunk : chunks) {
+    chunk.builder.reset(headers);
+    chunk.record_count = 0;
+    chunk.malformed_rows.clear();
+  }
+
+  ThreadPool pool(chunk_count > 1 ? thread_count : 1);
+  pool.parallel_for(chunk_count, [&](size_t index) {
+    parse_records(data + boundaries[index], data + boundaries[index + 1],
+                  scanner, chunks[index]);
+  });
+
+  // Stitch chunks back together in file order, behind the first one
+  TableBuilder &builder = chunks.front().builder;
+  size_t records_before = 0;
+  for (size_t index = 0; index < chunk_count; ++index) {
+    ChunkResult &chunk = chunks[index];
+    for (const auto &malformed : chunk.malformed_rows) {
+      std::cerr << "Warning: Skipping malformed row "
+                << records_before + malformed.first + 1 << " with "
+                << malformed.second << " columns (expected " << field_count
+                << ")" << std::endl;
+    }
+    malformed_count += chunk.malformed_rows.size();
+    records_before += chunk.record_count;
+    if (index > 0) {
+      builder.append_rows(std::move(chunk.builder));
+    }
+  }
+  if (!schema.empty() && schema.size() == headers.size()) {
+    builder.set_schema(schema);
+  }
+  builder.set_inference(inference);
+
+  table = builder.finish(&pool);
+  file.close();
 
-  std::string line;
-  bool is_first_line = true;
+  if (snapshot_usable && !write_table_snapshot(table, source, snapshot_file,
+                                               snapshot_compression)) {
+    std::cerr << "Warning: Could not write snapshot " << snapshot_file
+              << std::endl;
+  }
+  if (snapshot_usable) {
+    project_table();
+  }
+  return true;
+}
 
-  while (std::getline(file, line)) {
-    if (line.empty()) {
+bool CsvParser::load_snapshot(const SnapshotSource &source) {
+  SnapshotInfo info;
+  if (!read_table_snapshot(snapshot_file, source, table, &info)) {
+    return false;
+  }
+  for (size_t col = 0; col < table.get_column_count(); ++col) {
+    Column &column = table.get_column(col);
+    auto fixed = inference.column_kinds.find(column.get_name());
+    if (fixed == inference.column_kinds.end()) {
       continue;
     }
-
-    if (is_first_line) {
-      parse_headers(line);
-      is_first_line = false;
-    } else {
-      std::vector<std::string> row = split_line(line);
-      if (row.size() == headers.size()) {
-        data.push_back(row);
-      } else {
-        std::cerr << "Warning: Skipping malformed row with " << row.size()
-                  << " columns (expected " << headers.size() << ")"
-                  << std::endl;
-      }
+    if (column.get_type() != column_kind_storage(fixed->second)) {
+      std::cout << "Snapshot " << snapshot_file << " types column '"
+                << column.get_name() << "' differently, parsing again"
+                << std::endl;
+      table.clear();
+      return false;
     }
+    column.set_kind(fixed->second);
   }
 
-  file.close();
-  build_column_indices();
+  headers = table.get_headers();
+  bytes_read = info.file_size;
+  end_offset = source.size;
+  from_snapshot = true;
+  std::cout << "Loaded snapshot " << snapshot_file << std::endl;
   return true;
 }
 
+void CsvParser::resolve_projection(
+    const std::vector<std::string> &file_headers) {
+  projected_fields.clear();
+  if (projection.empty()) {
+    return;
+  }
+
+  std::vector<std::string> kept;
+  for (size_t field = 0; field < file_headers.size(); ++field) {
+    if (std::find(projection.begin(), projection.end(), file_headers[field]) !=
+        projection.end()) {
+      projected_fields.push_back(field);
+      kept.push_back(file_headers[field]);
+    }
+  }
+  for (const auto &name : projection) {
+    if (std::find(file_headers.begin(), file_headers.end(), name) ==
+        file_headers.end()) {
+      std::cerr << "Warning: Projected column '" << name << "' not found"
+                << std::endl;
+    }
+  }
+  if (kept.empty()) {
+    std::cerr << "Warning: No projected columns found, keeping all columns"
+              << std::endl;
+    projected_fields.clear();
+    return;
+  }
+  headers = std::move(kept);
+}
+
+void CsvParser::project_table() {
+  resolve_projection(table.get_headers());
+  if (projected_fields.empty()) {
+    return;
+  }
+
+  Table projected;
+  for (size_t field : projected_fields) {
+    projected.add_column(std::move(table.get_column(field)));
+  }
+  table = std::move(projected);
+  projected_fields.clear();
+}
+
 bool CsvParser::parse_data() {
   if (filename.empty()) {
     std::cerr << "Error: No file loaded" << std::endl;
@@ -59,104 +222,173 @@ bool CsvParser::parse_data() {
   return load_file(filename);
 }
 
-std::vector<std::string> CsvParser::get_headers() const { return headers; }
+const std::vector<std::string> &CsvParser::get_headers() const {
+  return headers;
+}
 
 std::vector<std::vector<std::string>> CsvParser::get_data() const {
-  return data;
+  return table.to_rows();
 }
 
 std::vector<std::string>
 CsvParser::get_column(const std::string &column_name) const {
   std::vector<std::string> column;
 
-  auto it = column_indices.find(column_name);
-  if (it == column_indices.end()) {
+  size_t column_index = table.find_column(column_name);
+  if (column_index == Table::npos) {
     std::cerr << "Error: Column '" << column_name << "' not found" << std::endl;
     return column;
   }
 
-  size_t column_index = it->second;
-  for (const auto &row : data) {
-    if (column_index < row.size()) {
-      column.push_back(row[column_index]);
-    }
+  const Column &source = table.get_column(column_index);
+  column.reserve(source.size());
+  for (size_t row = 0; row < source.size(); ++row) {
+    column.push_back(source.to_string(row));
   }
 
   return column;
 }
 
-size_t CsvParser::get_row_count() const { return data.size(); }
+const Table &CsvParser::get_table() const { return table; }
+
+Table CsvParser::take_table() {
+  Table taken = std::move(table);
+  table.clear();
+  return taken;
+}
+
+size_t CsvParser::get_row_count() const { return table.get_row_count(); }
 
 size_t CsvParser::get_column_count() const { return headers.size(); }
 
+size_t CsvParser::get_malformed_count() const { return malformed_count; }
+
+size_t CsvParser::get_bytes_read() const { return bytes_read; }
+
 void CsvParser::set_delimiter(char delimiter) { this->delimiter = delimiter; }
 
-void CsvParser::parse_headers(const std::string &line) {
-  headers = split_line(line);
+void CsvParser::set_thread_count(size_t count) {
+  thread_count = count == 0 ? 1 : count;
+}
 
-  // Trim whitespace from headers
-  for (auto &header : headers) {
-    header.erase(header.begin(), std::find_if(header.begin(), header.end(),
-                                              [](unsigned char ch) {
-                                                return !std::isspace(ch);
-                                              }));
-    header.erase(
-        std::find_if(header.rbegin(), header.rend(),
-                     [](unsigned char ch) { return !std::isspace(ch); })
-            .base(),
-        header.end());
-  }
+size_t CsvParser::get_thread_count() const { return thread_count; }
+
+void CsvParser::set_snapshot_file(const std::string &path) {
+  snapshot_file = path;
 }
 
-std::vector<std::string> CsvParser::split_line(const std::string &line) const {
-  std::vector<std::string> result;
-  std::stringstream ss(line);
-  std::string cell;
+void CsvParser::set_snapshot_compression(SnapshotCompression compression) {
+  snapshot_compression = compression;
+}
 
-  bool in_quotes = false;
-  std::string current_cell;
+bool CsvParser::is_from_snapshot() const { return from_snapshot; }
 
-  for (size_t i = 0; i < line.length(); ++i) {
-    char c = line[i];
+void CsvParser::set_projection(const std::vector<std::string> &columns) {
+  projection = columns;
+}
 
-    if (c == '"') {
-      in_quotes = !in_quotes;
-    } else if (c == delimiter && !in_quotes) {
-      result.push_back(current_cell);
-      current_cell.clear();
-    } else {
-      current_cell += c;
-    }
-  }
+void CsvParser::set_start_offset(size_t offset) {
+  partial = true;
+  start_offset = offset;
+}
 
-  // Add the last cell
-  result.push_back(current_cell);
+size_t CsvParser::get_end_offset() const { return end_offset; }
 
-  // Clean up quotes from cells
-  for (auto &cell : result) {
-    if (cell.length() >= 2 && cell.front() == '"' && cell.back() == '"') {
-      cell = cell.substr(1, cell.length() - 2);
-    }
+void CsvParser::set_inference(const InferenceOptions &options) {
+  inference = options;
+}
+
+void CsvParser::set_schema(const std::vector<ColumnSchema> &schema) {
+  this->schema = schema;
+}
 
-    // Trim whitespace
-    cell.erase(cell.begin(),
-               std::find_if(cell.begin(), cell.end(), [](unsigned char ch) {
-                 return !std::isspace(ch);
-               }));
-    cell.erase(std::find_if(cell.rbegin(), cell.rend(),
-                            [](unsigned char ch) { return !std::isspace(ch); })
-                   .base(),
-               cell.end());
+std::vector<std::string> CsvParser::split_line(const std::string &line) const {
+  CsvTokenizer tokenizer(line.data(), line.data() + line.size(), delimiter);
+  std::vector<std::string_view> cells;
+  if (!tokenizer.next_record(cells)) {
+    // Blank lines hold a single empty cell
+    return std::vector<std::string>(1);
   }
+  return std::vector<std::string>(cells.begin(), cells.end());
+}
 
-  return result;
+void CsvParser::parse_records(const char *begin, const char *end,
+                              const StructuralScanner &scanner,
+                              ChunkResult &result) const {
+  CsvTokenizer tokenizer(begin, end, scanner);
+  std::vector<std::string_view> cells;
+  std::vector<std::string_view> projected(projected_fields.size());
+
+  while (tokenizer.next_record(cells)) {
+    if (cells.size() != field_count) {
+      result.malformed_rows.push_back({result.record_count, cells.size()});
+    } else if (projected_fields.empty()) {
+      result.builder.append_row(cells);
+    } else {
+      for (size_t i = 0; i < projected_fields.size(); ++i) {
+        projected[i] = cells[projected_fields[i]];
+      }
+      result.builder.append_row(projected);
+    }
+    ++result.record_count;
+  }
 }
 
-void CsvParser::build_column_indices() {
-  column_indices.clear();
-  for (size_t i = 0; i < headers.size(); ++i) {
-    column_indices[headers[i]] = i;
+std::vector<size_t>
+CsvParser::find_chunk_boundaries(const char *data, size_t begin, size_t end,
+                                 const StructuralScanner &scanner) const {
+  const size_t chunk_count = thread_count * 2;
+  const size_t chunk_size = (end - begin + chunk_count - 1) / chunk_count;
+
+  // Quote parity at each nominal chunk start tells whether it is quoted
+  std::vector<size_t> starts(chunk_count);
+  std::vector<size_t> quote_counts(chunk_count, 0);
+  for (size_t i = 0; i < chunk_count; ++i) {
+    starts[i] = std::min(end, begin + i * chunk_size);
+  }
+
+  ThreadPool pool(thread_count);
+  pool.parallel_for(chunk_count, [&](size_t i) {
+    const size_t chunk_end = (i + 1 < chunk_count) ? starts[i + 1] : end;
+    size_t position = starts[i];
+    size_t count = 0;
+    for (; position + StructuralScanner::block_size <= chunk_end;
+         position += StructuralScanner::block_size) {
+      count += static_cast<size_t>(
+          __builtin_popcountll(scanner.scan_block(data + position).quotes));
+    }
+    for (; position < chunk_end; ++position) {
+      count += data[position] == '"';
+    }
+    quote_counts[i] = count;
+  });
+
+  std::vector<size_t> boundaries = {begin};
+  bool in_quotes = false;
+  for (size_t i = 1; i < chunk_count; ++i) {
+    in_quotes ^= (quote_counts[i - 1] & 1) != 0;
+
+    // First unquoted newline at or after the nominal start; a previous
+    // boundary past this start is already outside quotes
+    bool quoted = in_quotes;
+    size_t position = starts[i];
+    if (boundaries.back() > position) {
+      position = boundaries.back();
+      quoted = false;
+    }
+    for (; position < end; ++position) {
+      const char c = data[position];
+      if (c == '"') {
+        quoted = !quoted;
+      } else if (c == '\n' && !quoted) {
+        ++position;
+        break;
+      }
+    }
+    boundaries.push_back(std::max(position, boundaries.back()));
   }
+  boundaries.push_back(end);
+  return boundaries;
 }
 
 } // namespace adapter
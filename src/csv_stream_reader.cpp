@@ -0,0 +1,243 @@
+#include "adapter/csv_stream_reader.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+namespace adapter {
+
+CsvStreamReader::CsvStreamReader()
+    : fd(-1), buffer_size(1 << 20), region_end(0), buffer_end(0),
+      at_eof(false), scanner(','), record_count(0), malformed_count(0),
+      bytes_read(0), report_malformed(true),
+      compression(StreamCompression::NONE), compressed_begin(0),
+      compressed_end(0), source_eof(false) {}
+
+CsvStreamReader::~CsvStreamReader() { close(); }
+
+bool CsvStreamReader::open(const std::string &filename, char delimiter) {
+  close();
+
+  fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Error: Could not open file " << filename << std::endl;
+    return false;
+  }
+
+  unsigned char magic[4] = {};
+  const ssize_t magic_size = ::pread(fd, magic, sizeof(magic), 0);
+  const StreamCompression compression = detect_stream_compression(
+      reinterpret_cast<const char *>(magic),
+      magic_size > 0 ? static_cast<size_t>(magic_size) : 0);
+  if (compression != StreamCompression::NONE) {
+    decompressor = make_stream_decompressor(compression);
+    if (!decompressor) {
+      std::cerr << "Error: " << filename << " is "
+                << stream_compression_name(compression)
+                << " compressed, which this build cannot read" << std::endl;
+      close();
+      return false;
+    }
+    this->compression = compression;
+    compressed.resize(1 << 16);
+  }
+
+  scanner = StructuralScanner(delimiter);
+  bytes_read = 0;
+  return rewind();
+}
+
+void CsvStreamReader::close() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  tokenizer.reset();
+  std::vector<char>().swap(buffer);
+  headers.clear();
+  decompressor.reset();
+  std::vector<char>().swap(compressed);
+  compression = StreamCompression::NONE;
+}
+
+bool CsvStreamReader::rewind() {
+  if (fd < 0 || ::lseek(fd, 0, SEEK_SET) != 0) {
+    return false;
+  }
+
+  tokenizer.reset();
+  if (decompressor) {
+    decompressor->reset();
+  }
+  compressed_begin = 0;
+  compressed_end = 0;
+  source_eof = false;
+  buffer.resize(buffer_size);
+  region_end = 0;
+  buffer_end = 0;
+  at_eof = false;
+  record_count = 0;
+  malformed_count = 0;
+  return read_headers();
+}
+
+const std::vector<std::string> &CsvStreamReader::get_headers() const {
+  return headers;
+}
+
+void CsvStreamReader::set_buffer_size(size_t bytes) {
+  buffer_size = bytes < 4096 ? 4096 : bytes;
+}
+
+bool CsvStreamReader::next_record(std::vector<std::string_view> &cells) {
+  while (true) {
+    if (tokenizer && tokenizer->next_record(cells)) {
+      return true;
+    }
+    if (!fill()) {
+      return false;
+    }
+  }
+}
+
+bool CsvStreamReader::next_row(std::vector<std::string_view> &cells) {
+  while (next_record(cells)) {
+    ++record_count;
+    if (cells.size() == headers.size()) {
+      return true;
+    }
+
+    ++malformed_count;
+    if (report_malformed) {
+      std::cerr << "Warning: Skipping malformed row " << record_count
+                << " with " << cells.size() << " columns (expected "
+                << headers.size() << ")" << std::endl;
+    }
+  }
+  return false;
+}
+
+size_t CsvStreamReader::read_batch(TableBuilder &builder, size_t max_rows) {
+  size_t appended = 0;
+  while (appended < max_rows && next_row(batch_cells)) {
+    builder.append_row(batch_cells);
+    ++appended;
+  }
+  return appended;
+}
+
+void CsvStreamReader::set_report_malformed(bool report) {
+  report_malformed = report;
+}
+
+size_t CsvStreamReader::get_record_count() const { return record_count; }
+
+size_t CsvStreamReader::get_malformed_count() const {
+  return malformed_count;
+}
+
+size_t CsvStreamReader::get_bytes_read() const { return bytes_read; }
+
+StreamCompression CsvStreamReader::get_compression() const {
+  return compression;
+}
+
+bool CsvStreamReader::fill() {
+  // Keep the incomplete record left over from the previous fill
+  const size_t leftover = buffer_end - region_end;
+  if (at_eof && leftover == 0) {
+    return false;
+  }
+  tokenizer.reset();
+  std::memmove(buffer.data(), buffer.data() + region_end, leftover);
+  buffer_end = leftover;
+  region_end = 0;
+
+  while (region_end == 0) {
+    if (at_eof) {
+      region_end = buffer_end;
+      break;
+    }
+
+    // A single record larger than the buffer grows it
+    if (buffer_end == buffer.size()) {
+      buffer.resize(buffer.size() * 2);
+    }
+
+    ssize_t count = read_source(buffer.data() + buffer_end,
+                                buffer.size() - buffer_end);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      at_eof = true;
+      continue;
+    }
+    buffer_end += static_cast<size_t>(count);
+    bytes_read += static_cast<size_t>(count);
+    region_end = find_last_record_end(buffer.data(),
+                                      buffer.data() + buffer_end, scanner);
+  }
+
+  if (region_end == 0) {
+    return false;
+  }
+
+  tokenizer.reset(new CsvTokenizer(buffer.data(), buffer.data() + region_end,
+                                   scanner));
+  return true;
+}
+
+ssize_t CsvStreamReader::read_source(char *destination, size_t size) {
+  if (!decompressor) {
+    return ::read(fd, destination, size);
+  }
+
+  while (true) {
+    if (compressed_begin == compressed_end && !source_eof) {
+      const ssize_t count = ::read(fd, compressed.data(), compressed.size());
+      if (count < 0) {
+        return count;
+      }
+      compressed_begin = 0;
+      compressed_end = static_cast<size_t>(count);
+      source_eof = count == 0;
+    }
+
+    const char *input = compressed.data() + compressed_begin;
+    const char *input_end = compressed.data() + compressed_end;
+    size_t produced = 0;
+    const bool decoded =
+        decompressor->decompress(input, input_end, destination, size, produced);
+    const size_t consumed =
+        static_cast<size_t>(input - (compressed.data() + compressed_begin));
+    compressed_begin += consumed;
+    if (!decoded || (produced == 0 && consumed == 0 &&
+                     compressed_begin < compressed_end)) {
+      std::cerr << "Error: Compressed input is corrupt" << std::endl;
+      errno = EIO;
+      return -1;
+    }
+    if (produced > 0) {
+      return static_cast<ssize_t>(produced);
+    }
+    if (source_eof && compressed_begin == compressed_end) {
+      if (!decompressor->finished()) {
+        std::cerr << "Warning: Compressed input ends mid-stream" << std::endl;
+      }
+      return 0;
+    }
+  }
+}
+
+bool CsvStreamReader::read_headers() {
+  headers.clear();
+  std::vector<std::string_view> cells;
+  if (next_record(cells)) {
+    headers.assign(cells.begin(), cells.end());
+  }
+  return true;
+}
+
+} // namespace adapter
@@ -0,0 +1,202 @@
+#include "adapter/csv_tokenizer.hpp"
+#include <cctype>
+
+namespace adapter {
+
+namespace {
+
+bool is_space(char c) { return std::isspace(static_cast<unsigned char>(c)); }
+
+std::string_view trim(const char *cell_begin, const char *cell_end) {
+  while (cell_begin < cell_end && is_space(*cell_begin)) {
+    ++cell_begin;
+  }
+  while (cell_end > cell_begin && is_space(cell_end[-1])) {
+    --cell_end;
+  }
+  return std::string_view(cell_begin,
+                          static_cast<size_t>(cell_end - cell_begin));
+}
+
+size_t highest_bit(uint64_t bits) {
+  return 63 - static_cast<size_t>(__builtin_clzll(bits));
+}
+
+} // namespace
+
+CsvTokenizer::CsvTokenizer(const char *begin, const char *end, char delimiter)
+    : CsvTokenizer(begin, end, StructuralScanner(delimiter)) {}
+
+CsvTokenizer::CsvTokenizer(const char *begin, const char *end,
+                           const StructuralScanner &scanner)
+    : begin(begin), length(static_cast<size_t>(end - begin)), cursor(0),
+      scanner(scanner), block_loaded(false), block_offset(0),
+      structural_bits(0), quote_bits(0), quote_carry(0), last_quote(npos) {}
+
+bool CsvTokenizer::next_record(std::vector<std::string_view> &cells) {
+  while (cursor < length) {
+    cells.clear();
+    scratch.clear();
+    scratch_cells.clear();
+
+    const size_t record_begin = cursor;
+    size_t cell_begin = cursor;
+    size_t record_end = length;
+    size_t position = 0;
+
+    while (next_structural(position)) {
+      if (begin[position] == '\n') {
+        record_end = position;
+        break;
+      }
+      add_cell(cells, cell_begin, position);
+      cell_begin = position + 1;
+    }
+
+    cursor = (record_end < length) ? record_end + 1 : length;
+
+    // Skip blank lines
+    const bool cell_has_quotes =
+        last_quote != npos && last_quote >= cell_begin &&
+        last_quote < record_end;
+    if (cells.empty() && !cell_has_quotes &&
+        trim(begin + record_begin, begin + record_end).empty()) {
+      continue;
+    }
+
+    add_cell(cells, cell_begin, record_end);
+
+    // Scratch may have reallocated while the record was split
+    for (const ScratchCell &cell : scratch_cells) {
+      cells[cell.index] =
+          std::string_view(scratch.data() + cell.offset, cell.length);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+size_t CsvTokenizer::get_offset() const { return cursor; }
+
+bool CsvTokenizer::next_structural(size_t &position) {
+  while (structural_bits == 0) {
+    if (!load_next_block()) {
+      return false;
+    }
+  }
+
+  const size_t bit = static_cast<size_t>(__builtin_ctzll(structural_bits));
+  structural_bits &= structural_bits - 1;
+  position = block_offset + bit;
+
+  // Remember the last quote before this position for has-quotes checks
+  const uint64_t quotes_before = quote_bits & ((uint64_t(1) << bit) - 1);
+  if (quotes_before != 0) {
+    last_quote = block_offset + highest_bit(quotes_before);
+  }
+  return true;
+}
+
+bool CsvTokenizer::load_next_block() {
+  if (block_loaded && quote_bits != 0) {
+    last_quote = block_offset + highest_bit(quote_bits);
+  }
+
+  const size_t next_offset =
+      block_loaded ? block_offset + StructuralScanner::block_size : 0;
+  if (next_offset >= length) {
+    return false;
+  }
+
+  const size_t remaining = length - next_offset;
+  StructuralMasks masks;
+  if (remaining >= StructuralScanner::block_size) {
+    masks = scanner.scan_block(begin + next_offset);
+  } else {
+    masks = scanner.scan_partial_block(begin + next_offset, remaining);
+    const uint64_t valid = (uint64_t(1) << remaining) - 1;
+    masks.quotes &= valid;
+    masks.delimiters &= valid;
+    masks.newlines &= valid;
+  }
+
+  // Bytes inside quotes, carrying the open-quote state across blocks
+  const uint64_t in_quotes = prefix_xor(masks.quotes) ^ quote_carry;
+  quote_carry = static_cast<uint64_t>(static_cast<int64_t>(in_quotes) >> 63);
+
+  block_loaded = true;
+  block_offset = next_offset;
+  quote_bits = masks.quotes;
+  structural_bits = (masks.delimiters | masks.newlines) & ~in_quotes;
+  return true;
+}
+
+void CsvTokenizer::add_cell(std::vector<std::string_view> &cells,
+                            size_t cell_begin, size_t cell_end) {
+  const bool has_quotes = last_quote != npos && last_quote >= cell_begin &&
+                          last_quote < cell_end;
+  const char *first = begin + cell_begin;
+  const char *last = begin + cell_end;
+
+  if (!has_quotes) {
+    cells.push_back(trim(first, last));
+    return;
+  }
+
+  // Drop quote characters; a doubled quote inside quotes is a literal quote
+  const size_t offset = scratch.size();
+  bool in_quotes = false;
+  for (const char *p = first; p < last; ++p) {
+    if (*p == '"') {
+      if (in_quotes && p + 1 < last && p[1] == '"') {
+        scratch.push_back('"');
+        ++p;
+      } else {
+        in_quotes = !in_quotes;
+      }
+    } else {
+      scratch.push_back(*p);
+    }
+  }
+
+  std::string_view unescaped =
+      trim(scratch.data() + offset, scratch.data() + scratch.size());
+  size_t trimmed_offset =
+      static_cast<size_t>(unescaped.data() - scratch.data());
+  scratch_cells.push_back({cells.size(), trimmed_offset, unescaped.size()});
+  cells.push_back(std::string_view());
+}
+
+size_t find_last_record_end(const char *begin, const char *end,
+                            const StructuralScanner &scanner) {
+  const size_t length = static_cast<size_t>(end - begin);
+  size_t last_end = 0;
+  uint64_t quote_carry = 0;
+
+  for (size_t offset = 0; offset < length;
+       offset += StructuralScanner::block_size) {
+    const size_t remaining = length - offset;
+    StructuralMasks masks;
+    if (remaining >= StructuralScanner::block_size) {
+      masks = scanner.scan_block(begin + offset);
+    } else {
+      masks = scanner.scan_partial_block(begin + offset, remaining);
+      const uint64_t valid = (uint64_t(1) << remaining) - 1;
+      masks.quotes &= valid;
+      masks.newlines &= valid;
+    }
+
+    const uint64_t in_quotes = prefix_xor(masks.quotes) ^ quote_carry;
+    quote_carry = static_cast<uint64_t>(static_cast<int64_t>(in_quotes) >> 63);
+
+    const uint64_t newlines = masks.newlines & ~in_quotes;
+    if (newlines != 0) {
+      last_end = offset + highest_bit(newlines) + 1;
+    }
+  }
+
+  return last_end;
+}
+
+} // namespace adapter
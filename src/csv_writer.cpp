@@ -0,0 +1,362 @@
+#include "adapter/csv_writer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace adapter {
+
+namespace {
+
+// O_DIRECT transfers must start and end on this boundary
+constexpr size_t block_size = 4096;
+constexpr size_t min_buffer_size = 64 * 1024;
+
+// Widest fixed-notation double (1e308) plus sign and point, before the
+// fractional digits
+constexpr size_t max_number_width = 320;
+
+struct ColumnWriter {
+  const Column *column = nullptr;
+  ColumnType type = ColumnType::STRING;
+  int precision = -1;
+  bool has_nulls = false;
+  // Dictionary entries, already quoted where needed
+  std::vector<std::string> fields;
+};
+
+} // namespace
+
+CsvWriter::CsvWriter()
+    : fd(-1), direct(false), direct_requested(false), failed(false),
+      delimiter(','), rows_written(0), bytes_written(0),
+      buffer_size(default_buffer_size), buffer(nullptr), used(0),
+      compression(StreamCompression::NONE) {}
+
+CsvWriter::~CsvWriter() { close(); }
+
+void CsvWriter::set_buffer_size(size_t bytes) {
+  bytes = std::max(bytes, min_buffer_size);
+  buffer_size = (bytes + block_size - 1) / block_size * block_size;
+}
+
+void CsvWriter::set_direct_io(bool enabled) { direct_requested = enabled; }
+
+bool CsvWriter::open(const std::string &filename, char delimiter,
+                     bool append) {
+  close();
+
+  compression = stream_compression_for_path(filename);
+  compressor.reset();
+  if (compression != StreamCompression::NONE) {
+    compressor = make_stream_compressor(compression);
+    if (!compressor) {
+      std::cerr << "Error: This build cannot write "
+                << stream_compression_name(compression) << " output '"
+                << filename << "'" << std::endl;
+      return false;
+    }
+  }
+
+  const int flags =
+      O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
+  direct = false;
+#ifdef O_DIRECT
+  if (direct_requested && !append && !compressor) {
+    fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+    direct = fd >= 0;
+  }
+#endif
+  if (fd < 0) {
+    fd = ::open(filename.c_str(), flags, 0644);
+  }
+  if (fd < 0) {
+    std::cerr << "Error: Could not create output file '" << filename << "'"
+              << std::endl;
+    return false;
+  }
+
+  storage.resize(buffer_size + block_size);
+  const uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+  buffer = storage.data() + (block_size - address % block_size) % block_size;
+  used = 0;
+
+  this->delimiter = delimiter;
+  failed = false;
+  rows_written = 0;
+  bytes_written = 0;
+  return true;
+}
+
+bool CsvWriter::close() {
+  if (fd < 0) {
+    return true;
+  }
+  flush(true);
+  if (::close(fd) != 0) {
+    failed = true;
+  }
+  fd = -1;
+  compressor.reset();
+  std::vector<char>().swap(compressed);
+  return !failed;
+}
+
+bool CsvWriter::is_open() const { return fd >= 0; }
+
+bool CsvWriter::is_direct() const { return direct; }
+
+StreamCompression CsvWriter::get_compression() const { return compression; }
+
+bool CsvWriter::write_header(const std::vector<std::string> &headers) {
+  return write_row(headers);
+}
+
+bool CsvWriter::write_row(const std::vector<std::string> &cells) {
+  if (fd < 0) {
+    return false;
+  }
+  for (size_t i = 0; i < cells.size(); ++i) {
+    if (i > 0) {
+      append(&delimiter, 1);
+    }
+    append_field(cells[i]);
+  }
+  append("\n", 1);
+  return !failed;
+}
+
+bool CsvWriter::write_table(const Table &table) {
+  if (fd < 0) {
+    return false;
+  }
+  const size_t num_columns = table.get_column_count();
+  const size_t num_rows = table.get_row_count();
+
+  std::vector<ColumnWriter> writers(num_columns);
+  for (size_t col = 0; col < num_columns; ++col) {
+    const Column &column = table.get_column(col);
+    ColumnWriter &writer = writers[col];
+    writer.column = &column;
+    writer.type = column.get_type();
+    writer.precision = column.get_precision();
+    writer.has_nulls = column.get_null_count() > 0;
+    if (writer.type == ColumnType::STRING) {
+      writer.fields.reserve(column.get_dictionary().size());
+      for (const auto &entry : column.get_dictionary()) {
+        writer.fields.push_back(needs_quotes(entry) ? escape(entry) : entry);
+      }
+    }
+  }
+
+  for (size_t row = 0; row < num_rows; ++row) {
+    for (size_t col = 0; col < num_columns; ++col) {
+      const ColumnWriter &writer = writers[col];
+      if (col > 0) {
+        *reserve(1) = delimiter;
+        ++used;
+      }
+      if (writer.has_nulls && !writer.column->is_valid(row)) {
+        continue;
+      }
+
+      if (writer.type == ColumnType::STRING) {
+        const std::string &field =
+            writer.fields[writer.column->get_codes()[row]];
+        append(field.data(), field.size());
+        continue;
+      }
+
+      const size_t width =
+          max_number_width + static_cast<size_t>(std::max(writer.precision, 0));
+      char *first = reserve(width);
+      char *last = std::min(first + width, buffer + buffer_size);
+      std::to_chars_result result{first, std::errc()};
+      if (writer.type == ColumnType::INT64) {
+        result = std::to_chars(first, last, writer.column->get_ints()[row]);
+      } else if (writer.precision >= 0) {
+        result = std::to_chars(first, last, writer.column->get_doubles()[row],
+                               std::chars_format::fixed, writer.precision);
+      } else {
+        result = std::to_chars(first, last, writer.column->get_doubles()[row]);
+      }
+      if (result.ec == std::errc()) {
+        used += static_cast<size_t>(result.ptr - first);
+      }
+    }
+    *reserve(1) = '\n';
+    ++used;
+  }
+
+  rows_written += num_rows;
+  return !failed;
+}
+
+size_t CsvWriter::get_rows_written() const { return rows_written; }
+
+size_t CsvWriter::get_bytes_written() const { return bytes_written; }
+
+bool CsvWriter::needs_quotes(std::string_view field) const {
+  for (char c : field) {
+    if (c == delimiter || c == '"' || c == '\n' || c == '\r') {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string CsvWriter::escape(std::string_view field) const {
+  std::string quoted;
+  quoted.reserve(field.size() + 2);
+  quoted.push_back('"');
+  for (char c : field) {
+    if (c == '"') {
+      quoted.push_back('"');
+    }
+    quoted.push_back(c);
+  }
+  quoted.push_back('"');
+  return quoted;
+}
+
+void CsvWriter::append_field(std::string_view field) {
+  if (!needs_quotes(field)) {
+    append(field.data(), field.size());
+    return;
+  }
+  const std::string quoted = escape(field);
+  append(quoted.data(), quoted.size());
+}
+
+void CsvWriter::append(const char *data, size_t size) {
+  if (size <= buffer_size - used) {
+    std::memcpy(buffer + used, data, size);
+    used += size;
+    return;
+  }
+
+  // A large field goes out in the same system call as the buffer instead
+  // of being copied through it
+  if (!direct && !compressor && size >= buffer_size / 2) {
+    write_two(buffer, used, data, size);
+    used = 0;
+    return;
+  }
+
+  while (size > 0) {
+    if (used == buffer_size) {
+      flush(false);
+    }
+    const size_t chunk = std::min(size, buffer_size - used);
+    std::memcpy(buffer + used, data, chunk);
+    used += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+char *CsvWriter::reserve(size_t size) {
+  if (size > buffer_size - used) {
+    flush(false);
+  }
+  return buffer + used;
+}
+
+void CsvWriter::flush(bool final) {
+  if (fd < 0) {
+    return;
+  }
+  if (compressor) {
+    // The final call still runs on an empty buffer to end the stream
+    compressed.clear();
+    if (!compressor->compress(buffer, used, final, compressed)) {
+      failed = true;
+    }
+    write_fully(compressed.data(), compressed.size());
+    used = 0;
+    return;
+  }
+  if (used == 0) {
+    return;
+  }
+
+  size_t size = used;
+  if (direct && !final) {
+    size -= size % block_size;
+  }
+#ifdef O_DIRECT
+  if (direct && size % block_size != 0) {
+    // The unaligned tail of the file cannot be written with O_DIRECT
+    const int flags = ::fcntl(fd, F_GETFL);
+    if (flags >= 0) {
+      ::fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    }
+    direct = false;
+  }
+#endif
+
+  write_fully(buffer, size);
+  std::memmove(buffer, buffer + size, used - size);
+  used -= size;
+}
+
+void CsvWriter::write_fully(const char *data, size_t size) {
+  while (size > 0 && !failed) {
+    const ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+#ifdef O_DIRECT
+      if (errno == EINVAL && direct) {
+        // Opened with O_DIRECT but the file system rejects it on write
+        const int flags = ::fcntl(fd, F_GETFL);
+        if (flags >= 0 && ::fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0) {
+          direct = false;
+          continue;
+        }
+      }
+#endif
+      failed = true;
+      return;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+    bytes_written += static_cast<size_t>(written);
+  }
+}
+
+void CsvWriter::write_two(const char *first, size_t first_size,
+                          const char *second, size_t second_size) {
+  iovec parts[2];
+  parts[0].iov_base = const_cast<char *>(first);
+  parts[0].iov_len = first_size;
+  parts[1].iov_base = const_cast<char *>(second);
+  parts[1].iov_len = second_size;
+
+  ssize_t written;
+  do {
+    written = ::writev(fd, parts, 2);
+  } while (written < 0 && errno == EINTR);
+  if (written < 0) {
+    failed = true;
+    return;
+  }
+
+  // Finish a short write one part at a time
+  size_t done = static_cast<size_t>(written);
+  bytes_written += done;
+  if (done < first_size) {
+    write_fully(first + done, first_size - done);
+    done = first_size;
+  }
+  write_fully(second + (done - first_size),
+              second_size - (done - first_size));
+}
+
+} // namespace adapter
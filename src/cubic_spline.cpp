@@ -0,0 +1,160 @@
+#include "adapter/cubic_spline.hpp"
+#include <algorithm>
+
+namespace adapter {
+
+CubicSpline::CubicSpline() {}
+
+bool CubicSpline::fit(const std::vector<double> &x,
+                      const std::vector<double> &y, SplineBoundary boundary) {
+  if (boundary == SplineBoundary::NATURAL || x.size() < 2) {
+    return solve(x, y, false, 0.0, 0.0);
+  }
+
+  const size_t n = x.size();
+  const double start_slope = (y[1] - y[0]) / (x[1] - x[0]);
+  const double end_slope = (y[n - 1] - y[n - 2]) / (x[n - 1] - x[n - 2]);
+  return solve(x, y, true, start_slope, end_slope);
+}
+
+bool CubicSpline::fit(const std::vector<double> &x,
+                      const std::vector<double> &y, double start_slope,
+                      double end_slope) {
+  return solve(x, y, true, start_slope, end_slope);
+}
+
+void CubicSpline::evaluate(const std::vector<double> &targets,
+                           std::vector<double> &values) const {
+  values.resize(targets.size());
+  if (knots.empty()) {
+    std::fill(values.begin(), values.end(), 0.0);
+    return;
+  }
+
+  // Pass 1: locate each target's segment with a forward-only cursor
+  std::vector<size_t> segments(targets.size());
+  size_t cursor = 0;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    cursor = find_segment(targets[i], cursor);
+    segments[i] = cursor;
+  }
+
+  // Pass 2: evaluate the polynomials; no control flow beyond the clamp
+  const size_t last_knot = knots.size() - 1;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const size_t s = segments[i];
+    const double width = s < last_knot ? knots[s + 1] - knots[s] : 0.0;
+    const double dx = std::min(std::max(targets[i] - knots[s], 0.0), width);
+    values[i] = a[s] + dx * (b[s] + dx * (c[s] + dx * d[s]));
+  }
+}
+
+double CubicSpline::evaluate_at(double t, size_t &cursor) const {
+  if (knots.empty()) {
+    return 0.0;
+  }
+
+  cursor = find_segment(t, cursor);
+  const size_t s = cursor;
+  const double width = s + 1 < knots.size() ? knots[s + 1] - knots[s] : 0.0;
+  const double dx = std::min(std::max(t - knots[s], 0.0), width);
+  return a[s] + dx * (b[s] + dx * (c[s] + dx * d[s]));
+}
+
+size_t CubicSpline::get_knot_count() const { return knots.size(); }
+
+bool CubicSpline::solve(const std::vector<double> &x,
+                        const std::vector<double> &y, bool clamped,
+                        double start_slope, double end_slope) {
+  knots.clear();
+  a.clear();
+  b.clear();
+  c.clear();
+  d.clear();
+
+  const size_t n = x.size();
+  if (n == 0 || y.size() != n) {
+    return false;
+  }
+  for (size_t i = 1; i < n; ++i) {
+    if (!(x[i] > x[i - 1])) {
+      return false;
+    }
+  }
+
+  knots = x;
+  if (n == 1) {
+    a.assign(1, y[0]);
+    b.assign(1, 0.0);
+    c.assign(1, 0.0);
+    d.assign(1, 0.0);
+    return true;
+  }
+
+  std::vector<double> h(n - 1);
+  std::vector<double> secant(n - 1);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    h[i] = x[i + 1] - x[i];
+    secant[i] = (y[i + 1] - y[i]) / h[i];
+  }
+
+  // Tridiagonal system for the second derivatives m[i]:
+  // lower[i] m[i-1] + diag[i] m[i] + upper[i] m[i+1] = rhs[i]
+  std::vector<double> lower(n, 0.0);
+  std::vector<double> diag(n, 1.0);
+  std::vector<double> upper(n, 0.0);
+  std::vector<double> rhs(n, 0.0);
+  for (size_t i = 1; i + 1 < n; ++i) {
+    lower[i] = h[i - 1];
+    diag[i] = 2.0 * (h[i - 1] + h[i]);
+    upper[i] = h[i];
+    rhs[i] = 6.0 * (secant[i] - secant[i - 1]);
+  }
+  if (clamped) {
+    diag[0] = 2.0 * h[0];
+    upper[0] = h[0];
+    rhs[0] = 6.0 * (secant[0] - start_slope);
+    lower[n - 1] = h[n - 2];
+    diag[n - 1] = 2.0 * h[n - 2];
+    rhs[n - 1] = 6.0 * (end_slope - secant[n - 2]);
+  }
+
+  // Thomas algorithm: forward elimination, then back substitution
+  std::vector<double> m(n);
+  upper[0] /= diag[0];
+  rhs[0] /= diag[0];
+  for (size_t i = 1; i < n; ++i) {
+    const double pivot = diag[i] - lower[i] * upper[i - 1];
+    upper[i] /= pivot;
+    rhs[i] = (rhs[i] - lower[i] * rhs[i - 1]) / pivot;
+  }
+  m[n - 1] = rhs[n - 1];
+  for (size_t i = n - 1; i-- > 0;) {
+    m[i] = rhs[i] - upper[i] * m[i + 1];
+  }
+
+  a.resize(n - 1);
+  b.resize(n - 1);
+  c.resize(n - 1);
+  d.resize(n - 1);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    a[i] = y[i];
+    b[i] = secant[i] - h[i] * (2.0 * m[i] + m[i + 1]) / 6.0;
+    c[i] = m[i] / 2.0;
+    d[i] = (m[i + 1] - m[i]) / (6.0 * h[i]);
+  }
+  return true;
+}
+
+size_t CubicSpline::find_segment(double t, size_t cursor) const {
+  const size_t segment_count = a.size();
+  if (cursor >= segment_count || t < knots[cursor]) {
+    cursor = 0;
+  }
+  while (cursor + 1 < segment_count && knots[cursor + 1] <= t) {
+    ++cursor;
+  }
+  return cursor;
+}
+
+} // namespace adapter
@@ -1,14 +1,61 @@
 #include "adapter/data_cleaner.hpp"
+#include "adapter/numeric_kernels.hpp"
+#include "adapter/thread_pool.hpp"
+#include "adapter/value_parser.hpp"
 #include <algorithm>
 #include <cmath>
-#include <iomanip>
-#include <regex>
-#include <sstream>
 
 namespace adapter {
 
-DataCleaner::DataCleaner() : date_format("%Y-%m-%d"), numeric_precision(2) {
-  missing_value_strategies = {"mean"};
+const char *missing_value_strategy_name(MissingValueStrategy strategy) {
+  switch (strategy) {
+  case MissingValueStrategy::MEAN:
+    return "mean";
+  case MissingValueStrategy::MEDIAN:
+    return "median";
+  case MissingValueStrategy::ZERO:
+    return "zero";
+  case MissingValueStrategy::NONE:
+    break;
+  }
+  return "none";
+}
+
+MissingValueStrategy parse_missing_value_strategy(const std::string &name) {
+  if (name.empty() || name == "none") {
+    return MissingValueStrategy::NONE;
+  }
+  if (name == "mean") {
+    return MissingValueStrategy::MEAN;
+  }
+  if (name == "median") {
+    return MissingValueStrategy::MEDIAN;
+  }
+  return MissingValueStrategy::ZERO;
+}
+
+std::vector<MissingValueRule>
+parse_missing_value_rules(const std::vector<std::string> &entries) {
+  std::vector<MissingValueRule> rules;
+  rules.reserve(entries.size());
+  for (const std::string &entry : entries) {
+    MissingValueRule rule;
+    const size_t colon = entry.rfind(':');
+    if (colon == std::string::npos) {
+      rule.strategy = parse_missing_value_strategy(entry);
+    } else {
+      rule.column = entry.substr(0, colon);
+      rule.strategy = parse_missing_value_strategy(entry.substr(colon + 1));
+    }
+    rules.push_back(std::move(rule));
+  }
+  return rules;
+}
+
+DataCleaner::DataCleaner()
+    : date_format("%Y-%m-%d"), numeric_precision(2), dedup_verify(false),
+      thread_count(1), duplicates_removed(0) {
+  missing_value_rules = {{"", MissingValueStrategy::MEAN}};
 }
 
 DataCleaner::~DataCleaner() {}
@@ -29,21 +76,8 @@ void DataCleaner::remove_duplicate_rows(
     return;
   }
 
-  std::set<std::vector<std::string>> unique_rows;
-  std::vector<std::vector<std::string>> cleaned_data;
-
-  // Keep header row
-  cleaned_data.push_back(data[0]);
-
-  // Process data rows
-  for (size_t i = 1; i < data.size(); ++i) {
-    if (unique_rows.find(data[i]) == unique_rows.end()) {
-      unique_rows.insert(data[i]);
-      cleaned_data.push_back(data[i]);
-    }
-  }
-
-  data = std::move(cleaned_data);
+  RowDeduplicator deduplicator = make_deduplicator();
+  deduplicator.deduplicate(data);
 }
 
 void DataCleaner::handle_missing_values(
@@ -54,48 +88,55 @@ void DataCleaner::handle_missing_values(
 
   const size_t num_columns = data[0].size();
 
-  for (size_t col = 0; col < num_columns; ++col) {
-    std::vector<std::string> column_values;
-    std::vector<size_t> missing_indices;
+  for_each_column(num_columns, [&](size_t col) {
+    const MissingValueStrategy strategy =
+        resolve_missing_value_strategy(col, data[0][col]);
+    if (strategy == MissingValueStrategy::NONE) {
+      return;
+    }
 
-    // Collect column values and find missing ones
+    // Each value is parsed once, straight into the statistics
+    ColumnStatsAccumulator accumulator(strategy ==
+                                           MissingValueStrategy::MEDIAN,
+                                       static_cast<size_t>(-1));
+    std::vector<size_t> missing_indices;
     for (size_t row = 1; row < data.size(); ++row) {
       if (col < data[row].size()) {
         const std::string &value = data[row][col];
-        if (value.empty() || value == "NaN" || value == "nan" || 
-            value == "NA" || value == "NULL") {
+        double numeric_value = 0.0;
+        if (is_missing_token(value)) {
           missing_indices.push_back(row);
+        } else if (parse_number(value, numeric_value)) {
+          accumulator.add_value(numeric_value);
         } else {
-          column_values.push_back(value);
+          accumulator.add_text();
         }
       }
     }
 
-    if (missing_indices.empty() || column_values.empty()) {
-      continue;
+    const ColumnStats stats = accumulator.finish();
+    if (missing_indices.empty() || stats.valid_count == 0) {
+      return;
     }
 
-    // Determine replacement value based on strategy
+    // Consider it numeric if at least 80% of values are numeric
+    const bool numeric = stats.numeric_count > 0 &&
+                         static_cast<double>(stats.numeric_count) /
+                                 stats.valid_count >=
+                             0.8;
+
     std::string replacement_value = "0";
-    if (!missing_value_strategies.empty()) {
-      const std::string &strategy = missing_value_strategies[0];
-
-      if (strategy == "mean" && is_numeric_column(column_values)) {
-        replacement_value = calculate_mean(column_values);
-      } else if (strategy == "median" && is_numeric_column(column_values)) {
-        replacement_value = calculate_median(column_values);
-      } else if (strategy == "zero") {
-        replacement_value = "0";
-      }
+    if (strategy == MissingValueStrategy::MEAN && numeric) {
+      replacement_value = format_fixed(stats.mean, numeric_precision);
+    } else if (strategy == MissingValueStrategy::MEDIAN && numeric) {
+      replacement_value = format_fixed(stats.median, numeric_precision);
     }
 
     // Replace missing values
     for (size_t missing_row : missing_indices) {
-      if (col < data[missing_row].size()) {
-        data[missing_row][col] = replacement_value;
-      }
+      data[missing_row][col] = replacement_value;
     }
-  }
+  });
 }
 
 void DataCleaner::normalize_formats(
@@ -106,152 +147,244 @@ void DataCleaner::normalize_formats(
 
   for (size_t row = 1; row < data.size(); ++row) {
     for (size_t col = 0; col < data[row].size(); ++col) {
+      // Dates are kept as written, so only numbers need a look
       std::string &value = data[row][col];
-
-      if (is_numeric(value)) {
-        value = normalize_numeric_format(value);
-      } else if (is_date(value)) {
-        value = normalize_date_format(value);
+      double numeric_value = 0.0;
+      if (parse_number(value, numeric_value)) {
+        value = format_fixed(numeric_value, numeric_precision);
       }
     }
   }
 }
 
-void DataCleaner::set_missing_value_strategies(
-    const std::vector<std::string> &strategies) {
-  missing_value_strategies = strategies;
-}
+void DataCleaner::clean_data(Table &table) {
+  if (table.get_row_count() == 0) {
+    return;
+  }
 
-void DataCleaner::set_date_format(const std::string &format) {
-  date_format = format;
+  remove_duplicate_rows(table);
+  handle_missing_values(table);
+  normalize_formats(table);
 }
 
-void DataCleaner::set_numeric_precision(int precision) {
-  numeric_precision = precision;
+std::string DataCleaner::get_stage_name() const { return "clean"; }
+
+bool DataCleaner::apply(Table &table) {
+  clean_data(table);
+  return true;
 }
 
-bool DataCleaner::is_numeric(const std::string &value) const {
-  if (value.empty()) {
-    return false;
+void DataCleaner::remove_duplicate_rows(Table &table) {
+  duplicates_removed = 0;
+  if (table.get_row_count() <= 1) {
+    return;
   }
 
-  std::regex numeric_pattern(R"(^-?\d*\.?\d+$)");
-  return std::regex_match(value, numeric_pattern);
+  RowDeduplicator deduplicator = make_deduplicator();
+  duplicates_removed = deduplicator.deduplicate(table);
 }
 
-bool DataCleaner::is_date(const std::string &value) const {
-  if (value.empty()) {
-    return false;
-  }
-
-  // Basic date pattern matching
-  std::regex date_pattern(R"(\d{4}-\d{2}-\d{2})");
-  std::regex datetime_pattern(R"(\d{4}-\d{2}-\d{2}[\sT]\d{2}:\d{2}:\d{2})");
+size_t DataCleaner::get_duplicates_removed() const {
+  return duplicates_removed;
+}
 
-  return std::regex_search(value, date_pattern) ||
-         std::regex_search(value, datetime_pattern);
+const std::map<std::string, size_t> &DataCleaner::get_imputed_cells() const {
+  return imputed_cells;
 }
 
-std::string DataCleaner::normalize_date_format(const std::string &value) const {
-  // For simplicity, return the value as-is for now
-  // In a full implementation, this would parse and reformat dates
-  return value;
+const std::vector<ColumnStats> &DataCleaner::get_column_stats() const {
+  return column_stats;
 }
 
-std::string
-DataCleaner::normalize_numeric_format(const std::string &value) const {
-  try {
-    double numeric_value = std::stod(value);
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(numeric_precision) << numeric_value;
-    return oss.str();
-  } catch (const std::exception &) {
-    return value;
-  }
+RowDeduplicator DataCleaner::make_deduplicator() const {
+  RowDeduplicator deduplicator;
+  deduplicator.set_key_columns(dedup_key_columns);
+  deduplicator.set_exact_verify(dedup_verify);
+  return deduplicator;
 }
 
-std::string
-DataCleaner::calculate_mean(const std::vector<std::string> &column) const {
-  if (column.empty()) {
-    return "0";
+void DataCleaner::handle_missing_values(Table &table) {
+  imputed_cells.clear();
+  column_stats.assign(table.get_column_count(), ColumnStats());
+  if (table.get_row_count() == 0) {
+    return;
   }
 
-  double sum = 0.0;
-  size_t count = 0;
+  std::vector<MissingValueFill> fills(table.get_column_count());
 
-  for (const std::string &value : column) {
-    if (is_numeric(value)) {
-      try {
-        sum += std::stod(value);
-        count++;
-      } catch (const std::exception &) {
-        // Skip invalid values
-      }
+  for_each_column(table.get_column_count(), [&](size_t col) {
+    const Column &column = table.get_column(col);
+    const bool has_missing = column.get_null_count() > 0;
+    const bool needs_median =
+        has_missing && resolve_missing_value_strategy(col, column.get_name()) ==
+                           MissingValueStrategy::MEDIAN;
+
+    column_stats[col] = compute_column_stats(column, needs_median);
+    if (has_missing) {
+      fills[col] =
+          make_missing_value_fill(column_stats[col], col, column.get_name());
     }
+  });
+
+  fill_missing_values(table, fills, &imputed_cells);
+}
+
+MissingValueFill
+DataCleaner::make_missing_value_fill(const ColumnStats &stats, size_t column,
+                                     const std::string &column_name) const {
+  MissingValueFill fill;
+
+  // Columns with no values at all are left untouched, as in the row path
+  const MissingValueStrategy strategy =
+      resolve_missing_value_strategy(column, column_name);
+  if (stats.valid_count == 0 || strategy == MissingValueStrategy::NONE) {
+    return fill;
   }
 
-  if (count == 0) {
-    return "0";
+  fill.enabled = true;
+  if (!stats.numeric) {
+    // Matches the row-based path: non-numeric columns fall back to "0"
+    fill.strategy = MissingValueStrategy::ZERO;
+    fill.text_value = "0";
+    return fill;
   }
 
-  double mean = sum / count;
-  std::ostringstream oss;
-  oss << std::fixed << std::setprecision(numeric_precision) << mean;
-  return oss.str();
+  fill.numeric = true;
+  fill.strategy = strategy;
+  if (strategy == MissingValueStrategy::MEAN) {
+    fill.numeric_value = round_to_precision(stats.mean);
+  } else if (strategy == MissingValueStrategy::MEDIAN) {
+    fill.numeric_value = round_to_precision(stats.median);
+  }
+  return fill;
 }
 
-std::string
-DataCleaner::calculate_median(const std::vector<std::string> &column) const {
-  if (column.empty()) {
-    return "0";
+MissingValueStrategy DataCleaner::resolve_missing_value_strategy(
+    size_t column, const std::string &column_name) const {
+  MissingValueStrategy positional = MissingValueStrategy::NONE;
+  size_t position = 0;
+  for (const MissingValueRule &rule : missing_value_rules) {
+    if (rule.column.empty()) {
+      if (position <= column) {
+        positional = rule.strategy;
+      }
+      ++position;
+    } else if (rule.column == column_name) {
+      return rule.strategy;
+    }
   }
+  return positional;
+}
+
+std::string
+DataCleaner::get_missing_value_strategy(size_t column,
+                                        const std::string &column_name) const {
+  return missing_value_strategy_name(
+      resolve_missing_value_strategy(column, column_name));
+}
 
-  std::vector<double> numeric_values;
+size_t DataCleaner::fill_missing_values(
+    Table &table, const std::vector<MissingValueFill> &fills,
+    std::map<std::string, size_t> *imputed) const {
+  const size_t count = std::min(fills.size(), table.get_column_count());
+  std::vector<size_t> filled(count, 0);
+
+  for_each_column(count, [&](size_t col) {
+    const MissingValueFill &fill = fills[col];
+    Column &column = table.get_column(col);
+    if (!fill.enabled || fill.numeric != column.is_numeric() ||
+        column.get_null_count() == 0) {
+      return;
+    }
+    filled[col] = column.get_null_count();
 
-  for (const std::string &value : column) {
-    if (is_numeric(value)) {
-      try {
-        numeric_values.push_back(std::stod(value));
-      } catch (const std::exception &) {
-        // Skip invalid values
-      }
+    if (!fill.numeric) {
+      column.fill_nulls(fill.text_value);
+      return;
     }
-  }
 
-  if (numeric_values.empty()) {
-    return "0";
+    if (column.get_type() == ColumnType::INT64 &&
+        fill.numeric_value != std::floor(fill.numeric_value)) {
+      column.convert_to_double();
+    }
+    column.fill_nulls(fill.numeric_value);
+  });
+
+  size_t total = 0;
+  for (size_t col = 0; col < count; ++col) {
+    total += filled[col];
+    if (imputed != nullptr && filled[col] > 0) {
+      (*imputed)[missing_value_strategy_name(fills[col].strategy)] +=
+          filled[col];
+    }
   }
+  return total;
+}
 
-  std::sort(numeric_values.begin(), numeric_values.end());
+void DataCleaner::normalize_formats(Table &table) {
+  for_each_column(table.get_column_count(), [&](size_t col) {
+    Column &column = table.get_column(col);
+    if (!column.is_numeric()) {
+      return;
+    }
 
-  double median;
-  size_t size = numeric_values.size();
-  if (size % 2 == 0) {
-    median = (numeric_values[size / 2 - 1] + numeric_values[size / 2]) / 2.0;
-  } else {
-    median = numeric_values[size / 2];
-  }
+    // Null slots are rounded too; skipping them would cost a branch per
+    // value and their contents are never read.
+    column.convert_to_double();
+    std::vector<double> &values = column.get_doubles();
+    adapter::round_to_precision(values.data(), values.size(),
+                                numeric_precision);
+    column.set_precision(numeric_precision);
+  });
+}
 
-  std::ostringstream oss;
-  oss << std::fixed << std::setprecision(numeric_precision) << median;
-  return oss.str();
+void DataCleaner::set_missing_value_strategies(
+    const std::vector<std::string> &strategies) {
+  missing_value_rules = parse_missing_value_rules(strategies);
 }
 
-bool DataCleaner::is_numeric_column(
-    const std::vector<std::string> &column) const {
-  if (column.empty()) {
-    return false;
-  }
+void DataCleaner::set_missing_value_rules(
+    const std::vector<MissingValueRule> &rules) {
+  missing_value_rules = rules;
+}
 
-  size_t numeric_count = 0;
-  for (const std::string &value : column) {
-    if (is_numeric(value)) {
-      numeric_count++;
+void DataCleaner::set_date_format(const std::string &format) {
+  date_format = format;
+}
+
+void DataCleaner::set_numeric_precision(int precision) {
+  numeric_precision = precision;
+}
+
+void DataCleaner::set_dedup_key_columns(
+    const std::vector<std::string> &columns) {
+  dedup_key_columns = columns;
+}
+
+void DataCleaner::set_dedup_verify(bool verify) { dedup_verify = verify; }
+
+void DataCleaner::set_thread_count(size_t count) {
+  thread_count = count == 0 ? 1 : count;
+}
+
+size_t DataCleaner::get_thread_count() const { return thread_count; }
+
+void DataCleaner::for_each_column(
+    size_t column_count, const std::function<void(size_t)> &body) const {
+  if (thread_count <= 1 || column_count <= 1) {
+    for (size_t col = 0; col < column_count; ++col) {
+      body(col);
     }
+    return;
   }
 
-  // Consider it numeric if at least 80% of values are numeric
-  return static_cast<double>(numeric_count) / column.size() >= 0.8;
+  ThreadPool pool(std::min(thread_count, column_count));
+  pool.parallel_for(column_count, body);
+}
+
+double DataCleaner::round_to_precision(double value) const {
+  const double scale = std::pow(10.0, numeric_precision);
+  return std::round(value * scale) / scale;
 }
 
 } // namespace adapter
@@ -0,0 +1,383 @@
+#include "adapter/incremental_pipeline.hpp"
+#include "adapter/csv_parser.hpp"
+#include "adapter/csv_writer.hpp"
+#include "adapter/value_parser.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace adapter {
+
+namespace {
+
+bool file_size(const std::string &path, uint64_t &size) {
+  struct stat info;
+  if (::stat(path.c_str(), &info) != 0) {
+    return false;
+  }
+  size = static_cast<uint64_t>(info.st_size);
+  return true;
+}
+
+// Appends later's rows to earlier, column by column. Both hold the same
+// columns; a column imputed with a fractional mean in only one of them is
+// widened to FLOAT64.
+Table append_table(Table earlier, const Table &later) {
+  Table combined;
+  for (size_t col = 0; col < earlier.get_column_count(); ++col) {
+    Column column = std::move(earlier.get_column(col));
+    const Column &rows = later.get_column(col);
+    if (column.get_type() == ColumnType::INT64 &&
+        rows.get_type() == ColumnType::FLOAT64) {
+      column.convert_to_double();
+    }
+
+    column.reserve(column.size() + rows.size());
+    for (size_t row = 0; row < rows.size(); ++row) {
+      if (!rows.is_valid(row)) {
+        column.append_null();
+        continue;
+      }
+      switch (column.get_type()) {
+      case ColumnType::INT64:
+        column.append_int(rows.get_int(row));
+        break;
+      case ColumnType::FLOAT64:
+        column.append_double(rows.get_double(row));
+        break;
+      case ColumnType::STRING:
+        column.append_string(rows.to_string(row));
+        break;
+      }
+    }
+    combined.add_column(std::move(column));
+  }
+  return combined;
+}
+
+// Parsed time of every row, and whether it parsed.
+void parse_row_times(const Column &column, std::vector<double> &times,
+                     std::vector<char> &parsed) {
+  times.assign(column.size(), 0.0);
+  parsed.assign(column.size(), 0);
+  for (size_t row = 0; row < column.size(); ++row) {
+    if (!column.is_valid(row)) {
+      continue;
+    }
+    if (column.is_numeric()) {
+      times[row] = column.get_double(row);
+      parsed[row] = 1;
+    } else {
+      parsed[row] = parse_timestamp(column.get_string(row), times[row]);
+    }
+  }
+}
+
+} // namespace
+
+IncrementalPipeline::IncrementalPipeline()
+    : delimiter(','), thread_count(1), direct_io(false), resumed(false),
+      rows_read(0), rows_written(0), malformed_count(0),
+      duplicates_removed(0), bytes_read(0), bytes_written(0) {}
+
+void IncrementalPipeline::set_delimiter(char delimiter) {
+  this->delimiter = delimiter;
+}
+
+void IncrementalPipeline::set_projection(
+    const std::vector<std::string> &columns) {
+  projection = columns;
+}
+
+void IncrementalPipeline::set_inference(const InferenceOptions &options) {
+  inference = options;
+}
+
+void IncrementalPipeline::set_thread_count(size_t count) {
+  thread_count = count == 0 ? 1 : count;
+}
+
+void IncrementalPipeline::set_direct_io(bool enabled) { direct_io = enabled; }
+
+bool IncrementalPipeline::run(const std::string &input_file,
+                              const std::string &output_file,
+                              const std::string &state_file,
+                              DataCleaner &cleaner, TimeAligner *aligner) {
+  rows_read = 0;
+  rows_written = 0;
+  malformed_count = 0;
+  duplicates_removed = 0;
+  bytes_read = 0;
+  bytes_written = 0;
+  imputed_cells.clear();
+
+  IncrementalState state;
+  resumed = load_state(input_file, output_file, state_file, state);
+
+  Table table;
+  size_t end_offset = 0;
+  if (!parse(input_file, state, table, end_offset)) {
+    return false;
+  }
+  rows_read = table.get_row_count();
+
+  clean(table, cleaner, state);
+  const bool aligned = aligner != nullptr && table.get_row_count() > 0;
+  if (aligned && !align(table, *aligner, state)) {
+    return false;
+  }
+
+  // An aligned header is only known once there are rows to align
+  const bool write_header =
+      state.output_size == 0 && (aligner == nullptr || aligned);
+  CsvWriter writer;
+  writer.set_direct_io(direct_io);
+  if (!writer.open(output_file, delimiter, resumed) ||
+      (write_header && !writer.write_header(table.get_headers())) ||
+      !writer.write_table(table) || !writer.close()) {
+    std::cerr << "Error: Failed to write output file" << std::endl;
+    return false;
+  }
+  rows_written = writer.get_rows_written();
+  bytes_written = writer.get_bytes_written();
+
+  state.source_offset = end_offset;
+  state.delimiter = delimiter;
+  if (!hash_incremental_source(input_file, state.source_offset,
+                               state.source_hash) ||
+      !file_size(output_file, state.output_size) ||
+      !write_incremental_state(state, state_file)) {
+    std::cerr << "Error: Could not write state file " << state_file
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool IncrementalPipeline::was_resumed() const { return resumed; }
+
+size_t IncrementalPipeline::get_rows_read() const { return rows_read; }
+
+size_t IncrementalPipeline::get_rows_written() const { return rows_written; }
+
+size_t IncrementalPipeline::get_malformed_count() const {
+  return malformed_count;
+}
+
+size_t IncrementalPipeline::get_duplicates_removed() const {
+  return duplicates_removed;
+}
+
+const std::map<std::string, size_t> &
+IncrementalPipeline::get_imputed_cells() const {
+  return imputed_cells;
+}
+
+size_t IncrementalPipeline::get_bytes_read() const { return bytes_read; }
+
+size_t IncrementalPipeline::get_bytes_written() const { return bytes_written; }
+
+bool IncrementalPipeline::load_state(const std::string &input_file,
+                                     const std::string &output_file,
+                                     const std::string &state_file,
+                                     IncrementalState &state) const {
+  if (!read_incremental_state(state_file, state)) {
+    std::cout << "No usable state in " << state_file
+              << ", processing from the start" << std::endl;
+    return false;
+  }
+
+  uint64_t hash = 0;
+  uint64_t output_size = 0;
+  if (state.delimiter != delimiter ||
+      !hash_incremental_source(input_file, state.source_offset, hash) ||
+      hash != state.source_hash) {
+    std::cerr << "Warning: " << input_file
+              << " no longer matches the state, processing from the start"
+              << std::endl;
+  } else if (!file_size(output_file, output_size) ||
+             output_size != state.output_size) {
+    std::cerr << "Warning: " << output_file
+              << " changed since the last run, processing from the start"
+              << std::endl;
+  } else {
+    std::cout << "Resuming at byte " << state.source_offset << std::endl;
+    return true;
+  }
+  state = IncrementalState();
+  return false;
+}
+
+bool IncrementalPipeline::parse(const std::string &input_file,
+                                IncrementalState &state, Table &table,
+                                size_t &end_offset) {
+  CsvParser parser;
+  parser.set_delimiter(delimiter);
+  parser.set_thread_count(thread_count);
+  parser.set_projection(projection);
+  parser.set_start_offset(static_cast<size_t>(state.source_offset));
+  parser.set_schema(state.schema);
+  parser.set_inference(inference);
+  if (!parser.load_file(input_file)) {
+    std::cerr << "Error: Failed to load CSV file" << std::endl;
+    return false;
+  }
+
+  if (resumed && parser.get_headers() != state.headers) {
+    std::cerr << "Warning: Columns differ from the last run, processing "
+                 "from the start"
+              << std::endl;
+    state = IncrementalState();
+    resumed = false;
+    return parse(input_file, state, table, end_offset);
+  }
+
+  malformed_count = parser.get_malformed_count();
+  bytes_read = parser.get_bytes_read();
+  end_offset = parser.get_end_offset();
+  table = parser.take_table();
+
+  // Types are fixed by the first run that saw rows, so fingerprints and
+  // output formatting stay consistent from run to run
+  state.headers = parser.get_headers();
+  if (state.schema.empty() && table.get_row_count() > 0) {
+    for (size_t col = 0; col < table.get_column_count(); ++col) {
+      const Column &column = table.get_column(col);
+      ColumnSchema schema;
+      schema.type = column.get_type();
+      schema.precision = column.get_precision();
+      state.schema.push_back(schema);
+    }
+  }
+  return true;
+}
+
+void IncrementalPipeline::clean(Table &table, DataCleaner &cleaner,
+                                IncrementalState &state) {
+  if (table.get_row_count() == 0) {
+    return;
+  }
+
+  RowDeduplicator deduplicator = cleaner.make_deduplicator();
+  deduplicator.add_fingerprints(state.fingerprints);
+  duplicates_removed = deduplicator.deduplicate(table);
+  state.fingerprints = deduplicator.get_fingerprints();
+
+  const size_t column_count = table.get_column_count();
+  if (state.stats.size() != column_count) {
+    state.stats.assign(column_count, ColumnStats());
+  }
+  std::vector<MissingValueFill> fills(column_count);
+  for (size_t col = 0; col < column_count; ++col) {
+    const Column &column = table.get_column(col);
+    const bool has_missing = column.get_null_count() > 0;
+    const bool needs_median =
+        has_missing &&
+        cleaner.resolve_missing_value_strategy(col, column.get_name()) ==
+            MissingValueStrategy::MEDIAN;
+
+    state.stats[col] = merge_column_stats(
+        state.stats[col], compute_column_stats(column, needs_median));
+    if (has_missing) {
+      fills[col] = cleaner.make_missing_value_fill(state.stats[col], col,
+                                                   column.get_name());
+    }
+  }
+  cleaner.fill_missing_values(table, fills, &imputed_cells);
+  cleaner.normalize_formats(table);
+}
+
+bool IncrementalPipeline::align(Table &table, TimeAligner &aligner,
+                                IncrementalState &state) {
+  if (state.tail.get_row_count() > 0 &&
+      state.tail.get_headers() == table.get_headers()) {
+    table = append_table(std::move(state.tail), table);
+  }
+  state.tail.clear();
+
+  // The aligner replaces the table, and the new tail is picked from the
+  // samples it was given
+  Table samples = table;
+  if (state.has_grid) {
+    aligner.set_grid_origin(state.grid_time);
+  }
+  if (!aligner.apply(table)) {
+    return false;
+  }
+
+  // The origin was written last time, and an aggregation's last bucket
+  // stays open until a later sample arrives
+  const std::vector<double> &grid = aligner.get_grid_times();
+  const size_t first = state.has_grid && !grid.empty() ? 1 : 0;
+  size_t last = grid.size();
+  if (aligner.get_aggregation() != ResampleAggregation::NONE &&
+      last > first) {
+    --last;
+  }
+
+  // Integral columns are the ones the aligner added; each continues from
+  // its value at the origin
+  for (size_t col = 0; col < table.get_column_count(); ++col) {
+    Column &column = table.get_column(col);
+    if (samples.find_column(column.get_name()) != Table::npos ||
+        column.get_type() != ColumnType::FLOAT64) {
+      continue;
+    }
+    double offset = 0.0;
+    for (const auto &integral : state.integrals) {
+      if (state.has_grid && integral.first == column.get_name()) {
+        offset = integral.second;
+      }
+    }
+    for (double &value : column.get_doubles()) {
+      value += offset;
+    }
+  }
+
+  std::vector<size_t> kept;
+  for (size_t row = first; row < last; ++row) {
+    kept.push_back(row);
+  }
+  if (last > first) {
+    state.has_grid = true;
+    state.grid_time = grid[last - 1];
+    state.integrals.clear();
+    for (size_t col = 0; col < table.get_column_count(); ++col) {
+      const Column &column = table.get_column(col);
+      if (samples.find_column(column.get_name()) == Table::npos &&
+          column.get_type() == ColumnType::FLOAT64) {
+        state.integrals.push_back(
+            {column.get_name(), column.get_doubles()[last - 1]});
+      }
+    }
+  }
+  table.keep_rows(kept);
+
+  // Grid points after grid_time are bracketed by the last sample at or
+  // before it and everything later
+  const size_t time_index =
+      samples.find_column(aligner.get_alignment_time_column());
+  std::vector<double> times;
+  std::vector<char> parsed;
+  parse_row_times(samples.get_column(time_index), times, parsed);
+  bool has_floor = false;
+  double floor = 0.0;
+  for (size_t row = 0; row < times.size(); ++row) {
+    if (parsed[row] && state.has_grid && times[row] <= state.grid_time &&
+        (!has_floor || times[row] > floor)) {
+      floor = times[row];
+      has_floor = true;
+    }
+  }
+  std::vector<size_t> tail_rows;
+  for (size_t row = 0; row < times.size(); ++row) {
+    if (parsed[row] && (!has_floor || times[row] >= floor)) {
+      tail_rows.push_back(row);
+    }
+  }
+  samples.keep_rows(tail_rows);
+  state.tail = std::move(samples);
+  return true;
+}
+
+} // namespace adapter
@@ -0,0 +1,362 @@
+#include "adapter/incremental_state.hpp"
+#include "adapter/mapped_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace adapter {
+
+namespace {
+
+const char state_magic[8] = {'A', 'D', 'P', 'T', 'S', 'T', 'A', 'T'};
+constexpr uint32_t state_version = 1;
+
+inline uint64_t mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+uint64_t hash_bytes(const char *data, size_t size, uint64_t hash) {
+  for (size_t i = 0; i < size; i += 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, data + i, std::min<size_t>(8, size - i));
+    hash = mix(hash ^ word) + 0x9e3779b97f4a7c15ULL;
+  }
+  return hash;
+}
+
+// Appends fixed-width values in host byte order.
+class StateEncoder {
+public:
+  template <typename T> void put(const T &value) {
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+  }
+  void put_string(const std::string &value) {
+    put(static_cast<uint64_t>(value.size()));
+    data.insert(data.end(), value.begin(), value.end());
+  }
+  const std::string &contents() const { return data; }
+
+private:
+  std::string data;
+};
+
+// Reads what StateEncoder wrote; every read fails once the data runs out.
+class StateDecoder {
+public:
+  explicit StateDecoder(const std::string &data) : data(data), offset(0) {}
+
+  template <typename T> bool get(T &value) {
+    if (data.size() - offset < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+  }
+  bool get_string(std::string &value) {
+    uint64_t size = 0;
+    if (!get(size) || data.size() - offset < size) {
+      return false;
+    }
+    value.assign(data, offset, size);
+    offset += size;
+    return true;
+  }
+  // Whether count items of at least item_size bytes can still follow
+  bool has_room(uint64_t count, size_t item_size) const {
+    return count <= (data.size() - offset) / item_size;
+  }
+  bool at_end() const { return offset == data.size(); }
+
+private:
+  const std::string &data;
+  size_t offset;
+};
+
+void encode_stats(StateEncoder &encoder, const ColumnStats &stats) {
+  encoder.put(static_cast<uint8_t>(stats.numeric));
+  encoder.put(static_cast<uint64_t>(stats.valid_count));
+  encoder.put(static_cast<uint64_t>(stats.null_count));
+  encoder.put(static_cast<uint64_t>(stats.numeric_count));
+  encoder.put(stats.sum);
+  encoder.put(stats.min);
+  encoder.put(stats.max);
+  encoder.put(stats.mean);
+  encoder.put(stats.variance);
+}
+
+bool decode_stats(StateDecoder &decoder, ColumnStats &stats) {
+  uint8_t numeric = 0;
+  uint64_t valid_count = 0;
+  uint64_t null_count = 0;
+  uint64_t numeric_count = 0;
+  if (!decoder.get(numeric) || !decoder.get(valid_count) ||
+      !decoder.get(null_count) || !decoder.get(numeric_count) ||
+      !decoder.get(stats.sum) || !decoder.get(stats.min) ||
+      !decoder.get(stats.max) || !decoder.get(stats.mean) ||
+      !decoder.get(stats.variance)) {
+    return false;
+  }
+  stats.numeric = numeric != 0;
+  stats.valid_count = static_cast<size_t>(valid_count);
+  stats.null_count = static_cast<size_t>(null_count);
+  stats.numeric_count = static_cast<size_t>(numeric_count);
+  return true;
+}
+
+// The tail is a handful of rows, so it is stored cell by cell
+void encode_table(StateEncoder &encoder, const Table &table) {
+  encoder.put(static_cast<uint32_t>(table.get_column_count()));
+  encoder.put(static_cast<uint64_t>(table.get_row_count()));
+  for (size_t col = 0; col < table.get_column_count(); ++col) {
+    const Column &column = table.get_column(col);
+    encoder.put_string(column.get_name());
+    encoder.put(static_cast<uint32_t>(column.get_type()));
+    encoder.put(static_cast<int32_t>(column.get_precision()));
+    for (size_t row = 0; row < column.size(); ++row) {
+      const bool valid = column.is_valid(row);
+      encoder.put(static_cast<uint8_t>(valid));
+      if (!valid) {
+        continue;
+      }
+      switch (column.get_type()) {
+      case ColumnType::INT64:
+        encoder.put(column.get_ints()[row]);
+        break;
+      case ColumnType::FLOAT64:
+        encoder.put(column.get_doubles()[row]);
+        break;
+      case ColumnType::STRING:
+        encoder.put_string(column.get_string(row));
+        break;
+      }
+    }
+  }
+}
+
+bool decode_table(StateDecoder &decoder, Table &table) {
+  uint32_t column_count = 0;
+  uint64_t row_count = 0;
+  // Every cell takes at least its validity byte
+  if (!decoder.get(column_count) || !decoder.get(row_count) ||
+      (column_count > 0 && !decoder.has_room(row_count, column_count))) {
+    return false;
+  }
+
+  for (uint32_t col = 0; col < column_count; ++col) {
+    std::string name;
+    uint32_t type = 0;
+    int32_t precision = -1;
+    if (!decoder.get_string(name) || !decoder.get(type) ||
+        !decoder.get(precision) ||
+        type > static_cast<uint32_t>(ColumnType::STRING)) {
+      return false;
+    }
+
+    Column column(name, static_cast<ColumnType>(type));
+    column.set_precision(precision);
+    column.reserve(static_cast<size_t>(row_count));
+    for (uint64_t row = 0; row < row_count; ++row) {
+      uint8_t valid = 0;
+      if (!decoder.get(valid)) {
+        return false;
+      }
+      if (!valid) {
+        column.append_null();
+        continue;
+      }
+      switch (column.get_type()) {
+      case ColumnType::INT64: {
+        int64_t value = 0;
+        if (!decoder.get(value)) {
+          return false;
+        }
+        column.append_int(value);
+        break;
+      }
+      case ColumnType::FLOAT64: {
+        double value = 0.0;
+        if (!decoder.get(value)) {
+          return false;
+        }
+        column.append_double(value);
+        break;
+      }
+      case ColumnType::STRING: {
+        std::string value;
+        if (!decoder.get_string(value)) {
+          return false;
+        }
+        column.append_string(value);
+        break;
+      }
+      }
+    }
+    if (!table.add_column(std::move(column))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool decode_state(StateDecoder &decoder, IncrementalState &state) {
+  char magic[sizeof(state_magic)];
+  uint32_t version = 0;
+  if (!decoder.get(magic) ||
+      std::memcmp(magic, state_magic, sizeof(magic)) != 0 ||
+      !decoder.get(version) || version != state_version) {
+    return false;
+  }
+
+  uint64_t column_count = 0;
+  if (!decoder.get(state.source_offset) || !decoder.get(state.source_hash) ||
+      !decoder.get(state.delimiter) || !decoder.get(state.output_size) ||
+      !decoder.get(column_count) || !decoder.has_room(column_count, 8)) {
+    return false;
+  }
+  state.headers.resize(static_cast<size_t>(column_count));
+  state.schema.resize(static_cast<size_t>(column_count));
+  state.stats.resize(static_cast<size_t>(column_count));
+  for (size_t col = 0; col < column_count; ++col) {
+    uint32_t type = 0;
+    int32_t precision = -1;
+    if (!decoder.get_string(state.headers[col]) || !decoder.get(type) ||
+        !decoder.get(precision) ||
+        type > static_cast<uint32_t>(ColumnType::STRING) ||
+        !decode_stats(decoder, state.stats[col])) {
+      return false;
+    }
+    state.schema[col].type = static_cast<ColumnType>(type);
+    state.schema[col].precision = precision;
+  }
+
+  uint64_t fingerprint_count = 0;
+  if (!decoder.get(fingerprint_count) ||
+      !decoder.has_room(fingerprint_count, sizeof(RowFingerprint))) {
+    return false;
+  }
+  state.fingerprints.resize(static_cast<size_t>(fingerprint_count));
+  for (auto &fingerprint : state.fingerprints) {
+    if (!decoder.get(fingerprint.low) || !decoder.get(fingerprint.high)) {
+      return false;
+    }
+  }
+
+  uint8_t has_grid = 0;
+  uint64_t integral_count = 0;
+  if (!decoder.get(has_grid) || !decoder.get(state.grid_time) ||
+      !decoder.get(integral_count) || !decoder.has_room(integral_count, 16)) {
+    return false;
+  }
+  state.has_grid = has_grid != 0;
+  state.integrals.resize(static_cast<size_t>(integral_count));
+  for (auto &integral : state.integrals) {
+    if (!decoder.get_string(integral.first) ||
+        !decoder.get(integral.second)) {
+      return false;
+    }
+  }
+  return decode_table(decoder, state.tail) && decoder.at_end();
+}
+
+} // namespace
+
+bool hash_incremental_source(const std::string &csv_file, uint64_t offset,
+                             uint64_t &hash) {
+  MappedFile file;
+  // Offsets count decoded bytes, as the parser sees them
+  if (!file.open_decompressed(csv_file) || file.size() < offset) {
+    return false;
+  }
+
+  const size_t end = static_cast<size_t>(offset);
+  const size_t head = std::min(end, incremental_check_bytes);
+  const size_t tail_begin = end - std::min(end, incremental_check_bytes);
+  hash = hash_bytes(file.data(), head, mix(offset));
+  hash = hash_bytes(file.data() + tail_begin, end - tail_begin, hash);
+  return true;
+}
+
+bool write_incremental_state(const IncrementalState &state,
+                             const std::string &path) {
+  StateEncoder encoder;
+  for (char c : state_magic) {
+    encoder.put(c);
+  }
+  encoder.put(state_version);
+  encoder.put(state.source_offset);
+  encoder.put(state.source_hash);
+  encoder.put(state.delimiter);
+  encoder.put(state.output_size);
+
+  encoder.put(static_cast<uint64_t>(state.headers.size()));
+  for (size_t col = 0; col < state.headers.size(); ++col) {
+    const ColumnSchema schema =
+        col < state.schema.size() ? state.schema[col] : ColumnSchema();
+    encoder.put_string(state.headers[col]);
+    encoder.put(static_cast<uint32_t>(schema.type));
+    encoder.put(static_cast<int32_t>(schema.precision));
+    encode_stats(encoder, col < state.stats.size() ? state.stats[col]
+                                                   : ColumnStats());
+  }
+
+  encoder.put(static_cast<uint64_t>(state.fingerprints.size()));
+  for (const auto &fingerprint : state.fingerprints) {
+    encoder.put(fingerprint.low);
+    encoder.put(fingerprint.high);
+  }
+
+  encoder.put(static_cast<uint8_t>(state.has_grid));
+  encoder.put(state.grid_time);
+  encoder.put(static_cast<uint64_t>(state.integrals.size()));
+  for (const auto &integral : state.integrals) {
+    encoder.put_string(integral.first);
+    encoder.put(integral.second);
+  }
+  encode_table(encoder, state.tail);
+
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(encoder.contents().data(),
+               static_cast<std::streamsize>(encoder.contents().size()));
+    if (!file.good()) {
+      file.close();
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool read_incremental_state(const std::string &path, IncrementalState &state) {
+  state = IncrementalState();
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+  StateDecoder decoder(data);
+  if (!decode_state(decoder, state)) {
+    state = IncrementalState();
+    return false;
+  }
+  return true;
+}
+
+} // namespace adapter
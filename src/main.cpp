@@ -1,39 +1,91 @@
+#include "adapter/arrow_writer.hpp"
+#include "adapter/batch_runner.hpp"
 #include "adapter/config_manager.hpp"
 #include "adapter/csv_parser.hpp"
+#include "adapter/csv_writer.hpp"
 #include "adapter/data_cleaner.hpp"
+#include "adapter/incremental_pipeline.hpp"
+#include "adapter/merge_aligner.hpp"
+#include "adapter/metrics.hpp"
+#include "adapter/pipeline_spec.hpp"
+#include "adapter/stream_pipeline.hpp"
+#include "adapter/table.hpp"
+#include "adapter/table_stage.hpp"
 #include "adapter/time_aligner.hpp"
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace adapter {
 
+namespace {
+
+// Takes the pipeline's progress messages while batch jobs run, so only
+// their result lines reach the console.
+class DiscardBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return traits_type::not_eof(c); }
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    return count;
+  }
+};
+
+} // namespace
+
 class AdapterApplication {
 private:
   ConfigManager config;
   std::string input_file;
+  std::vector<std::string> input_files;
   std::string output_file;
   std::string time_column;
   std::vector<std::string> dependent_variables;
   std::vector<std::string> independent_variables;
+  PipelineSpec spec;
+  bool stream_mode;
+  bool merge_mode;
+  // Manifest of batch jobs ("-" reads them from stdin), or a Unix socket
+  // to serve them on
+  std::string batch_manifest;
+  std::string listen_socket;
+  size_t batch_size;
+  bool profile;
+  MetricsFormat profile_format;
+  std::string profile_file;
+  Metrics metrics;
 
   void print_usage() const;
   bool parse_arguments(int argc, char *argv[]);
-  bool
-  write_output_csv(const std::vector<std::string> &headers,
-                   const std::vector<std::vector<std::string>> &data) const;
+  // Applies the stage to the table and returns its metrics index.
+  size_t run_stage(TableStage &stage, Table &table);
+  bool write_output_csv(const Table &table, StageMetrics &stage) const;
+  bool write_output_arrow(const Table &table, StageMetrics &stage) const;
+  int run_streaming();
+  int run_merge();
+  int run_incremental();
+  int run_batch();
+  bool report_profile() const;
 
 public:
   AdapterApplication();
   int run(int argc, char *argv[]);
 };
 
-AdapterApplication::AdapterApplication() {}
+AdapterApplication::AdapterApplication()
+    : stream_mode(false), merge_mode(false),
+      batch_size(StreamingPipeline::default_batch_size),
+      profile(false),
+      profile_format(MetricsFormat::TABLE) {}
 
 void AdapterApplication::print_usage() const {
   std::cout << "Usage: adapter [options] <input_file>" << std::endl;
+  std::cout << "       adapter --merge [options] <input_file>..." << std::endl;
+  std::cout << "       adapter --batch <manifest> [options]" << std::endl;
+  std::cout << "       adapter --listen <socket> [options]" << std::endl;
   std::cout << std::endl;
   std::cout << "Required arguments:" << std::endl;
   std::cout << "  input_file              Path to input CSV file" << std::endl;
@@ -54,6 +106,41 @@ void AdapterApplication::print_usage() const {
   std::cout
       << "  --delimiter <char>      CSV delimiter character (default: comma)"
       << std::endl;
+  std::cout << "  -j, --threads <n>       Worker threads for parsing, "
+               "cleaning and alignment (default: 1, 0 = all cores)"
+            << std::endl;
+  std::cout << "  --stream                Clean and write in bounded-memory "
+               "batches (no alignment)"
+            << std::endl;
+  std::cout << "  --merge                 Align several time-sorted files onto "
+               "one grid in a single streaming pass"
+            << std::endl;
+  std::cout << "  --batch-size <rows>     Rows per batch in stream mode "
+               "(default: 65536)"
+            << std::endl;
+  std::cout << "  --snapshot <file>       Reuse a binary snapshot of the parsed "
+               "input while it is unchanged"
+            << std::endl;
+  std::cout << "  --project               Parse only the time, dependent, "
+               "independent and key columns"
+            << std::endl;
+  std::cout << "  --incremental <file>    Process only rows appended since the "
+               "last run, keeping state in <file>"
+            << std::endl;
+  std::cout << "  --batch <manifest>      Run one job per manifest line "
+               "(\"input [output]\"), - reads stdin"
+            << std::endl;
+  std::cout << "  --listen <socket>       Serve batch jobs on a Unix domain "
+               "socket until a \"shutdown\" line"
+            << std::endl;
+  std::cout << "  --format <name>         Output format: csv (default) or "
+               "arrow (Arrow IPC / Feather v2)"
+            << std::endl;
+  std::cout << "  --profile[=<format>]    Report per-stage timings and counters "
+               "(table, json, prometheus)"
+            << std::endl;
+  std::cout << "  --profile-file <file>   Write the profile report to a file"
+            << std::endl;
   std::cout << "  -h, --help              Show this help message" << std::endl;
   std::cout << std::endl;
   std::cout << "Examples:" << std::endl;
@@ -107,33 +194,84 @@ bool AdapterApplication::parse_arguments(int argc, char *argv[]) {
       if (!delim_str.empty()) {
         config.set_delimiter(delim_str[0]);
       }
+    } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+      try {
+        long count = std::stol(argv[++i]);
+        config.set_thread_count(count > 0 ? static_cast<size_t>(count) : 0);
+      } catch (const std::exception &) {
+        std::cerr << "Error: Invalid thread count '" << argv[i] << "'"
+                  << std::endl;
+        return false;
+      }
+    } else if (arg == "--stream") {
+      stream_mode = true;
+    } else if (arg == "--merge") {
+      merge_mode = true;
+    } else if (arg == "--batch-size" && i + 1 < argc) {
+      try {
+        long rows = std::stol(argv[++i]);
+        if (rows <= 0) {
+          throw std::invalid_argument("batch size");
+        }
+        batch_size = static_cast<size_t>(rows);
+      } catch (const std::exception &) {
+        std::cerr << "Error: Invalid batch size '" << argv[i] << "'"
+                  << std::endl;
+        return false;
+      }
+    } else if (arg == "--snapshot" && i + 1 < argc) {
+      config.set_snapshot_file(argv[++i]);
+    } else if (arg == "--project") {
+      config.set_project_columns(true);
+    } else if (arg == "--batch" && i + 1 < argc) {
+      batch_manifest = argv[++i];
+    } else if (arg == "--listen" && i + 1 < argc) {
+      listen_socket = argv[++i];
+    } else if (arg == "--incremental" && i + 1 < argc) {
+      config.set_state_file(argv[++i]);
+    } else if (arg == "--format" && i + 1 < argc) {
+      config.set_output_format(argv[++i]);
+    } else if (arg == "--profile" || arg.rfind("--profile=", 0) == 0) {
+      profile = true;
+      if (arg.size() > 10 &&
+          !Metrics::parse_format(arg.substr(10), profile_format)) {
+        std::cerr << "Error: Unknown profile format '" << arg.substr(10)
+                  << "'" << std::endl;
+        return false;
+      }
+    } else if (arg == "--profile-file" && i + 1 < argc) {
+      profile = true;
+      profile_file = argv[++i];
     } else if (arg[0] != '-') {
-      input_file = arg;
+      input_files.push_back(arg);
     } else {
       std::cerr << "Unknown option: " << arg << std::endl;
       return false;
     }
   }
 
-  if (input_file.empty()) {
+  const bool batch_mode = !batch_manifest.empty() || !listen_socket.empty();
+  if (batch_mode) {
+    if (!input_files.empty() || !output_file.empty()) {
+      std::cerr << "Error: Batch jobs name their files in the manifest"
+                << std::endl;
+      return false;
+    }
+  } else if (input_files.empty()) {
     std::cerr << "Error: No input file specified" << std::endl;
     return false;
   }
+  if (input_files.size() > 1 && !merge_mode) {
+    std::cerr << "Error: Several input files need --merge" << std::endl;
+    return false;
+  }
+  if (!input_files.empty()) {
+    input_file = input_files.front();
+  }
 
   // Set input file in config
   config.set_input_file(input_file);
 
-  if (output_file.empty()) {
-    size_t dot_pos = input_file.find_last_of('.');
-    if (dot_pos != std::string::npos) {
-      output_file = input_file.substr(0, dot_pos) + "_cleaned.csv";
-    } else {
-      output_file = input_file + "_cleaned.csv";
-    }
-  }
-
-  config.set_output_file(output_file);
-
   if (!time_column.empty()) {
     config.set_time_column(time_column);
   }
@@ -146,41 +284,292 @@ bool AdapterApplication::parse_arguments(int argc, char *argv[]) {
     config.set_independent_variables(independent_variables);
   }
 
+  if (!resolve_pipeline_spec(config, spec)) {
+    return false;
+  }
+
+  if (output_file.empty() && !batch_mode) {
+    output_file = default_output_file(input_file, spec.output_format);
+  }
+
+  config.set_output_file(output_file);
+
   return true;
 }
 
-bool AdapterApplication::write_output_csv(
-    const std::vector<std::string> &headers,
-    const std::vector<std::vector<std::string>> &data) const {
-  std::ofstream file(output_file);
-  if (!file.is_open()) {
-    std::cerr << "Error: Could not create output file '" << output_file << "'"
+size_t AdapterApplication::run_stage(TableStage &stage, Table &table) {
+  ScopedStage scope(metrics, stage.get_stage_name());
+  scope.stage().rows_in = table.get_row_count();
+  stage.apply(table);
+  scope.stage().rows_out = table.get_row_count();
+  return scope.index();
+}
+
+bool AdapterApplication::write_output_csv(const Table &table,
+                                          StageMetrics &stage) const {
+  CsvWriter writer;
+  writer.set_direct_io(spec.direct_io);
+  if (!writer.open(output_file, spec.delimiter)) {
+    return false;
+  }
+
+  const bool written = writer.write_header(table.get_headers()) &&
+                       writer.write_table(table) && writer.close();
+  stage.rows_in = table.get_row_count();
+  stage.rows_out = writer.get_rows_written();
+  stage.bytes_written = writer.get_bytes_written();
+  return written;
+}
+
+bool AdapterApplication::write_output_arrow(const Table &table,
+                                            StageMetrics &stage) const {
+  uint64_t bytes_written = 0;
+  const bool written = write_arrow_file(table, output_file, &bytes_written);
+  stage.rows_in = table.get_row_count();
+  stage.rows_out = written ? table.get_row_count() : 0;
+  stage.bytes_written = bytes_written;
+  return written;
+}
+
+bool AdapterApplication::report_profile() const {
+  if (!profile) {
+    return true;
+  }
+
+  const std::string report = metrics.format(profile_format);
+  if (profile_file.empty()) {
+    std::cout << std::endl << "Profile:" << std::endl << report;
+    return true;
+  }
+
+  std::ofstream file(profile_file);
+  file << report;
+  if (!file.good()) {
+    std::cerr << "Error: Could not write profile to " << profile_file
               << std::endl;
     return false;
   }
+  std::cout << "Profile written to: " << profile_file << std::endl;
+  return true;
+}
+
+int AdapterApplication::run_streaming() {
+  std::cout << "Streaming in batches of " << batch_size << " rows..."
+            << std::endl;
+  if (!spec.time_column.empty()) {
+    std::cout << "Note: Time series alignment is not available in stream mode"
+              << std::endl;
+  }
 
-  char delimiter = config.get_delimiter();
+  DataCleaner cleaner;
+  spec.configure(cleaner);
+  StreamingPipeline pipeline;
+  pipeline.set_delimiter(spec.delimiter);
+  pipeline.set_batch_size(batch_size);
+  pipeline.set_direct_io(spec.direct_io);
+  pipeline.set_queue_depth(spec.pipeline_depth);
+  pipeline.set_inference(spec.inference);
+
+  bool ran = false;
+  {
+    ScopedStage stage(metrics, "stream");
+    ran = pipeline.run(input_file, output_file, cleaner);
+    StageMetrics &stream = stage.stage();
+    stream.bytes_read = pipeline.get_bytes_read();
+    stream.bytes_written = pipeline.get_bytes_written();
+    stream.rows_in = pipeline.get_rows_read();
+    stream.rows_out = pipeline.get_rows_written();
+    metrics.add_counter(stage.index(), "malformed_rows",
+                        pipeline.get_malformed_count());
+    metrics.add_counter(stage.index(), "duplicate_rows",
+                        pipeline.get_duplicates_removed());
+    for (const auto &imputed : pipeline.get_imputed_cells()) {
+      metrics.add_counter(stage.index(), "cells_imputed", imputed.second,
+                          "strategy", imputed.first);
+    }
+    metrics.add_counter(stage.index(), "batches", pipeline.get_batch_count());
+    metrics.add_counter(stage.index(), "reader_stalls",
+                        pipeline.get_reader_stalls());
+    metrics.add_counter(stage.index(), "cleaner_stalls",
+                        pipeline.get_cleaner_stalls());
+  }
 
-  // Write headers
-  for (size_t i = 0; i < headers.size(); ++i) {
-    file << headers[i];
-    if (i < headers.size() - 1)
-      file << delimiter;
+  if (!ran) {
+    std::cerr << "Error: Streaming run failed" << std::endl;
+    report_profile();
+    return 1;
   }
-  file << std::endl;
 
-  // Write data
-  for (const auto &row : data) {
-    for (size_t i = 0; i < row.size(); ++i) {
-      file << row[i];
-      if (i < row.size() - 1)
-        file << delimiter;
+  std::cout << "Successfully processed " << pipeline.get_rows_written()
+            << " rows in " << pipeline.get_batch_count() << " batches"
+            << std::endl;
+  std::cout << "Output written to: " << output_file << std::endl;
+  std::cout << "Processing complete!" << std::endl;
+
+  return report_profile() ? 0 : 1;
+}
+
+int AdapterApplication::run_merge() {
+  std::cout << "Merging " << input_files.size() << " files onto one grid..."
+            << std::endl;
+
+  MergeAligner merger;
+  merger.set_delimiter(spec.delimiter);
+  merger.set_time_column(spec.time_column);
+  merger.set_target_time_interval(spec.target_time_interval);
+  merger.set_max_gap(spec.max_gap);
+  merger.set_direct_io(spec.direct_io);
+
+  bool ran = false;
+  {
+    ScopedStage stage(metrics, "merge");
+    ran = merger.run(input_files, output_file);
+    StageMetrics &merge = stage.stage();
+    merge.bytes_read = merger.get_bytes_read();
+    merge.bytes_written = merger.get_bytes_written();
+    merge.rows_in = merger.get_rows_read();
+    merge.rows_out = merger.get_rows_written();
+    metrics.add_counter(stage.index(), "input_files", input_files.size());
+    metrics.add_counter(stage.index(), "malformed_rows",
+                        merger.get_malformed_count());
+    metrics.add_counter(stage.index(), "unparsed_times",
+                        merger.get_unparsed_time_count());
+    metrics.add_counter(stage.index(), "out_of_order_rows",
+                        merger.get_out_of_order_count());
+  }
+
+  if (!ran) {
+    std::cerr << "Error: Merge failed" << std::endl;
+    report_profile();
+    return 1;
+  }
+
+  std::cout << "Successfully merged " << merger.get_rows_read()
+            << " rows into " << merger.get_rows_written() << " aligned rows"
+            << std::endl;
+  std::cout << "Output written to: " << output_file << std::endl;
+  std::cout << "Processing complete!" << std::endl;
+
+  return report_profile() ? 0 : 1;
+}
+
+int AdapterApplication::run_incremental() {
+  std::cout << "Processing rows appended since the last run..." << std::endl;
+  if (!spec.snapshot_file.empty()) {
+    std::cout << "Note: Snapshots are not used by incremental runs"
+              << std::endl;
+  }
+
+  DataCleaner cleaner;
+  spec.configure(cleaner);
+  TimeAligner aligner;
+  const bool align = !spec.time_column.empty();
+  if (align) {
+    spec.configure(aligner);
+  }
+  IncrementalPipeline pipeline;
+  pipeline.set_delimiter(spec.delimiter);
+  pipeline.set_projection(spec.projected_columns);
+  pipeline.set_thread_count(spec.thread_count);
+  pipeline.set_inference(spec.inference);
+  pipeline.set_direct_io(spec.direct_io);
+
+  bool ran = false;
+  {
+    ScopedStage stage(metrics, "incremental");
+    ran = pipeline.run(input_file, output_file, spec.state_file,
+                       cleaner, align ? &aligner : nullptr);
+    StageMetrics &incremental = stage.stage();
+    incremental.bytes_read = pipeline.get_bytes_read();
+    incremental.bytes_written = pipeline.get_bytes_written();
+    incremental.rows_in = pipeline.get_rows_read();
+    incremental.rows_out = pipeline.get_rows_written();
+    metrics.add_counter(stage.index(), "resumed",
+                        pipeline.was_resumed() ? 1 : 0);
+    metrics.add_counter(stage.index(), "malformed_rows",
+                        pipeline.get_malformed_count());
+    metrics.add_counter(stage.index(), "duplicate_rows",
+                        pipeline.get_duplicates_removed());
+    for (const auto &imputed : pipeline.get_imputed_cells()) {
+      metrics.add_counter(stage.index(), "cells_imputed", imputed.second,
+                          "strategy", imputed.first);
     }
-    file << std::endl;
   }
 
-  file.close();
-  return true;
+  if (!ran) {
+    std::cerr << "Error: Incremental run failed" << std::endl;
+    report_profile();
+    return 1;
+  }
+
+  std::cout << "Successfully processed " << pipeline.get_rows_read()
+            << " new rows into " << pipeline.get_rows_written()
+            << " output rows" << std::endl;
+  std::cout << "Output " << (pipeline.was_resumed() ? "appended" : "written")
+            << " to: " << output_file << std::endl;
+  std::cout << "Processing complete!" << std::endl;
+
+  return report_profile() ? 0 : 1;
+}
+
+int AdapterApplication::run_batch() {
+  if (!spec.snapshot_file.empty()) {
+    std::cout << "Note: Snapshots are not used by batch runs" << std::endl;
+  }
+
+  BatchRunner runner(spec);
+  std::cout << "Running batch jobs on " << runner.get_worker_count()
+            << " workers..." << std::endl;
+
+  bool ran = false;
+  const auto start = std::chrono::steady_clock::now();
+  std::streambuf *console = std::cout.rdbuf();
+  {
+    DiscardBuffer discard;
+    std::ostream report(console);
+    std::cout.rdbuf(&discard);
+    if (!listen_socket.empty()) {
+      report << "Listening on " << listen_socket << std::endl;
+      ran = serve_batch_socket(runner, listen_socket);
+    } else if (batch_manifest == "-") {
+      run_batch_stream(runner, std::cin, report);
+      ran = true;
+    } else {
+      std::ifstream manifest(batch_manifest);
+      if (manifest.is_open()) {
+        run_batch_stream(runner, manifest, report);
+        ran = true;
+      } else {
+        std::cerr << "Error: Could not open manifest " << batch_manifest
+                  << std::endl;
+      }
+    }
+    std::cout.rdbuf(console);
+  }
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  // The profile holds the jobs' stages summed over the batch, so the time
+  // of every stage is counted once; the batch stage only carries counts
+  metrics.merge(runner.get_metrics());
+  const size_t batch_stage = metrics.begin_stage("batch");
+  metrics.end_stage(batch_stage);
+  metrics.add_counter(batch_stage, "jobs", runner.get_job_count());
+  metrics.add_counter(batch_stage, "failed_jobs", runner.get_failed_count());
+
+  if (!ran) {
+    report_profile();
+    return 1;
+  }
+
+  std::cout << "Processed " << runner.get_job_count() << " jobs, "
+            << runner.get_failed_count() << " failed in " << seconds
+            << " seconds" << std::endl;
+  std::cout << "Processing complete!" << std::endl;
+
+  const bool reported = report_profile();
+  return reported && runner.get_failed_count() == 0 ? 0 : 1;
 }
 
 int AdapterApplication::run(int argc, char *argv[]) {
@@ -197,71 +586,132 @@ int AdapterApplication::run(int argc, char *argv[]) {
   config.print_configuration();
   std::cout << std::endl;
 
+  if ((!batch_manifest.empty() || !listen_socket.empty()) &&
+      (merge_mode || stream_mode || !spec.state_file.empty())) {
+    std::cerr << "Error: Batch jobs run the in-memory pipeline and cannot "
+                 "be combined with --stream, --merge or --incremental"
+              << std::endl;
+    return 1;
+  }
+  if (!batch_manifest.empty() || !listen_socket.empty()) {
+    return run_batch();
+  }
+  if (!spec.state_file.empty() && (merge_mode || stream_mode)) {
+    std::cerr << "Error: Incremental runs cannot use --stream or --merge"
+              << std::endl;
+    return 1;
+  }
+  if (spec.output_format != OutputFormat::CSV &&
+      (merge_mode || stream_mode || !spec.state_file.empty())) {
+    std::cerr << "Error: Arrow output is written from the whole table and "
+                 "cannot be combined with --stream, --merge or --incremental"
+              << std::endl;
+    return 1;
+  }
+  if (merge_mode) {
+    return run_merge();
+  }
+  if (stream_mode) {
+    return run_streaming();
+  }
+  if (!spec.state_file.empty()) {
+    return run_incremental();
+  }
+
   // Step 1: Parse CSV
   std::cout << "Step 1: Parsing CSV file..." << std::endl;
   CsvParser parser;
-  parser.set_delimiter(config.get_delimiter());
+  parser.set_delimiter(spec.delimiter);
+  parser.set_thread_count(spec.thread_count);
+  parser.set_projection(spec.projected_columns);
+  parser.set_inference(spec.inference);
+  if (!spec.snapshot_file.empty()) {
+    parser.set_snapshot_file(spec.snapshot_file);
+    parser.set_snapshot_compression(spec.snapshot_compression);
+  }
 
-  if (!parser.load_file(input_file)) {
-    std::cerr << "Error: Failed to load CSV file" << std::endl;
-    return 1;
+  {
+    ScopedStage stage(metrics, "parse");
+    if (!parser.load_file(input_file)) {
+      std::cerr << "Error: Failed to load CSV file" << std::endl;
+      return 1;
+    }
+    stage.stage().bytes_read = parser.get_bytes_read();
+    stage.stage().rows_out = parser.get_row_count();
+    metrics.add_counter(stage.index(), "malformed_rows",
+                        parser.get_malformed_count());
+    metrics.add_counter(stage.index(), "snapshot_hits",
+                        parser.is_from_snapshot() ? 1 : 0);
   }
 
   std::cout << "Successfully loaded " << parser.get_row_count() << " rows with "
             << parser.get_column_count() << " columns" << std::endl;
+  const Table &loaded = parser.get_table();
+  std::cout << "Column types:";
+  for (size_t col = 0; col < loaded.get_column_count(); ++col) {
+    const Column &column = loaded.get_column(col);
+    std::cout << (col == 0 ? " " : ", ") << column.get_name() << ':'
+              << column_kind_name(column.get_kind());
+  }
+  std::cout << std::endl;
   std::cout << std::endl;
 
   // Step 2: Data Cleaning
   std::cout << "Step 2: Cleaning data..." << std::endl;
   DataCleaner cleaner;
-
-  auto data = parser.get_data();
-  cleaner.clean_data(data);
+  spec.configure(cleaner);
+
+  // The table is moved through every stage and transformed in place
+  Table table = parser.take_table();
+  const size_t clean_stage = run_stage(cleaner, table);
+  metrics.add_counter(clean_stage, "duplicate_rows",
+                      cleaner.get_duplicates_removed());
+  size_t null_cells = 0;
+  for (const auto &stats : cleaner.get_column_stats()) {
+    null_cells += stats.null_count;
+  }
+  metrics.add_counter(clean_stage, "null_cells", null_cells);
+  for (const auto &imputed : cleaner.get_imputed_cells()) {
+    metrics.add_counter(clean_stage, "cells_imputed", imputed.second,
+                        "strategy", imputed.first);
+  }
   std::cout << std::endl;
 
   // Step 3: Time Series Alignment (if time column specified)
-  std::vector<std::string> final_headers = parser.get_headers();
-  std::vector<std::vector<std::string>> final_data = data;
-
-  if (!config.get_time_column().empty()) {
+  if (!spec.time_column.empty()) {
     std::cout << "Step 3: Aligning time series data..." << std::endl;
     TimeAligner aligner;
-    aligner.set_target_time_interval(config.get_target_time_interval());
-
-    // Prepare data with headers as first row
-    std::vector<std::vector<std::string>> data_with_headers;
-    data_with_headers.push_back(final_headers);
-    data_with_headers.insert(data_with_headers.end(), final_data.begin(),
-                             final_data.end());
-
-    aligner.align_time_series_data(data_with_headers, config.get_time_column(),
-                                   config.get_dependent_variables(),
-                                   config.get_independent_variables());
-
-    // Extract headers and data
-    if (!data_with_headers.empty()) {
-      final_headers = data_with_headers[0];
-      final_data.clear();
-      for (size_t i = 1; i < data_with_headers.size(); ++i) {
-        final_data.push_back(data_with_headers[i]);
-      }
-    }
+    spec.configure(aligner);
+
+    const size_t align_stage = run_stage(aligner, table);
+    metrics.add_counter(align_stage, "aligned_points",
+                        aligner.get_aligned_point_count());
+    metrics.add_counter(align_stage, "unparsed_times",
+                        aligner.get_unparsed_time_count());
+    metrics.add_counter(align_stage, "gap_points",
+                        aligner.get_gap_point_count());
     std::cout << std::endl;
   }
 
   // Step 4: Write Output
   std::cout << "Step 4: Writing output..." << std::endl;
-  if (!write_output_csv(final_headers, final_data)) {
-    std::cerr << "Error: Failed to write output file" << std::endl;
-    return 1;
+  {
+    ScopedStage stage(metrics, "write");
+    const bool written = spec.output_format == OutputFormat::ARROW
+                             ? write_output_arrow(table, stage.stage())
+                             : write_output_csv(table, stage.stage());
+    if (!written) {
+      std::cerr << "Error: Failed to write output file" << std::endl;
+      return 1;
+    }
   }
 
-  std::cout << "Successfully processed " << final_data.size() << " rows"
+  std::cout << "Successfully processed " << table.get_row_count() << " rows"
             << std::endl;
   std::cout << "Output written to: " << output_file << std::endl;
   std::cout << "Processing complete!" << std::endl;
 
-  return 0;
+  return report_profile() ? 0 : 1;
 }
 
 } // namespace adapter
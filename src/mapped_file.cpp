@@ -0,0 +1,155 @@
+#include "adapter/mapped_file.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace adapter {
+
+MappedFile::MappedFile()
+    : opened(false), mapping(nullptr), length(0),
+      compression(StreamCompression::NONE) {}
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : opened(other.opened), mapping(other.mapping), length(other.length),
+      buffer(std::move(other.buffer)), compression(other.compression) {
+  other.opened = false;
+  other.mapping = nullptr;
+  other.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    opened = other.opened;
+    mapping = other.mapping;
+    length = other.length;
+    buffer = std::move(other.buffer);
+    compression = other.compression;
+    other.opened = false;
+    other.mapping = nullptr;
+    other.length = 0;
+  }
+  return *this;
+}
+
+bool MappedFile::open(const std::string &filename) {
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *address = ::mmap(nullptr, static_cast<size_t>(st.st_size),
+                           PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      ::madvise(address, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+      mapping = address;
+      length = static_cast<size_t>(st.st_size);
+      opened = true;
+      ::close(fd);
+      return true;
+    }
+  }
+
+  // Pipes, empty files and filesystems without mmap support
+  opened = read_into_buffer(fd);
+  ::close(fd);
+  return opened;
+}
+
+bool MappedFile::open_decompressed(const std::string &filename,
+                                   size_t thread_count) {
+  if (!open(filename)) {
+    return false;
+  }
+  const StreamCompression detected = detect_stream_compression(data(), size());
+  if (detected == StreamCompression::NONE) {
+    return true;
+  }
+  if (!stream_compression_available(detected)) {
+    std::cerr << "Error: " << filename << " is "
+              << stream_compression_name(detected)
+              << " compressed, which this build cannot read" << std::endl;
+    close();
+    return false;
+  }
+
+  std::vector<char> decoded;
+  const bool ok =
+      decompress_buffer(data(), size(), detected, decoded, thread_count);
+  close();
+  if (!ok) {
+    std::cerr << "Error: Could not decompress " << filename << std::endl;
+    return false;
+  }
+  buffer = std::move(decoded);
+  length = buffer.size();
+  compression = detected;
+  opened = true;
+  return true;
+}
+
+void MappedFile::close() {
+  if (mapping != nullptr) {
+    ::munmap(mapping, length);
+    mapping = nullptr;
+  }
+  std::vector<char>().swap(buffer);
+  length = 0;
+  compression = StreamCompression::NONE;
+  opened = false;
+}
+
+bool MappedFile::is_open() const { return opened; }
+
+bool MappedFile::is_mapped() const { return mapping != nullptr; }
+
+const char *MappedFile::data() const {
+  return mapping != nullptr ? static_cast<const char *>(mapping)
+                            : buffer.data();
+}
+
+size_t MappedFile::size() const { return length; }
+
+StreamCompression MappedFile::get_compression() const { return compression; }
+
+bool MappedFile::read_into_buffer(int fd) {
+  const size_t chunk_size = 1 << 16;
+  size_t used = 0;
+
+  while (true) {
+    buffer.resize(used + chunk_size);
+    ssize_t count = ::read(fd, buffer.data() + used, chunk_size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count < 0) {
+      buffer.clear();
+      return false;
+    }
+    if (count == 0) {
+      break;
+    }
+    used += static_cast<size_t>(count);
+  }
+
+  buffer.resize(used);
+  length = used;
+  return true;
+}
+
+} // namespace adapter
@@ -0,0 +1,276 @@
+#include "adapter/merge_aligner.hpp"
+#include "adapter/csv_writer.hpp"
+#include "adapter/value_parser.hpp"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <utility>
+
+namespace adapter {
+
+namespace {
+
+std::string file_stem(const std::string &filename) {
+  const size_t slash = filename.find_last_of('/');
+  std::string stem =
+      slash == std::string::npos ? filename : filename.substr(slash + 1);
+  const size_t dot = stem.find_last_of('.');
+  return dot == std::string::npos || dot == 0 ? stem : stem.substr(0, dot);
+}
+
+double interpolate(double x, double x1, double y1, double x2, double y2) {
+  if (std::abs(x2 - x1) < 1e-10) {
+    return y1; // Avoid division by zero
+  }
+  return y1 + (y2 - y1) * (x - x1) / (x2 - x1);
+}
+
+} // namespace
+
+MergeAligner::MergeAligner()
+    : delimiter(','), time_column("time"), target_time_interval(1.0),
+      max_gap(0.0), buffer_size(1 << 20), direct_io(false), rows_read(0),
+      rows_written(0), malformed_count(0), unparsed_time_count(0),
+      out_of_order_count(0), bytes_read(0), bytes_written(0) {}
+
+MergeAligner::~MergeAligner() {}
+
+void MergeAligner::set_delimiter(char delimiter) {
+  this->delimiter = delimiter;
+}
+
+void MergeAligner::set_time_column(const std::string &name) {
+  time_column = name;
+}
+
+void MergeAligner::set_target_time_interval(double interval_seconds) {
+  target_time_interval = interval_seconds;
+}
+
+void MergeAligner::set_max_gap(double seconds) { max_gap = seconds; }
+
+void MergeAligner::set_buffer_size(size_t bytes) { buffer_size = bytes; }
+
+void MergeAligner::set_direct_io(bool enabled) { direct_io = enabled; }
+
+bool MergeAligner::run(const std::vector<std::string> &input_files,
+                       const std::string &output_file) {
+  rows_read = 0;
+  rows_written = 0;
+  malformed_count = 0;
+  unparsed_time_count = 0;
+  out_of_order_count = 0;
+  bytes_read = 0;
+  bytes_written = 0;
+
+  if (target_time_interval <= 0.0) {
+    std::cerr << "Error: Target time interval must be positive" << std::endl;
+    return false;
+  }
+
+  std::vector<Source> sources;
+  std::vector<std::string> headers;
+  if (!open_sources(input_files, sources, headers)) {
+    return false;
+  }
+
+  CsvWriter writer;
+  writer.set_direct_io(direct_io);
+  if (!writer.open(output_file, delimiter) || !writer.write_header(headers)) {
+    return false;
+  }
+
+  // The heap holds each file's next sample time; the smallest is always
+  // the next sample in merged order
+  using Entry = std::pair<double, size_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    sources[i].has_next = read_sample(sources[i]);
+    if (sources[i].has_next) {
+      heap.push({sources[i].next.time, i});
+    }
+  }
+  if (heap.empty()) {
+    std::cerr << "Warning: No parseable time values in the input files"
+              << std::endl;
+  }
+
+  std::vector<std::string> row;
+  row.reserve(headers.size());
+  double grid_time = heap.empty() ? 0.0 : heap.top().first;
+  bool written = true;
+  while (!heap.empty() && written) {
+    const Entry top = heap.top();
+
+    // Every file's next sample is at or after top, so grid points up to it
+    // are bracketed in every file
+    while (grid_time <= top.first && written) {
+      row.clear();
+      row.push_back(format_iso_timestamp(grid_time));
+      for (const auto &source : sources) {
+        fill_row(source, grid_time, row);
+      }
+      written = writer.write_row(row);
+      ++rows_written;
+      grid_time += target_time_interval;
+    }
+
+    heap.pop();
+    Source &source = sources[top.second];
+    std::swap(source.previous, source.next);
+    source.has_previous = true;
+    source.has_next = read_sample(source);
+    if (source.has_next) {
+      heap.push({source.next.time, top.second});
+    }
+  }
+
+  for (const auto &source : sources) {
+    malformed_count += source.reader->get_malformed_count();
+    bytes_read += source.reader->get_bytes_read();
+  }
+  written = writer.close() && written;
+  bytes_written = writer.get_bytes_written();
+  if (!written) {
+    std::cerr << "Error: Failed to write output file" << std::endl;
+  }
+  return written;
+}
+
+size_t MergeAligner::get_rows_read() const { return rows_read; }
+
+size_t MergeAligner::get_rows_written() const { return rows_written; }
+
+size_t MergeAligner::get_malformed_count() const { return malformed_count; }
+
+size_t MergeAligner::get_unparsed_time_count() const {
+  return unparsed_time_count;
+}
+
+size_t MergeAligner::get_out_of_order_count() const {
+  return out_of_order_count;
+}
+
+size_t MergeAligner::get_bytes_read() const { return bytes_read; }
+
+size_t MergeAligner::get_bytes_written() const { return bytes_written; }
+
+bool MergeAligner::open_sources(const std::vector<std::string> &input_files,
+                                std::vector<Source> &sources,
+                                std::vector<std::string> &headers) const {
+  if (input_files.empty()) {
+    std::cerr << "Error: No input files to merge" << std::endl;
+    return false;
+  }
+
+  sources.resize(input_files.size());
+  std::map<std::string, size_t> name_counts;
+  for (size_t i = 0; i < input_files.size(); ++i) {
+    Source &source = sources[i];
+    source.filename = input_files[i];
+    source.reader.reset(new CsvStreamReader());
+    source.reader->set_buffer_size(buffer_size);
+    if (!source.reader->open(source.filename, delimiter)) {
+      return false;
+    }
+
+    const std::vector<std::string> &file_headers =
+        source.reader->get_headers();
+    size_t time_field = file_headers.size();
+    for (size_t field = 0; field < file_headers.size(); ++field) {
+      if (file_headers[field] == time_column) {
+        time_field = field;
+      } else {
+        source.value_fields.push_back(field);
+        ++name_counts[file_headers[field]];
+      }
+    }
+    if (time_field == file_headers.size()) {
+      std::cerr << "Error: Time column '" << time_column << "' not found in "
+                << source.filename << std::endl;
+      return false;
+    }
+    source.time_field = time_field;
+  }
+
+  headers.assign(1, time_column);
+  for (const auto &source : sources) {
+    const std::vector<std::string> &file_headers =
+        source.reader->get_headers();
+    for (size_t field : source.value_fields) {
+      const std::string &name = file_headers[field];
+      headers.push_back(name_counts[name] > 1
+                            ? file_stem(source.filename) + "." + name
+                            : name);
+    }
+  }
+  return true;
+}
+
+bool MergeAligner::read_sample(Source &source) {
+  Sample &sample = source.next;
+  while (source.reader->next_row(source.cells)) {
+    ++rows_read;
+    const std::string_view time_cell = source.cells[source.time_field];
+    double time = 0.0;
+    if (!parse_timestamp(time_cell, time)) {
+      ++unparsed_time_count;
+      std::cerr << "Warning: Could not parse time value: " << time_cell
+                << std::endl;
+      continue;
+    }
+    // Files are merged without being sorted, so a step back is dropped
+    if (source.has_previous && time < source.previous.time) {
+      ++out_of_order_count;
+      std::cerr << "Warning: Skipping out-of-order time " << time_cell
+                << " in " << source.filename << std::endl;
+      continue;
+    }
+
+    const size_t count = source.value_fields.size();
+    sample.time = time;
+    sample.cells.resize(count);
+    sample.numbers.resize(count);
+    sample.numeric.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      const std::string_view cell = source.cells[source.value_fields[i]];
+      sample.cells[i].assign(cell.data(), cell.size());
+      sample.numeric[i] = parse_number(cell, sample.numbers[i]);
+    }
+    return true;
+  }
+  return false;
+}
+
+void MergeAligner::fill_row(const Source &source, double t,
+                            std::vector<std::string> &row) const {
+  auto render = [](const Sample &sample, size_t i) {
+    return sample.numeric[i] ? format_fixed(sample.numbers[i], 6)
+                             : sample.cells[i];
+  };
+
+  const Sample &lower = source.previous;
+  const Sample &upper = source.next;
+  for (size_t i = 0; i < source.value_fields.size(); ++i) {
+    if (source.has_next && upper.time == t) {
+      row.push_back(render(upper, i));
+    } else if (!source.has_previous || !source.has_next) {
+      // Before the file's first sample or after its last
+      row.emplace_back();
+    } else if (max_gap > 0.0 && upper.time - lower.time > max_gap) {
+      row.emplace_back();
+    } else if (lower.numeric[i] && upper.numeric[i]) {
+      row.push_back(format_fixed(interpolate(t, lower.time, lower.numbers[i],
+                                             upper.time, upper.numbers[i]),
+                                 6));
+    } else {
+      // If not numeric, use nearest neighbor
+      row.push_back(t - lower.time <= upper.time - t ? render(lower, i)
+                                                     : render(upper, i));
+    }
+  }
+}
+
+} // namespace adapter
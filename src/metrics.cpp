@@ -0,0 +1,310 @@
+#include "adapter/metrics.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+
+namespace adapter {
+
+namespace {
+
+std::string escape_quoted(const std::string &text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+std::string counter_label(const MetricCounter &counter) {
+  if (counter.label_name.empty()) {
+    return counter.name;
+  }
+  return counter.name + "{" + counter.label_name + "=" + counter.label_value +
+         "}";
+}
+
+double to_megabytes(size_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+struct StageField {
+  const char *name;
+  const char *help;
+  const char *type;
+  double (*value)(const StageMetrics &);
+};
+
+const StageField stage_fields[] = {
+    {"stage_wall_seconds", "Wall-clock time spent in a pipeline stage.",
+     "gauge", [](const StageMetrics &s) { return s.wall_seconds; }},
+    {"stage_cpu_seconds", "Process CPU time spent in a pipeline stage.",
+     "gauge", [](const StageMetrics &s) { return s.cpu_seconds; }},
+    {"stage_peak_rss_bytes", "Peak resident set size at the end of a stage.",
+     "gauge",
+     [](const StageMetrics &s) { return static_cast<double>(s.peak_rss_bytes); }},
+    {"bytes_read_total", "Bytes read by a stage.", "counter",
+     [](const StageMetrics &s) { return static_cast<double>(s.bytes_read); }},
+    {"bytes_written_total", "Bytes written by a stage.", "counter",
+     [](const StageMetrics &s) { return static_cast<double>(s.bytes_written); }},
+    {"rows_in_total", "Rows a stage received.", "counter",
+     [](const StageMetrics &s) { return static_cast<double>(s.rows_in); }},
+    {"rows_out_total", "Rows a stage produced.", "counter",
+     [](const StageMetrics &s) { return static_cast<double>(s.rows_out); }},
+};
+
+} // namespace
+
+Metrics::Metrics() {}
+
+size_t Metrics::begin_stage(const std::string &name) {
+  StageMetrics stage;
+  stage.name = name;
+  stages.push_back(stage);
+
+  OpenStage open;
+  open.wall_start = std::chrono::steady_clock::now();
+  open.cpu_start = process_cpu_seconds();
+  open_stages.push_back(open);
+  return stages.size() - 1;
+}
+
+void Metrics::end_stage(size_t stage) {
+  if (stage >= stages.size()) {
+    return;
+  }
+  const OpenStage &open = open_stages[stage];
+  StageMetrics &metrics = stages[stage];
+  metrics.wall_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - open.wall_start)
+                             .count();
+  metrics.cpu_seconds = process_cpu_seconds() - open.cpu_start;
+  metrics.peak_rss_bytes = peak_rss_bytes();
+}
+
+StageMetrics &Metrics::get_stage(size_t stage) { return stages.at(stage); }
+
+const std::vector<StageMetrics> &Metrics::get_stages() const {
+  return stages;
+}
+
+void Metrics::add_counter(size_t stage, const std::string &name,
+                          uint64_t value, const std::string &label_name,
+                          const std::string &label_value) {
+  std::vector<MetricCounter> &counters = stages.at(stage).counters;
+  for (auto &counter : counters) {
+    if (counter.name == name && counter.label_name == label_name &&
+        counter.label_value == label_value) {
+      counter.value += value;
+      return;
+    }
+  }
+
+  MetricCounter counter;
+  counter.name = name;
+  counter.label_name = label_name;
+  counter.label_value = label_value;
+  counter.value = value;
+  counters.push_back(counter);
+}
+
+void Metrics::merge(const Metrics &other) {
+  for (const StageMetrics &source : other.stages) {
+    size_t index = 0;
+    while (index < stages.size() && stages[index].name != source.name) {
+      ++index;
+    }
+    if (index == stages.size()) {
+      StageMetrics stage;
+      stage.name = source.name;
+      stages.push_back(stage);
+      open_stages.push_back(OpenStage());
+    }
+
+    StageMetrics &target = stages[index];
+    target.wall_seconds += source.wall_seconds;
+    target.cpu_seconds += source.cpu_seconds;
+    target.peak_rss_bytes =
+        std::max(target.peak_rss_bytes, source.peak_rss_bytes);
+    target.bytes_read += source.bytes_read;
+    target.bytes_written += source.bytes_written;
+    target.rows_in += source.rows_in;
+    target.rows_out += source.rows_out;
+    for (const MetricCounter &counter : source.counters) {
+      add_counter(index, counter.name, counter.value, counter.label_name,
+                  counter.label_value);
+    }
+  }
+}
+
+std::string Metrics::format(MetricsFormat format) const {
+  switch (format) {
+  case MetricsFormat::JSON:
+    return to_json();
+  case MetricsFormat::PROMETHEUS:
+    return to_prometheus();
+  case MetricsFormat::TABLE:
+    break;
+  }
+  return to_table();
+}
+
+std::string Metrics::to_table() const {
+  std::ostringstream out;
+  out << std::left << std::setw(12) << "stage" << std::right << std::setw(10)
+      << "wall s" << std::setw(10) << "cpu s" << std::setw(12) << "peak MB"
+      << std::setw(11) << "read MB" << std::setw(11) << "write MB"
+      << std::setw(11) << "rows in" << std::setw(11) << "rows out" << "\n";
+
+  double total_wall = 0.0;
+  double total_cpu = 0.0;
+  for (const auto &stage : stages) {
+    out << std::left << std::setw(12) << stage.name << std::right
+        << std::fixed << std::setprecision(3) << std::setw(10)
+        << stage.wall_seconds << std::setw(10) << stage.cpu_seconds
+        << std::setprecision(1) << std::setw(12)
+        << to_megabytes(stage.peak_rss_bytes) << std::setw(11)
+        << to_megabytes(stage.bytes_read) << std::setw(11)
+        << to_megabytes(stage.bytes_written) << std::setw(11) << stage.rows_in
+        << std::setw(11) << stage.rows_out << "\n";
+    for (const auto &counter : stage.counters) {
+      out << "  " << counter_label(counter) << ": " << counter.value << "\n";
+    }
+    total_wall += stage.wall_seconds;
+    total_cpu += stage.cpu_seconds;
+  }
+
+  out << std::left << std::setw(12) << "total" << std::right << std::fixed
+      << std::setprecision(3) << std::setw(10) << total_wall << std::setw(10)
+      << total_cpu << "\n";
+  return out.str();
+}
+
+std::string Metrics::to_json() const {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(6);
+  out << "{\n  \"stages\": [";
+  for (size_t i = 0; i < stages.size(); ++i) {
+    const StageMetrics &stage = stages[i];
+    out << (i == 0 ? "\n" : ",\n");
+    out << "    {\"name\": \"" << escape_quoted(stage.name) << "\""
+        << ", \"wall_seconds\": " << stage.wall_seconds
+        << ", \"cpu_seconds\": " << stage.cpu_seconds
+        << ", \"peak_rss_bytes\": " << stage.peak_rss_bytes
+        << ", \"bytes_read\": " << stage.bytes_read
+        << ", \"bytes_written\": " << stage.bytes_written
+        << ", \"rows_in\": " << stage.rows_in
+        << ", \"rows_out\": " << stage.rows_out << ", \"counters\": [";
+    for (size_t j = 0; j < stage.counters.size(); ++j) {
+      const MetricCounter &counter = stage.counters[j];
+      out << (j == 0 ? "" : ", ") << "{\"name\": \""
+          << escape_quoted(counter.name) << "\"";
+      if (!counter.label_name.empty()) {
+        out << ", \"labels\": {\"" << escape_quoted(counter.label_name)
+            << "\": \"" << escape_quoted(counter.label_value) << "\"}";
+      }
+      out << ", \"value\": " << counter.value << "}";
+    }
+    out << "]}";
+  }
+  out << (stages.empty() ? "]\n" : "\n  ]\n") << "}\n";
+  return out.str();
+}
+
+std::string Metrics::to_prometheus() const {
+  std::ostringstream out;
+  out << std::setprecision(9);
+
+  for (const auto &field : stage_fields) {
+    out << "# HELP adapter_" << field.name << " " << field.help << "\n";
+    out << "# TYPE adapter_" << field.name << " " << field.type << "\n";
+    for (const auto &stage : stages) {
+      out << "adapter_" << field.name << "{stage=\""
+          << escape_quoted(stage.name) << "\"} " << field.value(stage) << "\n";
+    }
+  }
+
+  // Every counter name becomes one metric family across all stages
+  std::vector<std::string> names;
+  for (const auto &stage : stages) {
+    for (const auto &counter : stage.counters) {
+      bool seen = false;
+      for (const auto &name : names) {
+        seen = seen || name == counter.name;
+      }
+      if (!seen) {
+        names.push_back(counter.name);
+      }
+    }
+  }
+  for (const auto &name : names) {
+    out << "# TYPE adapter_" << name << "_total counter\n";
+    for (const auto &stage : stages) {
+      for (const auto &counter : stage.counters) {
+        if (counter.name != name) {
+          continue;
+        }
+        out << "adapter_" << name << "_total{stage=\""
+            << escape_quoted(stage.name) << "\"";
+        if (!counter.label_name.empty()) {
+          out << "," << counter.label_name << "=\""
+              << escape_quoted(counter.label_value) << "\"";
+        }
+        out << "} " << counter.value << "\n";
+      }
+    }
+  }
+  return out.str();
+}
+
+bool Metrics::parse_format(const std::string &name, MetricsFormat &format) {
+  if (name == "table") {
+    format = MetricsFormat::TABLE;
+  } else if (name == "json") {
+    format = MetricsFormat::JSON;
+  } else if (name == "prometheus") {
+    format = MetricsFormat::PROMETHEUS;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+double Metrics::process_cpu_seconds() {
+  rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0.0;
+  }
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+size_t Metrics::peak_rss_bytes() {
+  rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  // Linux reports kilobytes
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+ScopedStage::ScopedStage(Metrics &metrics, const std::string &name)
+    : metrics(metrics), stage_index(metrics.begin_stage(name)) {}
+
+ScopedStage::~ScopedStage() { metrics.end_stage(stage_index); }
+
+size_t ScopedStage::index() const { return stage_index; }
+
+StageMetrics &ScopedStage::stage() { return metrics.get_stage(stage_index); }
+
+} // namespace adapter
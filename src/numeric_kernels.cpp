@@ -0,0 +1,90 @@
+#include "adapter/numeric_kernels.hpp"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ADAPTER_X86_KERNELS 1
+#endif
+
+namespace adapter {
+
+namespace {
+
+void round_scalar(double *values, size_t count, double scale) {
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = std::round(values[i] * scale) / scale;
+  }
+}
+
+#ifdef ADAPTER_X86_KERNELS
+
+// Adding the largest double below one half and truncating rounds halves
+// away from zero for every finite input, matching std::round.
+constexpr double below_half = 0.49999999999999994;
+
+__attribute__((target("sse4.1"))) void round_sse41(double *values,
+                                                   size_t count,
+                                                   double scale) {
+  const __m128d factor = _mm_set1_pd(scale);
+  const __m128d half = _mm_set1_pd(below_half);
+  const __m128d sign = _mm_set1_pd(-0.0);
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d scaled = _mm_mul_pd(_mm_loadu_pd(values + i), factor);
+    // Keeps the product rounded: fusing it with the add into an FMA
+    // would break ties differently from the scalar path
+    __asm__("" : "+x"(scaled));
+    const __m128d bias = _mm_or_pd(half, _mm_and_pd(scaled, sign));
+    const __m128d whole = _mm_round_pd(_mm_add_pd(scaled, bias),
+                                       _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    _mm_storeu_pd(values + i, _mm_div_pd(whole, factor));
+  }
+  round_scalar(values + i, count - i, scale);
+}
+
+__attribute__((target("avx"))) void round_avx(double *values, size_t count,
+                                              double scale) {
+  const __m256d factor = _mm256_set1_pd(scale);
+  const __m256d half = _mm256_set1_pd(below_half);
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d scaled = _mm256_mul_pd(_mm256_loadu_pd(values + i), factor);
+    __asm__("" : "+x"(scaled));
+    const __m256d bias = _mm256_or_pd(half, _mm256_and_pd(scaled, sign));
+    const __m256d whole =
+        _mm256_round_pd(_mm256_add_pd(scaled, bias),
+                        _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    _mm256_storeu_pd(values + i, _mm256_div_pd(whole, factor));
+  }
+  round_scalar(values + i, count - i, scale);
+}
+
+#endif
+
+} // namespace
+
+void round_to_precision(double *values, size_t count, int precision) {
+  static const ScannerKernel kernel = StructuralScanner::detect_kernel();
+  round_to_precision(values, count, precision, kernel);
+}
+
+void round_to_precision(double *values, size_t count, int precision,
+                        ScannerKernel kernel) {
+  const double scale = std::pow(10.0, precision);
+  switch (kernel) {
+#ifdef ADAPTER_X86_KERNELS
+  case ScannerKernel::AVX2:
+    round_avx(values, count, scale);
+    return;
+  case ScannerKernel::SSE42:
+    round_sse41(values, count, scale);
+    return;
+#endif
+  default:
+    round_scalar(values, count, scale);
+    return;
+  }
+}
+
+} // namespace adapter
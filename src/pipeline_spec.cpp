@@ -0,0 +1,145 @@
+#include "adapter/pipeline_spec.hpp"
+#include "adapter/thread_pool.hpp"
+#include <iostream>
+#include <string_view>
+
+namespace adapter {
+
+namespace {
+
+// Without declared variables every column is aligned and written
+std::vector<std::string> projected_columns(const ConfigManager &config) {
+  std::vector<std::string> columns;
+  const std::vector<std::string> dependents = config.get_dependent_variables();
+  const std::vector<std::string> independents =
+      config.get_independent_variables();
+  if (!config.get_project_columns() ||
+      (dependents.empty() && independents.empty())) {
+    return columns;
+  }
+
+  if (!config.get_time_column().empty()) {
+    columns.push_back(config.get_time_column());
+  }
+  columns.insert(columns.end(), dependents.begin(), dependents.end());
+  columns.insert(columns.end(), independents.begin(), independents.end());
+  for (const auto &list :
+       {config.get_derivative_columns(), config.get_dedup_key_columns()}) {
+    columns.insert(columns.end(), list.begin(), list.end());
+  }
+  return columns;
+}
+
+InferenceOptions inference_options(const ConfigManager &config) {
+  InferenceOptions options;
+  options.sample_rows = config.get_infer_sample_rows();
+  options.sample_fraction = config.get_infer_sample_fraction();
+  for (const auto &entry : config.get_column_types()) {
+    const size_t colon = entry.rfind(':');
+    ColumnKind kind = ColumnKind::TEXT;
+    if (colon == std::string::npos || colon == 0 ||
+        !parse_column_kind(std::string_view(entry).substr(colon + 1), kind)) {
+      std::cerr << "Warning: Ignoring column type '" << entry
+                << "' (expected column:int|float|timestamp|categorical|text)"
+                << std::endl;
+      continue;
+    }
+    options.column_kinds[entry.substr(0, colon)] = kind;
+  }
+  return options;
+}
+
+} // namespace
+
+void PipelineSpec::configure(DataCleaner &cleaner) const {
+  cleaner.set_missing_value_rules(missing_value_rules);
+  cleaner.set_dedup_key_columns(dedup_key_columns);
+  cleaner.set_dedup_verify(dedup_verify);
+  cleaner.set_numeric_precision(numeric_precision);
+  cleaner.set_thread_count(thread_count);
+}
+
+void PipelineSpec::configure(TimeAligner &aligner) const {
+  aligner.set_target_time_interval(target_time_interval);
+  aligner.set_solver_method(solver_method);
+  aligner.set_spline_boundary(spline_boundary);
+  aligner.set_aggregation(aggregation);
+  aligner.set_max_gap(max_gap);
+  aligner.set_derivative_columns(derivative_columns);
+  aligner.set_thread_count(thread_count);
+  aligner.set_alignment_columns(time_column, dependent_variables,
+                                independent_variables);
+}
+
+bool resolve_pipeline_spec(const ConfigManager &config, PipelineSpec &spec) {
+  spec = PipelineSpec();
+  spec.delimiter = config.get_delimiter();
+  spec.thread_count = config.get_thread_count();
+  if (spec.thread_count == 0) {
+    spec.thread_count = ThreadPool::default_thread_count();
+  }
+  spec.direct_io = config.get_direct_io();
+  spec.pipeline_depth = config.get_pipeline_depth();
+
+  spec.snapshot_file = config.get_snapshot_file();
+  if (!spec.snapshot_file.empty() &&
+      (!parse_snapshot_compression(config.get_snapshot_compression(),
+                                   spec.snapshot_compression) ||
+       !snapshot_compression_available(spec.snapshot_compression))) {
+    std::cerr << "Warning: Snapshot compression '"
+              << config.get_snapshot_compression()
+              << "' is not available, writing uncompressed" << std::endl;
+    spec.snapshot_compression = SnapshotCompression::NONE;
+  }
+  spec.projected_columns = projected_columns(config);
+  spec.state_file = config.get_state_file();
+  spec.inference = inference_options(config);
+
+  spec.missing_value_rules =
+      parse_missing_value_rules(config.get_missing_value_strategies());
+  spec.dedup_key_columns = config.get_dedup_key_columns();
+  spec.dedup_verify = config.get_dedup_verify();
+  spec.numeric_precision = config.get_numeric_precision();
+
+  spec.time_column = config.get_time_column();
+  spec.dependent_variables = config.get_dependent_variables();
+  spec.independent_variables = config.get_independent_variables();
+  spec.target_time_interval = config.get_target_time_interval();
+  if (!TimeAligner::parse_solver_method(config.get_solver_method(),
+                                        spec.solver_method)) {
+    std::cerr << "Warning: Unknown solver method '"
+              << config.get_solver_method() << "', using linear" << std::endl;
+    spec.solver_method = SolverMethod::LINEAR_INTERPOLATION;
+  }
+  spec.spline_boundary = config.get_spline_boundary() == "clamped"
+                             ? SplineBoundary::CLAMPED
+                             : SplineBoundary::NATURAL;
+  if (!TimeAligner::parse_aggregation(config.get_aggregation(),
+                                      spec.aggregation)) {
+    std::cerr << "Warning: Unknown aggregation '" << config.get_aggregation()
+              << "', interpolating" << std::endl;
+    spec.aggregation = ResampleAggregation::NONE;
+  }
+  spec.max_gap = config.get_max_gap();
+  spec.derivative_columns = config.get_derivative_columns();
+
+  if (!parse_output_format(config.get_output_format(), spec.output_format)) {
+    std::cerr << "Error: Unknown output format '" << config.get_output_format()
+              << "' (csv, arrow or feather)" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+std::string default_output_file(const std::string &input_file,
+                                OutputFormat format) {
+  const std::string suffix =
+      format == OutputFormat::ARROW ? "_cleaned.arrow" : "_cleaned.csv";
+  size_t dot_pos = input_file.find_last_of('.');
+  if (dot_pos != std::string::npos) {
+    return input_file.substr(0, dot_pos) + suffix;
+  }
+  return input_file + suffix;
+}
+
+} // namespace adapter
@@ -0,0 +1,408 @@
+#include "adapter/row_deduplicator.hpp"
+#include "adapter/value_parser.hpp"
+#include <cstring>
+#include <iostream>
+
+namespace adapter {
+
+namespace {
+
+constexpr uint64_t null_marker = 0x5bd1e9955bd1e995ULL;
+constexpr uint64_t int_tag = 0x27d4eb2f165667c5ULL;
+constexpr uint64_t double_tag = 0x94d049bb133111ebULL;
+constexpr uint64_t absent_marker = 0xa0761d6478bd642fULL;
+
+inline uint64_t mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+inline uint64_t rotate_left(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// Two independent 64-bit lanes over the bytes, eight at a time.
+RowFingerprint hash_bytes(std::string_view bytes) {
+  uint64_t low = 0x9e3779b97f4a7c15ULL ^ bytes.size();
+  uint64_t high = 0xc2b2ae3d27d4eb4fULL + bytes.size();
+
+  const char *data = bytes.data();
+  size_t remaining = bytes.size();
+  while (remaining >= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    low = rotate_left((low ^ word) * 0x87c37b91114253d5ULL, 31);
+    high = rotate_left((high + word) * 0x4cf5ad432745937fULL, 27);
+    data += 8;
+    remaining -= 8;
+  }
+  if (remaining > 0) {
+    uint64_t word = 0;
+    std::memcpy(&word, data, remaining);
+    low = rotate_left((low ^ word) * 0x87c37b91114253d5ULL, 31);
+    high = rotate_left((high + word) * 0x4cf5ad432745937fULL, 27);
+  }
+
+  return RowFingerprint{mix(low), mix(high ^ low)};
+}
+
+RowFingerprint hash_word(uint64_t word, uint64_t tag) {
+  return RowFingerprint{mix(word ^ tag), mix(word + tag * 3)};
+}
+
+RowFingerprint hash_double(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return hash_word(bits, double_tag);
+}
+
+inline void combine(RowFingerprint &row, const RowFingerprint &cell) {
+  row.low = mix(row.low ^ cell.low) + cell.high;
+  row.high = mix(row.high + cell.high) ^ cell.low;
+}
+
+inline RowFingerprint initial_fingerprint() {
+  return RowFingerprint{0x6a09e667f3bcc909ULL, 0xbb67ae8584caa73bULL};
+}
+
+// Hashes a text cell the way TableBuilder will type it.
+RowFingerprint hash_typed_cell(std::string_view cell) {
+  if (is_missing_token(cell)) {
+    return RowFingerprint{null_marker, ~null_marker};
+  }
+
+  double value = 0.0;
+  if (parse_number(cell, value)) {
+    return hash_double(value);
+  }
+  return hash_bytes(cell);
+}
+
+} // namespace
+
+RowDeduplicator::RowDeduplicator()
+    : exact_verify(false), used(0), row_base(0), next_row(0) {}
+
+void RowDeduplicator::set_key_columns(const std::vector<std::string> &columns) {
+  key_columns = columns;
+}
+
+const std::vector<std::string> &RowDeduplicator::get_key_columns() const {
+  return key_columns;
+}
+
+void RowDeduplicator::set_exact_verify(bool verify) {
+  exact_verify = verify;
+  slot_rows.assign(verify ? slots.size() : 0, 0);
+}
+
+bool RowDeduplicator::get_exact_verify() const { return exact_verify; }
+
+void RowDeduplicator::clear() {
+  std::vector<RowFingerprint>().swap(slots);
+  std::vector<size_t>().swap(slot_rows);
+  used = 0;
+  row_base = 0;
+  next_row = 0;
+}
+
+size_t RowDeduplicator::get_unique_count() const { return used; }
+
+size_t RowDeduplicator::deduplicate(Table &table) {
+  const size_t num_rows = table.get_row_count();
+  if (num_rows == 0 || !resolve_key_columns(table.get_headers())) {
+    return 0;
+  }
+
+  // Hash every dictionary entry once instead of once per row
+  std::vector<std::vector<RowFingerprint>> string_hashes(key_indices.size());
+  for (size_t k = 0; k < key_indices.size(); ++k) {
+    const Column &column = table.get_column(key_indices[k]);
+    if (column.get_type() == ColumnType::STRING) {
+      for (const auto &entry : column.get_dictionary()) {
+        string_hashes[k].push_back(hash_bytes(entry));
+      }
+    }
+  }
+
+  auto rows_equal = [&](size_t left, size_t right) {
+    for (size_t index : key_indices) {
+      const Column &column = table.get_column(index);
+      const bool valid = column.is_valid(left);
+      if (valid != column.is_valid(right)) {
+        return false;
+      }
+      if (!valid) {
+        continue;
+      }
+      switch (column.get_type()) {
+      case ColumnType::INT64:
+        if (column.get_ints()[left] != column.get_ints()[right]) {
+          return false;
+        }
+        break;
+      case ColumnType::FLOAT64:
+        if (std::memcmp(&column.get_doubles()[left],
+                        &column.get_doubles()[right], sizeof(double)) != 0) {
+          return false;
+        }
+        break;
+      case ColumnType::STRING:
+        if (column.get_codes()[left] != column.get_codes()[right]) {
+          return false;
+        }
+        break;
+      }
+    }
+    return true;
+  };
+
+  grow(used + num_rows);
+  row_base = next_row;
+  next_row += num_rows;
+
+  std::vector<size_t> kept_rows;
+  kept_rows.reserve(num_rows);
+  for (size_t row = 0; row < num_rows; ++row) {
+    RowFingerprint fingerprint = initial_fingerprint();
+    for (size_t k = 0; k < key_indices.size(); ++k) {
+      const Column &column = table.get_column(key_indices[k]);
+      if (!column.is_valid(row)) {
+        combine(fingerprint, RowFingerprint{null_marker, ~null_marker});
+        continue;
+      }
+      switch (column.get_type()) {
+      case ColumnType::INT64:
+        combine(fingerprint,
+                hash_word(static_cast<uint64_t>(column.get_ints()[row]),
+                          int_tag));
+        break;
+      case ColumnType::FLOAT64:
+        combine(fingerprint, hash_double(column.get_doubles()[row]));
+        break;
+      case ColumnType::STRING:
+        combine(fingerprint, string_hashes[k][column.get_codes()[row]]);
+        break;
+      }
+    }
+
+    if (insert_fingerprint(fingerprint, row_base + row,
+                           [&](size_t other) { return rows_equal(other, row); })) {
+      kept_rows.push_back(row);
+    }
+  }
+
+  const size_t removed = num_rows - kept_rows.size();
+  if (removed > 0) {
+    table.keep_rows(kept_rows);
+  }
+  return removed;
+}
+
+size_t RowDeduplicator::deduplicate(std::vector<std::vector<std::string>> &data) {
+  if (data.size() <= 1 || !resolve_key_columns(data[0])) {
+    return 0;
+  }
+
+  // Ragged rows are possible here, so a short row hashes its missing key
+  // cells as absent rather than reading past its end
+  const bool whole_row = key_columns.empty();
+  auto rows_equal = [&](size_t left, size_t right) {
+    const auto &a = data[left + 1];
+    const auto &b = data[right + 1];
+    if (whole_row) {
+      return a == b;
+    }
+    for (size_t index : key_indices) {
+      const bool in_a = index < a.size();
+      if (in_a != (index < b.size()) || (in_a && a[index] != b[index])) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const size_t num_rows = data.size() - 1;
+  grow(used + num_rows);
+  row_base = next_row;
+  next_row += num_rows;
+
+  size_t write = 1;
+  for (size_t row = 0; row < num_rows; ++row) {
+    const auto &cells = data[row + 1];
+    RowFingerprint fingerprint = initial_fingerprint();
+    if (whole_row) {
+      combine(fingerprint, hash_word(cells.size(), int_tag));
+      for (const auto &cell : cells) {
+        combine(fingerprint, hash_bytes(cell));
+      }
+    } else {
+      for (size_t index : key_indices) {
+        combine(fingerprint, index < cells.size()
+                                 ? hash_bytes(cells[index])
+                                 : RowFingerprint{absent_marker, ~absent_marker});
+      }
+    }
+
+    // Kept rows are recorded at their compacted position, which is where
+    // a later verification will find them
+    if (insert_fingerprint(fingerprint, row_base + write - 1,
+                           [&](size_t other) { return rows_equal(other, row); })) {
+      if (write != row + 1) {
+        data[write] = std::move(data[row + 1]);
+      }
+      ++write;
+    }
+  }
+
+  const size_t removed = data.size() - write;
+  data.resize(write);
+  return removed;
+}
+
+void RowDeduplicator::set_headers(const std::vector<std::string> &headers) {
+  resolve_key_columns(headers);
+}
+
+bool RowDeduplicator::insert(const std::vector<std::string_view> &cells) {
+  RowFingerprint fingerprint = initial_fingerprint();
+  if (key_columns.empty()) {
+    for (const auto &cell : cells) {
+      combine(fingerprint, hash_typed_cell(cell));
+    }
+  } else {
+    for (size_t index : key_indices) {
+      combine(fingerprint, index < cells.size()
+                               ? hash_typed_cell(cells[index])
+                               : RowFingerprint{absent_marker, ~absent_marker});
+    }
+  }
+
+  grow(used + 1);
+  row_base = next_row + 1;
+  return insert_fingerprint(fingerprint, next_row++,
+                            [](size_t) { return true; });
+}
+
+std::vector<RowFingerprint> RowDeduplicator::get_fingerprints() const {
+  std::vector<RowFingerprint> fingerprints;
+  fingerprints.reserve(used);
+  for (const auto &slot : slots) {
+    if (slot.low != 0 || slot.high != 0) {
+      fingerprints.push_back(slot);
+    }
+  }
+  return fingerprints;
+}
+
+void RowDeduplicator::add_fingerprints(
+    const std::vector<RowFingerprint> &fingerprints) {
+  grow(used + fingerprints.size());
+  for (const auto &fingerprint : fingerprints) {
+    insert_fingerprint(fingerprint, next_row++, [](size_t) { return true; });
+  }
+  row_base = next_row;
+}
+
+bool RowDeduplicator::resolve_key_columns(
+    const std::vector<std::string> &headers) {
+  key_indices.clear();
+  if (key_columns.empty()) {
+    for (size_t i = 0; i < headers.size(); ++i) {
+      key_indices.push_back(i);
+    }
+    return true;
+  }
+
+  for (const auto &name : key_columns) {
+    size_t index = 0;
+    while (index < headers.size() && headers[index] != name) {
+      ++index;
+    }
+    if (index == headers.size()) {
+      std::cerr << "Warning: Deduplication key column '" << name
+                << "' not found" << std::endl;
+      continue;
+    }
+    key_indices.push_back(index);
+  }
+
+  if (key_indices.empty()) {
+    std::cerr << "Warning: No deduplication key columns found, skipping "
+                 "duplicate removal"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void RowDeduplicator::grow(size_t min_entries) {
+  // Keep the load factor at or below 0.7 so probe sequences stay short
+  size_t capacity = slots.empty() ? 1024 : slots.size();
+  while (min_entries * 10 > capacity * 7) {
+    capacity *= 2;
+  }
+  if (capacity == slots.size()) {
+    return;
+  }
+
+  std::vector<RowFingerprint> old_slots(capacity, RowFingerprint{0, 0});
+  std::vector<size_t> old_rows(exact_verify ? capacity : 0, 0);
+  old_slots.swap(slots);
+  old_rows.swap(slot_rows);
+
+  const size_t mask = capacity - 1;
+  for (size_t i = 0; i < old_slots.size(); ++i) {
+    const RowFingerprint &slot = old_slots[i];
+    if (slot.low == 0 && slot.high == 0) {
+      continue;
+    }
+    size_t index = slot.low & mask;
+    while (slots[index].low != 0 || slots[index].high != 0) {
+      index = (index + 1) & mask;
+    }
+    slots[index] = slot;
+    if (exact_verify) {
+      slot_rows[index] = i < old_rows.size() ? old_rows[i] : 0;
+    }
+  }
+}
+
+template <typename Equal>
+bool RowDeduplicator::insert_fingerprint(const RowFingerprint &fingerprint,
+                                         size_t row, const Equal &equal) {
+  RowFingerprint key = fingerprint;
+  if (key.low == 0 && key.high == 0) {
+    key.low = 1;
+  }
+
+  const size_t mask = slots.size() - 1;
+  size_t index = key.low & mask;
+
+  while (true) {
+    RowFingerprint &slot = slots[index];
+    if (slot.low == 0 && slot.high == 0) {
+      slot = key;
+      if (exact_verify) {
+        slot_rows[index] = row;
+      }
+      ++used;
+      return true;
+    }
+    if (slot.low == key.low && slot.high == key.high) {
+      // A fingerprint match from earlier input cannot be checked, and
+      // without verification it is trusted outright
+      if (!exact_verify || slot_rows[index] < row_base ||
+          equal(slot_rows[index] - row_base)) {
+        return false;
+      }
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+} // namespace adapter
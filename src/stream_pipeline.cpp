@@ -0,0 +1,270 @@
+#include "adapter/stream_pipeline.hpp"
+#include "adapter/bounded_queue.hpp"
+#include "adapter/csv_writer.hpp"
+#include "adapter/value_parser.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace adapter {
+
+namespace {
+
+struct ColumnAccumulator {
+  ColumnTypeInference inference;
+  ColumnStatsAccumulator stats;
+};
+
+} // namespace
+
+StreamingPipeline::StreamingPipeline()
+    : delimiter(','), batch_size(default_batch_size), direct_io(false),
+      queue_depth(default_queue_depth), rows_read(0), rows_written(0),
+      batch_count(0), malformed_count(0), duplicates_removed(0),
+      bytes_read(0), bytes_written(0), reader_stalls(0), cleaner_stalls(0) {}
+
+void StreamingPipeline::set_delimiter(char delimiter) {
+  this->delimiter = delimiter;
+}
+
+void StreamingPipeline::set_batch_size(size_t rows) {
+  batch_size = rows == 0 ? 1 : rows;
+}
+
+size_t StreamingPipeline::get_batch_size() const { return batch_size; }
+
+void StreamingPipeline::set_direct_io(bool enabled) { direct_io = enabled; }
+
+void StreamingPipeline::set_queue_depth(size_t batches) {
+  queue_depth = batches;
+}
+
+void StreamingPipeline::set_inference(const InferenceOptions &options) {
+  inference = options;
+}
+
+size_t StreamingPipeline::get_queue_depth() const { return queue_depth; }
+
+bool StreamingPipeline::run(const std::string &input_file,
+                            const std::string &output_file,
+                            DataCleaner &cleaner) {
+  rows_read = 0;
+  rows_written = 0;
+  batch_count = 0;
+  malformed_count = 0;
+  duplicates_removed = 0;
+  bytes_read = 0;
+  bytes_written = 0;
+  reader_stalls = 0;
+  cleaner_stalls = 0;
+  imputed_cells.clear();
+
+  CsvStreamReader reader;
+  if (!reader.open(input_file, delimiter)) {
+    return false;
+  }
+  if (reader.get_headers().empty()) {
+    std::cerr << "Error: File is empty" << std::endl;
+    return false;
+  }
+
+  std::vector<ColumnSchema> schema;
+  std::vector<ColumnStats> stats;
+  RowDeduplicator deduplicator = cleaner.make_deduplicator();
+  deduplicator.set_headers(reader.get_headers());
+  collect_statistics(reader, cleaner, deduplicator, schema, stats);
+
+  const std::vector<std::string> &headers = reader.get_headers();
+  std::vector<MissingValueFill> fills;
+  fills.reserve(stats.size());
+  for (size_t col = 0; col < stats.size(); ++col) {
+    fills.push_back(
+        cleaner.make_missing_value_fill(stats[col], col, headers[col]));
+  }
+
+  CsvWriter writer;
+  writer.set_direct_io(direct_io);
+  if (!writer.open(output_file, delimiter) ||
+      !writer.write_header(reader.get_headers())) {
+    return false;
+  }
+
+  // Second pass: the first one already reported malformed rows
+  if (!reader.rewind()) {
+    return false;
+  }
+  reader.set_report_malformed(false);
+  deduplicator.clear();
+
+  // Reads the next batch, returning false at the end of the input
+  std::vector<std::string_view> cells;
+  auto read_batch = [&](Table &batch) {
+    TableBuilder builder(reader.get_headers());
+    builder.set_schema(schema);
+    builder.set_inference(inference);
+    while (builder.get_row_count() < batch_size && reader.next_row(cells)) {
+      if (deduplicator.insert(cells)) {
+        builder.append_row(cells);
+      } else {
+        ++duplicates_removed;
+      }
+    }
+    if (builder.get_row_count() == 0) {
+      return false;
+    }
+    batch = builder.finish();
+    return true;
+  };
+  auto clean_batch = [&](Table &batch) {
+    cleaner.fill_missing_values(batch, fills, &imputed_cells);
+    cleaner.normalize_formats(batch);
+    ++batch_count;
+  };
+
+  bool written = true;
+  if (queue_depth == 0) {
+    Table batch;
+    while (written && read_batch(batch)) {
+      clean_batch(batch);
+      written = writer.write_table(batch);
+    }
+  } else {
+    // Each stage only touches its own counters; closing a queue stops the
+    // stages on either side of it
+    BoundedQueue<Table> parsed(queue_depth);
+    BoundedQueue<Table> cleaned(queue_depth);
+    std::atomic<bool> write_failed(false);
+    std::thread read_stage([&] {
+      Table batch;
+      while (read_batch(batch) && parsed.push(std::move(batch))) {
+      }
+      parsed.close();
+    });
+    std::thread write_stage([&] {
+      Table batch;
+      while (cleaned.pop(batch)) {
+        if (!writer.write_table(batch)) {
+          write_failed = true;
+          cleaned.close();
+          parsed.close();
+        }
+      }
+    });
+
+    Table batch;
+    while (parsed.pop(batch)) {
+      clean_batch(batch);
+      if (!cleaned.push(std::move(batch))) {
+        break;
+      }
+    }
+    cleaned.close();
+    read_stage.join();
+    write_stage.join();
+    written = !write_failed;
+    reader_stalls = parsed.get_blocked_pushes();
+    cleaner_stalls = cleaned.get_blocked_pushes();
+  }
+  if (!written) {
+    std::cerr << "Error: Failed to write output file" << std::endl;
+    return false;
+  }
+
+  rows_read = reader.get_record_count();
+  rows_written = writer.get_rows_written();
+  malformed_count = reader.get_malformed_count();
+  const bool closed = writer.close();
+  bytes_read = reader.get_bytes_read();
+  bytes_written = writer.get_bytes_written();
+  return closed;
+}
+
+size_t StreamingPipeline::get_rows_read() const { return rows_read; }
+
+size_t StreamingPipeline::get_rows_written() const { return rows_written; }
+
+size_t StreamingPipeline::get_batch_count() const { return batch_count; }
+
+size_t StreamingPipeline::get_malformed_count() const {
+  return malformed_count;
+}
+
+size_t StreamingPipeline::get_duplicates_removed() const {
+  return duplicates_removed;
+}
+
+const std::map<std::string, size_t> &
+StreamingPipeline::get_imputed_cells() const {
+  return imputed_cells;
+}
+
+size_t StreamingPipeline::get_bytes_read() const { return bytes_read; }
+
+size_t StreamingPipeline::get_bytes_written() const { return bytes_written; }
+
+size_t StreamingPipeline::get_reader_stalls() const { return reader_stalls; }
+
+size_t StreamingPipeline::get_cleaner_stalls() const {
+  return cleaner_stalls;
+}
+
+void StreamingPipeline::collect_statistics(
+    CsvStreamReader &reader, const DataCleaner &cleaner,
+    RowDeduplicator &deduplicator, std::vector<ColumnSchema> &schema,
+    std::vector<ColumnStats> &stats) const {
+  const std::vector<std::string> &headers = reader.get_headers();
+  std::vector<ColumnAccumulator> accumulators;
+  accumulators.reserve(headers.size());
+  for (size_t col = 0; col < headers.size(); ++col) {
+    // Medians beyond MedianEstimator::default_exact_limit values are
+    // estimated, so the first pass stays bounded in memory
+    const bool track_median =
+        cleaner.resolve_missing_value_strategy(col, headers[col]) ==
+        MissingValueStrategy::MEDIAN;
+    accumulators.push_back({ColumnTypeInference(),
+                            ColumnStatsAccumulator(track_median)});
+  }
+
+  // Duplicates are dropped before imputation, so they must not count
+  // towards the statistics either
+  std::vector<std::string_view> cells;
+  while (reader.next_row(cells)) {
+    if (!deduplicator.insert(cells)) {
+      continue;
+    }
+
+    for (size_t col = 0; col < headers.size(); ++col) {
+      ColumnAccumulator &accumulator = accumulators[col];
+      const std::string_view cell = cells[col];
+      accumulator.inference.observe(cell);
+
+      double value = 0.0;
+      if (is_missing_token(cell)) {
+        accumulator.stats.add_null();
+      } else if (parse_number(cell, value)) {
+        accumulator.stats.add_value(value);
+      } else {
+        accumulator.stats.add_text();
+      }
+    }
+  }
+
+  schema.clear();
+  stats.clear();
+  for (size_t col = 0; col < headers.size(); ++col) {
+    ColumnAccumulator &accumulator = accumulators[col];
+    ColumnSchema column_schema = accumulator.inference.get_schema();
+    auto fixed = inference.column_kinds.find(headers[col]);
+    if (fixed != inference.column_kinds.end() &&
+        column_kind_storage(fixed->second) != column_schema.type) {
+      column_schema.type = column_kind_storage(fixed->second);
+      column_schema.precision = -1;
+    }
+    ColumnStats column_stats = accumulator.stats.finish();
+    column_stats.numeric = column_schema.type != ColumnType::STRING;
+    schema.push_back(column_schema);
+    stats.push_back(column_stats);
+  }
+}
+
+} // namespace adapter
@@ -0,0 +1,178 @@
+#include "adapter/structural_scanner.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ADAPTER_X86_KERNELS 1
+#endif
+
+namespace adapter {
+
+namespace {
+
+StructuralMasks scan_scalar(const char *data, char delimiter) {
+  StructuralMasks masks{0, 0, 0};
+  for (size_t i = 0; i < StructuralScanner::block_size; ++i) {
+    const uint64_t bit = uint64_t(1) << i;
+    const char c = data[i];
+    if (c == '"') {
+      masks.quotes |= bit;
+    }
+    if (c == delimiter) {
+      masks.delimiters |= bit;
+    }
+    if (c == '\n') {
+      masks.newlines |= bit;
+    }
+  }
+  return masks;
+}
+
+#ifdef ADAPTER_X86_KERNELS
+
+__attribute__((target("sse4.2"))) StructuralMasks scan_sse42(const char *data,
+                                                             char delimiter) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i delim = _mm_set1_epi8(delimiter);
+  const __m128i newline = _mm_set1_epi8('\n');
+
+  StructuralMasks masks{0, 0, 0};
+  for (int lane = 0; lane < 4; ++lane) {
+    const __m128i chunk = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + lane * 16));
+    const int shift = lane * 16;
+    masks.quotes |= static_cast<uint64_t>(static_cast<uint16_t>(
+                        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))))
+                    << shift;
+    masks.delimiters |= static_cast<uint64_t>(static_cast<uint16_t>(
+                            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delim))))
+                        << shift;
+    masks.newlines |= static_cast<uint64_t>(static_cast<uint16_t>(
+                          _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))))
+                      << shift;
+  }
+  return masks;
+}
+
+__attribute__((target("avx2"))) inline uint64_t combine_avx2(__m256i low,
+                                                             __m256i high) {
+  const uint64_t low_bits = static_cast<uint32_t>(_mm256_movemask_epi8(low));
+  const uint64_t high_bits =
+      static_cast<uint32_t>(_mm256_movemask_epi8(high));
+  return low_bits | (high_bits << 32);
+}
+
+__attribute__((target("avx2"))) StructuralMasks scan_avx2(const char *data,
+                                                          char delimiter) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i delim = _mm256_set1_epi8(delimiter);
+  const __m256i newline = _mm256_set1_epi8('\n');
+
+  const __m256i low =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+  const __m256i high =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32));
+
+  StructuralMasks masks;
+  masks.quotes = combine_avx2(_mm256_cmpeq_epi8(low, quote),
+                              _mm256_cmpeq_epi8(high, quote));
+  masks.delimiters = combine_avx2(_mm256_cmpeq_epi8(low, delim),
+                                  _mm256_cmpeq_epi8(high, delim));
+  masks.newlines = combine_avx2(_mm256_cmpeq_epi8(low, newline),
+                                _mm256_cmpeq_epi8(high, newline));
+  return masks;
+}
+
+#endif // ADAPTER_X86_KERNELS
+
+} // namespace
+
+StructuralScanner::StructuralScanner(char delimiter)
+    : StructuralScanner(delimiter, detect_kernel()) {}
+
+StructuralScanner::StructuralScanner(char delimiter, ScannerKernel kernel)
+    : delimiter(delimiter), kernel(kernel), scan_function(scan_scalar) {
+  if (!is_kernel_supported(kernel)) {
+    this->kernel = ScannerKernel::SCALAR;
+  }
+
+#ifdef ADAPTER_X86_KERNELS
+  if (this->kernel == ScannerKernel::AVX2) {
+    scan_function = scan_avx2;
+  } else if (this->kernel == ScannerKernel::SSE42) {
+    scan_function = scan_sse42;
+  }
+#endif
+}
+
+StructuralMasks StructuralScanner::scan_block(const char *data) const {
+  return scan_function(data, delimiter);
+}
+
+StructuralMasks StructuralScanner::scan_partial_block(const char *data,
+                                                      size_t length) const {
+  // Pad with a byte that is never structural for this delimiter
+  char block[block_size];
+  std::memset(block, delimiter == ' ' ? 'x' : ' ', sizeof(block));
+  std::memcpy(block, data, length < block_size ? length : block_size);
+  return scan_function(block, delimiter);
+}
+
+ScannerKernel StructuralScanner::get_kernel() const { return kernel; }
+
+char StructuralScanner::get_delimiter() const { return delimiter; }
+
+ScannerKernel StructuralScanner::detect_kernel() {
+  // ADAPTER_SIMD=scalar|sse42|avx2 caps the kernel, e.g. for testing
+  const char *requested = std::getenv("ADAPTER_SIMD");
+  if (requested != nullptr) {
+    std::string name(requested);
+    if (name == "scalar") {
+      return ScannerKernel::SCALAR;
+    }
+    if (name == "sse42" && is_kernel_supported(ScannerKernel::SSE42)) {
+      return ScannerKernel::SSE42;
+    }
+  }
+
+  if (is_kernel_supported(ScannerKernel::AVX2)) {
+    return ScannerKernel::AVX2;
+  }
+  if (is_kernel_supported(ScannerKernel::SSE42)) {
+    return ScannerKernel::SSE42;
+  }
+  return ScannerKernel::SCALAR;
+}
+
+bool StructuralScanner::is_kernel_supported(ScannerKernel kernel) {
+  switch (kernel) {
+  case ScannerKernel::SCALAR:
+    return true;
+#ifdef ADAPTER_X86_KERNELS
+  case ScannerKernel::SSE42:
+    return __builtin_cpu_supports("sse4.2");
+  case ScannerKernel::AVX2:
+    return __builtin_cpu_supports("avx2");
+#else
+  default:
+    return false;
+#endif
+  }
+  return false;
+}
+
+const char *StructuralScanner::kernel_name(ScannerKernel kernel) {
+  switch (kernel) {
+  case ScannerKernel::SCALAR:
+    return "scalar";
+  case ScannerKernel::SSE42:
+    return "sse4.2";
+  case ScannerKernel::AVX2:
+    return "avx2";
+  }
+  return "unknown";
+}
+
+} // namespace adapter
@@ -0,0 +1,856 @@
+#include "adapter/table.hpp"
+#include "adapter/thread_pool.hpp"
+#include "adapter/value_parser.hpp"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+namespace adapter {
+
+namespace {
+
+const std::string empty_string;
+
+// Writes value into each of the first `length` slots whose validity bit is
+// clear and sets those bits.
+template <typename T>
+void fill_null_slots(std::vector<uint64_t> &validity, size_t length,
+                     T *values, T value) {
+  for (size_t word = 0; word < validity.size(); ++word) {
+    const size_t base = word * 64;
+    uint64_t missing = ~validity[word];
+    if (length - base < 64) {
+      missing &= (uint64_t(1) << (length - base)) - 1;
+    }
+    validity[word] |= missing;
+    while (missing != 0) {
+      values[base + static_cast<size_t>(__builtin_ctzll(missing))] = value;
+      missing &= missing - 1;
+    }
+  }
+}
+
+// Text columns hold timestamps when every distinct value is one, and are
+// categorical when at most half their cells are distinct.
+ColumnKind classify_text(const Column &column) {
+  const std::vector<std::string> &dictionary = column.get_dictionary();
+  const size_t valid = column.size() - column.get_null_count();
+  if (valid == 0) {
+    return ColumnKind::TEXT;
+  }
+
+  bool timestamps = true;
+  for (const std::string &value : dictionary) {
+    double seconds = 0.0;
+    if (!parse_iso_timestamp(value, seconds)) {
+      timestamps = false;
+      break;
+    }
+  }
+  if (timestamps) {
+    return ColumnKind::TIMESTAMP;
+  }
+  return dictionary.size() * 2 <= valid ? ColumnKind::CATEGORICAL
+                                        : ColumnKind::TEXT;
+}
+
+// Infers from the leading sample_rows cells, or from sample_fraction of
+// them at an even stride. Sets every_cell when the sample was the whole
+// column.
+ColumnSchema infer_schema(const std::vector<std::string_view> &cells,
+                          const InferenceOptions &options, bool &every_cell,
+                          size_t &observed) {
+  size_t stride = 1;
+  size_t limit = cells.size();
+  if (options.sample_fraction > 0.0) {
+    if (options.sample_fraction < 1.0) {
+      stride = static_cast<size_t>(1.0 / options.sample_fraction + 0.5);
+    }
+  } else if (options.sample_rows > 0 && options.sample_rows < limit) {
+    limit = options.sample_rows;
+  }
+  every_cell = stride == 1 && limit == cells.size();
+
+  ColumnTypeInference inference;
+  observed = 0;
+  for (size_t row = 0; row < limit; row += stride) {
+    inference.observe(cells[row]);
+    observed += is_missing_token(cells[row]) ? 0 : 1;
+  }
+  return inference.get_schema();
+}
+
+// Converts every cell to the schema's type. A cell that does not parse is
+// stored as null when strict; otherwise it stops the conversion and false
+// is returned. derive_precision works a FLOAT64 column's precision out of
+// its cells rather than taking the schema's.
+bool convert_cells(const std::vector<std::string_view> &cells,
+                   const ColumnSchema &schema, bool strict,
+                   bool derive_precision, Column &column) {
+  const ColumnType type = schema.type;
+  column.reserve(cells.size());
+  if (type == ColumnType::FLOAT64) {
+    column.set_precision(schema.precision);
+  }
+
+  bool seen_number = false;
+  bool uniform_precision = true;
+  int precision = -1;
+  NumberFormat format;
+  std::string text;
+  for (std::string_view cell : cells) {
+    if (is_missing_token(cell)) {
+      column.append_null();
+      continue;
+    }
+
+    if (type == ColumnType::INT64) {
+      int64_t value = 0;
+      if (parse_integer(cell, value)) {
+        column.append_int(value);
+      } else if (strict) {
+        column.append_null();
+      } else {
+        return false;
+      }
+    } else if (type == ColumnType::FLOAT64) {
+      double value = 0.0;
+      if (parse_number(cell, value, derive_precision ? &format : nullptr)) {
+        column.append_double(value);
+      } else if (strict) {
+        column.append_null();
+        continue;
+      } else {
+        return false;
+      }
+
+      // Same rule as ColumnTypeInference
+      if (!derive_precision || !uniform_precision) {
+        continue;
+      }
+      if (format.has_exponent) {
+        uniform_precision = false;
+      } else if (!seen_number) {
+        precision = format.fraction_digits;
+      } else if (precision != format.fraction_digits) {
+        uniform_precision = false;
+      }
+      seen_number = true;
+    } else {
+      text.assign(cell.data(), cell.size());
+      column.append_string(text);
+    }
+  }
+
+  if (type == ColumnType::FLOAT64 && derive_precision) {
+    column.set_precision(seen_number && uniform_precision ? precision : -1);
+  }
+  return true;
+}
+
+Column build_column(const std::string &name,
+                    std::vector<std::string_view> &cells,
+                    const ColumnSchema *schema,
+                    const InferenceOptions &options) {
+  auto fixed = options.column_kinds.find(name);
+  const bool has_kind = fixed != options.column_kinds.end();
+
+  ColumnSchema column_schema;
+  bool strict = true;
+  bool derive_precision = false;
+  if (has_kind) {
+    column_schema.type = column_kind_storage(fixed->second);
+    derive_precision = column_schema.type == ColumnType::FLOAT64;
+    if (schema != nullptr && schema->type == column_schema.type) {
+      column_schema = *schema;
+      derive_precision = false;
+    }
+  } else if (schema != nullptr) {
+    column_schema = *schema;
+  } else {
+    bool every_cell = false;
+    size_t observed = 0;
+    column_schema = infer_schema(cells, options, every_cell, observed);
+    // A sample with nothing in it says nothing about the rest
+    if (!every_cell && observed == 0) {
+      ColumnTypeInference inference;
+      for (std::string_view cell : cells) {
+        inference.observe(cell);
+      }
+      column_schema = inference.get_schema();
+      every_cell = true;
+    }
+    strict = every_cell;
+    derive_precision = !every_cell;
+  }
+
+  Column column(name, column_schema.type);
+  if (!convert_cells(cells, column_schema, strict, derive_precision,
+                     column)) {
+    // The sample missed a cell that does not fit
+    ColumnTypeInference inference;
+    for (std::string_view cell : cells) {
+      inference.observe(cell);
+    }
+    column_schema = inference.get_schema();
+    column = Column(name, column_schema.type);
+    convert_cells(cells, column_schema, true, false, column);
+  }
+
+  if (has_kind) {
+    column.set_kind(fixed->second);
+  } else if (column.get_type() == ColumnType::STRING) {
+    column.set_kind(classify_text(column));
+  }
+
+  std::vector<std::string_view>().swap(cells);
+  return column;
+}
+
+} // namespace
+
+bool is_missing_token(std::string_view value) {
+  return value.empty() || value == "NaN" || value == "nan" || value == "NA" ||
+         value == "NULL";
+}
+
+const char *column_kind_name(ColumnKind kind) {
+  switch (kind) {
+  case ColumnKind::INT:
+    return "int";
+  case ColumnKind::FLOAT:
+    return "float";
+  case ColumnKind::TIMESTAMP:
+    return "timestamp";
+  case ColumnKind::CATEGORICAL:
+    return "categorical";
+  case ColumnKind::TEXT:
+    return "text";
+  }
+  return "text";
+}
+
+bool parse_column_kind(std::string_view name, ColumnKind &kind) {
+  for (ColumnKind candidate :
+       {ColumnKind::INT, ColumnKind::FLOAT, ColumnKind::TIMESTAMP,
+        ColumnKind::CATEGORICAL, ColumnKind::TEXT}) {
+    if (name == column_kind_name(candidate)) {
+      kind = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+ColumnType column_kind_storage(ColumnKind kind) {
+  switch (kind) {
+  case ColumnKind::INT:
+    return ColumnType::INT64;
+  case ColumnKind::FLOAT:
+    return ColumnType::FLOAT64;
+  default:
+    return ColumnType::STRING;
+  }
+}
+
+ColumnTypeInference::ColumnTypeInference()
+    : all_int(true), all_numeric(true), uniform_precision(true),
+      precision(-1), non_missing(0) {}
+
+void ColumnTypeInference::observe(std::string_view cell) {
+  if (!all_numeric || is_missing_token(cell)) {
+    return;
+  }
+  ++non_missing;
+
+  NumberFormat format;
+  if (!classify_number(cell, &format)) {
+    all_numeric = false;
+    return;
+  }
+
+  if (format.has_point || format.has_exponent) {
+    all_int = false;
+  } else {
+    int64_t ignored = 0;
+    if (!parse_integer(cell, ignored)) {
+      all_int = false;
+    }
+  }
+
+  // Scientific notation has no fixed number of decimals to preserve
+  if (format.has_exponent) {
+    uniform_precision = false;
+  } else if (non_missing == 1) {
+    precision = format.fraction_digits;
+  } else if (precision != format.fraction_digits) {
+    uniform_precision = false;
+  }
+}
+
+ColumnSchema ColumnTypeInference::get_schema() const {
+  ColumnSchema schema;
+  if (all_numeric && non_missing > 0) {
+    schema.type = all_int ? ColumnType::INT64 : ColumnType::FLOAT64;
+    if (schema.type == ColumnType::FLOAT64 && uniform_precision) {
+      schema.precision = precision;
+    }
+  }
+  return schema;
+}
+
+Column::Column() : Column("", ColumnType::STRING) {}
+
+Column::Column(const std::string &name, ColumnType type)
+    : name(name), type(type),
+      kind(type == ColumnType::INT64     ? ColumnKind::INT
+           : type == ColumnType::FLOAT64 ? ColumnKind::FLOAT
+                                         : ColumnKind::TEXT),
+      length(0), null_count(0), precision(-1) {}
+
+const std::string &Column::get_name() const { return name; }
+
+void Column::set_name(const std::string &name) { this->name = name; }
+
+ColumnType Column::get_type() const { return type; }
+
+bool Column::is_numeric() const {
+  return type == ColumnType::INT64 || type == ColumnType::FLOAT64;
+}
+
+ColumnKind Column::get_kind() const { return kind; }
+
+void Column::set_kind(ColumnKind kind) { this->kind = kind; }
+
+size_t Column::size() const { return length; }
+
+size_t Column::get_null_count() const { return null_count; }
+
+int Column::get_precision() const { return precision; }
+
+void Column::set_precision(int precision) { this->precision = precision; }
+
+bool Column::is_valid(size_t row) const {
+  return (validity[row / 64] >> (row % 64)) & 1u;
+}
+
+int64_t Column::get_int(size_t row) const {
+  if (type == ColumnType::FLOAT64) {
+    return static_cast<int64_t>(double_values[row]);
+  }
+  return type == ColumnType::INT64 ? int_values[row] : 0;
+}
+
+double Column::get_double(size_t row) const {
+  if (type == ColumnType::INT64) {
+    return static_cast<double>(int_values[row]);
+  }
+  return type == ColumnType::FLOAT64 ? double_values[row] : 0.0;
+}
+
+const std::string &Column::get_string(size_t row) const {
+  if (type != ColumnType::STRING || !is_valid(row)) {
+    return empty_string;
+  }
+  return dictionary[string_codes[row]];
+}
+
+std::string Column::to_string(size_t row) const {
+  if (!is_valid(row)) {
+    return "";
+  }
+
+  char buffer[64];
+  std::to_chars_result result{buffer, std::errc()};
+  switch (type) {
+  case ColumnType::INT64:
+    result = std::to_chars(buffer, buffer + sizeof(buffer), int_values[row]);
+    break;
+  case ColumnType::FLOAT64:
+    if (precision >= 0) {
+      result = std::to_chars(buffer, buffer + sizeof(buffer),
+                             double_values[row], std::chars_format::fixed,
+                             precision);
+    } else {
+      result =
+          std::to_chars(buffer, buffer + sizeof(buffer), double_values[row]);
+    }
+    break;
+  case ColumnType::STRING:
+    return dictionary[string_codes[row]];
+  }
+
+  if (result.ec != std::errc()) {
+    return "";
+  }
+  return std::string(buffer, result.ptr);
+}
+
+void Column::reserve(size_t rows) {
+  validity.reserve((rows + 63) / 64);
+  switch (type) {
+  case ColumnType::INT64:
+    int_values.reserve(rows);
+    break;
+  case ColumnType::FLOAT64:
+    double_values.reserve(rows);
+    break;
+  case ColumnType::STRING:
+    string_codes.reserve(rows);
+    break;
+  }
+}
+
+void Column::append_null() {
+  switch (type) {
+  case ColumnType::INT64:
+    int_values.push_back(0);
+    break;
+  case ColumnType::FLOAT64:
+    double_values.push_back(0.0);
+    break;
+  case ColumnType::STRING:
+    string_codes.push_back(0);
+    break;
+  }
+  push_validity(false);
+}
+
+void Column::append_int(int64_t value) {
+  if (type == ColumnType::FLOAT64) {
+    append_double(static_cast<double>(value));
+    return;
+  }
+  if (type == ColumnType::STRING) {
+    append_string(std::to_string(value));
+    return;
+  }
+  int_values.push_back(value);
+  push_validity(true);
+}
+
+void Column::append_double(double value) {
+  if (type == ColumnType::INT64) {
+    append_int(static_cast<int64_t>(value));
+    return;
+  }
+  if (type == ColumnType::STRING) {
+    append_string(std::to_string(value));
+    return;
+  }
+  double_values.push_back(value);
+  push_validity(true);
+}
+
+void Column::append_string(const std::string &value) {
+  if (type != ColumnType::STRING) {
+    std::cerr << "Error: Cannot append text to numeric column '" << name
+              << "'" << std::endl;
+    append_null();
+    return;
+  }
+  string_codes.push_back(intern(value));
+  push_validity(true);
+}
+
+void Column::set_null(size_t row) { set_validity(row, false); }
+
+void Column::set_int(size_t row, int64_t value) {
+  if (type == ColumnType::FLOAT64) {
+    set_double(row, static_cast<double>(value));
+    return;
+  }
+  if (type == ColumnType::STRING) {
+    set_string(row, std::to_string(value));
+    return;
+  }
+  int_values[row] = value;
+  set_validity(row, true);
+}
+
+void Column::set_double(size_t row, double value) {
+  if (type == ColumnType::INT64) {
+    set_int(row, static_cast<int64_t>(value));
+    return;
+  }
+  if (type == ColumnType::STRING) {
+    set_string(row, std::to_string(value));
+    return;
+  }
+  double_values[row] = value;
+  set_validity(row, true);
+}
+
+void Column::set_string(size_t row, const std::string &value) {
+  if (type != ColumnType::STRING) {
+    std::cerr << "Error: Cannot store text in numeric column '" << name << "'"
+              << std::endl;
+    return;
+  }
+  string_codes[row] = intern(value);
+  set_validity(row, true);
+}
+
+void Column::fill_nulls(double value) {
+  if (null_count == 0) {
+    return;
+  }
+  switch (type) {
+  case ColumnType::INT64:
+    fill_null_slots(validity, length, int_values.data(),
+                    static_cast<int64_t>(value));
+    break;
+  case ColumnType::FLOAT64:
+    fill_null_slots(validity, length, double_values.data(), value);
+    break;
+  case ColumnType::STRING:
+    fill_nulls(std::to_string(value));
+    return;
+  }
+  null_count = 0;
+}
+
+void Column::fill_nulls(const std::string &value) {
+  if (null_count == 0) {
+    return;
+  }
+  if (type != ColumnType::STRING) {
+    std::cerr << "Error: Cannot store text in numeric column '" << name << "'"
+              << std::endl;
+    return;
+  }
+  fill_null_slots(validity, length, string_codes.data(), intern(value));
+  null_count = 0;
+}
+
+void Column::convert_to_double() {
+  if (type != ColumnType::INT64) {
+    return;
+  }
+
+  double_values.resize(int_values.size());
+  for (size_t i = 0; i < int_values.size(); ++i) {
+    double_values[i] = static_cast<double>(int_values[i]);
+  }
+  std::vector<int64_t>().swap(int_values);
+  type = ColumnType::FLOAT64;
+  kind = ColumnKind::FLOAT;
+  precision = -1;
+}
+
+void Column::keep_rows(const std::vector<size_t> &rows) {
+  std::vector<uint64_t> kept_validity((rows.size() + 63) / 64, 0);
+  size_t kept_nulls = 0;
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (is_valid(rows[i])) {
+      kept_validity[i / 64] |= uint64_t(1) << (i % 64);
+    } else {
+      ++kept_nulls;
+    }
+  }
+
+  switch (type) {
+  case ColumnType::INT64:
+    for (size_t i = 0; i < rows.size(); ++i) {
+      int_values[i] = int_values[rows[i]];
+    }
+    int_values.resize(rows.size());
+    break;
+  case ColumnType::FLOAT64:
+    for (size_t i = 0; i < rows.size(); ++i) {
+      double_values[i] = double_values[rows[i]];
+    }
+    double_values.resize(rows.size());
+    break;
+  case ColumnType::STRING:
+    for (size_t i = 0; i < rows.size(); ++i) {
+      string_codes[i] = string_codes[rows[i]];
+    }
+    string_codes.resize(rows.size());
+    break;
+  }
+
+  validity = std::move(kept_validity);
+  null_count = kept_nulls;
+  length = rows.size();
+}
+
+std::vector<int64_t> &Column::get_ints() { return int_values; }
+
+const std::vector<int64_t> &Column::get_ints() const { return int_values; }
+
+std::vector<double> &Column::get_doubles() { return double_values; }
+
+const std::vector<double> &Column::get_doubles() const {
+  return double_values;
+}
+
+const std::vector<uint32_t> &Column::get_codes() const {
+  return string_codes;
+}
+
+const std::vector<std::string> &Column::get_dictionary() const {
+  return dictionary;
+}
+
+const std::vector<uint64_t> &Column::get_validity() const { return validity; }
+
+bool Column::adopt_buffers(size_t rows, ColumnBuffers buffers) {
+  const size_t type_rows = type == ColumnType::INT64    ? buffers.ints.size()
+                           : type == ColumnType::FLOAT64 ? buffers.doubles.size()
+                                                         : buffers.codes.size();
+  bool valid = buffers.validity.size() == (rows + 63) / 64 && type_rows == rows;
+  size_t valid_rows = 0;
+  for (size_t row = 0; valid && row < rows; ++row) {
+    if ((buffers.validity[row / 64] >> (row % 64)) & 1u) {
+      ++valid_rows;
+      if (type == ColumnType::STRING &&
+          buffers.codes[row] >= buffers.dictionary.size()) {
+        valid = false;
+      }
+    }
+  }
+
+  int_values.clear();
+  double_values.clear();
+  string_codes.clear();
+  dictionary.clear();
+  dictionary_index.clear();
+  validity.clear();
+  length = 0;
+  null_count = 0;
+  if (!valid) {
+    return false;
+  }
+
+  validity = std::move(buffers.validity);
+  switch (type) {
+  case ColumnType::INT64:
+    int_values = std::move(buffers.ints);
+    break;
+  case ColumnType::FLOAT64:
+    double_values = std::move(buffers.doubles);
+    break;
+  case ColumnType::STRING:
+    string_codes = std::move(buffers.codes);
+    dictionary = std::move(buffers.dictionary);
+    dictionary_index.reserve(dictionary.size());
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+      dictionary_index.emplace(dictionary[i], static_cast<uint32_t>(i));
+    }
+    break;
+  }
+  length = rows;
+  null_count = rows - valid_rows;
+  if (type == ColumnType::STRING) {
+    kind = classify_text(*this);
+  }
+  return true;
+}
+
+Span<const int64_t> Column::get_int_span() const { return int_values; }
+
+Span<const double> Column::get_double_span() const { return double_values; }
+
+Span<const uint32_t> Column::get_code_span() const { return string_codes; }
+
+void Column::push_validity(bool valid) {
+  if (length % 64 == 0) {
+    validity.push_back(0);
+  }
+  if (valid) {
+    validity.back() |= uint64_t(1) << (length % 64);
+  } else {
+    ++null_count;
+  }
+  ++length;
+}
+
+void Column::set_validity(size_t row, bool valid) {
+  const uint64_t mask = uint64_t(1) << (row % 64);
+  const bool was_valid = validity[row / 64] & mask;
+  if (valid && !was_valid) {
+    validity[row / 64] |= mask;
+    --null_count;
+  } else if (!valid && was_valid) {
+    validity[row / 64] &= ~mask;
+    ++null_count;
+  }
+}
+
+uint32_t Column::intern(const std::string &value) {
+  auto it = dictionary_index.find(value);
+  if (it != dictionary_index.end()) {
+    return it->second;
+  }
+
+  uint32_t code = static_cast<uint32_t>(dictionary.size());
+  dictionary.push_back(value);
+  dictionary_index.emplace(value, code);
+  return code;
+}
+
+Table::Table() : row_count(0) {}
+
+Table Table::from_rows(const std::vector<std::string> &headers,
+                       const std::vector<std::vector<std::string>> &rows) {
+  TableBuilder builder(headers);
+  for (const auto &row : rows) {
+    if (row.size() == headers.size()) {
+      builder.append_row(row);
+    }
+  }
+  return builder.finish();
+}
+
+std::vector<std::vector<std::string>> Table::to_rows() const {
+  std::vector<std::vector<std::string>> rows(
+      row_count, std::vector<std::string>(columns.size()));
+
+  for (size_t col = 0; col < columns.size(); ++col) {
+    for (size_t row = 0; row < row_count; ++row) {
+      rows[row][col] = columns[col].to_string(row);
+    }
+  }
+
+  return rows;
+}
+
+std::vector<std::string> Table::get_headers() const {
+  std::vector<std::string> headers;
+  headers.reserve(columns.size());
+  for (const auto &column : columns) {
+    headers.push_back(column.get_name());
+  }
+  return headers;
+}
+
+size_t Table::get_row_count() const { return row_count; }
+
+size_t Table::get_column_count() const { return columns.size(); }
+
+bool Table::empty() const { return columns.empty(); }
+
+size_t Table::find_column(const std::string &name) const {
+  auto it = column_indices.find(name);
+  return (it != column_indices.end()) ? it->second : npos;
+}
+
+Column &Table::get_column(size_t index) { return columns[index]; }
+
+const Column &Table::get_column(size_t index) const { return columns[index]; }
+
+bool Table::add_column(Column column) {
+  if (!columns.empty() && column.size() != row_count) {
+    std::cerr << "Error: Column '" << column.get_name() << "' has "
+              << column.size() << " rows (expected " << row_count << ")"
+              << std::endl;
+    return false;
+  }
+
+  row_count = column.size();
+  column_indices[column.get_name()] = columns.size();
+  columns.push_back(std::move(column));
+  return true;
+}
+
+void Table::keep_rows(const std::vector<size_t> &rows) {
+  for (auto &column : columns) {
+    column.keep_rows(rows);
+  }
+  row_count = rows.size();
+}
+
+void Table::clear() {
+  columns.clear();
+  column_indices.clear();
+  row_count = 0;
+}
+
+TableBuilder::TableBuilder() : row_count(0) {}
+
+TableBuilder::TableBuilder(const std::vector<std::string> &headers)
+    : headers(headers), cells(headers.size()), row_count(0) {}
+
+void TableBuilder::append_row(std::vector<std::string> row) {
+  for (size_t col = 0; col < cells.size() && col < row.size(); ++col) {
+    cells[col].push_back(arena.store(row[col]));
+  }
+  ++row_count;
+}
+
+void TableBuilder::append_row(const std::vector<std::string_view> &row) {
+  for (size_t col = 0; col < cells.size() && col < row.size(); ++col) {
+    cells[col].push_back(arena.store(row[col]));
+  }
+  ++row_count;
+}
+
+void TableBuilder::append_rows(TableBuilder &&other) {
+  for (size_t col = 0; col < cells.size() && col < other.cells.size(); ++col) {
+    if (cells[col].empty()) {
+      cells[col] = std::move(other.cells[col]);
+    } else {
+      cells[col].insert(cells[col].end(), other.cells[col].begin(),
+                        other.cells[col].end());
+    }
+    std::vector<std::string_view>().swap(other.cells[col]);
+  }
+  arena.absorb(std::move(other.arena));
+  row_count += other.row_count;
+  other.row_count = 0;
+}
+
+size_t TableBuilder::get_row_count() const { return row_count; }
+
+size_t TableBuilder::get_cell_bytes() const { return arena.get_bytes_used(); }
+
+void TableBuilder::reset(const std::vector<std::string> &headers) {
+  this->headers = headers;
+  cells.assign(headers.size(), std::vector<std::string_view>());
+  arena.reset();
+  schema.clear();
+  row_count = 0;
+}
+
+void TableBuilder::set_schema(const std::vector<ColumnSchema> &schema) {
+  this->schema = schema;
+}
+
+void TableBuilder::set_inference(const InferenceOptions &options) {
+  inference = options;
+}
+
+Table TableBuilder::finish(ThreadPool *pool) {
+  std::vector<Column> columns(headers.size());
+  auto build = [this, &columns](size_t col) {
+    const ColumnSchema *column_schema =
+        col < schema.size() ? &schema[col] : nullptr;
+    columns[col] =
+        build_column(headers[col], cells[col], column_schema, inference);
+  };
+
+  if (pool != nullptr) {
+    pool->parallel_for(headers.size(), build);
+  } else {
+    for (size_t col = 0; col < headers.size(); ++col) {
+      build(col);
+    }
+  }
+
+  Table table;
+  for (auto &column : columns) {
+    table.add_column(std::move(column));
+  }
+
+  // Every cell's text goes with the arena in one step
+  headers.clear();
+  cells.clear();
+  arena.reset();
+  schema.clear();
+  row_count = 0;
+  return table;
+}
+
+} // namespace adapter
@@ -0,0 +1,479 @@
+#include "adapter/table_snapshot.hpp"
+#include "adapter/mapped_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef ADAPTER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace adapter {
+
+namespace {
+
+const char snapshot_magic[8] = {'A', 'D', 'P', 'T', 'S', 'N', 'A', 'P'};
+constexpr uint32_t snapshot_version = 1;
+constexpr size_t snapshot_alignment = 64;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t compression;
+  uint64_t source_size;
+  int64_t source_mtime_ns;
+  uint64_t source_hash;
+  uint64_t row_count;
+  uint32_t column_count;
+  char delimiter;
+  char reserved[11];
+};
+static_assert(sizeof(SnapshotHeader) == snapshot_alignment,
+              "snapshot header must fill one aligned block");
+
+struct ColumnHeader {
+  uint32_t name_length;
+  uint32_t type;
+  int32_t precision;
+  uint32_t reserved;
+};
+
+// Stored arrays are preceded by their sizes and start on an aligned offset
+struct BufferHeader {
+  uint64_t raw_size;
+  uint64_t stored_size;
+};
+
+inline uint64_t mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+uint64_t hash_bytes(const char *data, size_t size, uint64_t hash) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    hash = mix(hash ^ word) + 0x9e3779b97f4a7c15ULL;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, data + i, size - i);
+  return mix(hash ^ tail ^ (static_cast<uint64_t>(size - i) << 56));
+}
+
+bool read_at(int fd, char *buffer, size_t size, off_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    const ssize_t count =
+        ::pread(fd, buffer + done, size - done, offset + static_cast<off_t>(done));
+    if (count <= 0) {
+      return false;
+    }
+    done += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+bool same_source(const SnapshotSource &a, const SnapshotSource &b) {
+  return a.size == b.size && a.mtime_ns == b.mtime_ns && a.hash == b.hash &&
+         a.delimiter == b.delimiter;
+}
+
+class SnapshotFileWriter {
+public:
+  SnapshotFileWriter(const std::string &path, SnapshotCompression compression)
+      : out(path, std::ios::binary | std::ios::trunc), offset(0),
+        compression(compression) {}
+
+  bool good() const { return out.good(); }
+
+  void write(const void *data, size_t size) {
+    out.write(static_cast<const char *>(data),
+              static_cast<std::streamsize>(size));
+    offset += size;
+  }
+
+  void align() {
+    static const char zeros[snapshot_alignment] = {};
+    const size_t padding =
+        (snapshot_alignment - offset % snapshot_alignment) % snapshot_alignment;
+    write(zeros, padding);
+  }
+
+  void write_buffer(const void *data, size_t size) {
+    BufferHeader header = {size, size};
+#ifdef ADAPTER_HAVE_ZLIB
+    if (compression == SnapshotCompression::ZLIB && size > 0) {
+      uLongf stored = compressBound(static_cast<uLong>(size));
+      scratch.resize(stored);
+      if (compress2(reinterpret_cast<Bytef *>(scratch.data()), &stored,
+                    static_cast<const Bytef *>(data), static_cast<uLong>(size),
+                    Z_BEST_SPEED) == Z_OK) {
+        header.stored_size = stored;
+        write(&header, sizeof(header));
+        align();
+        write(scratch.data(), stored);
+        return;
+      }
+      out.setstate(std::ios::failbit);
+      return;
+    }
+#endif
+    write(&header, sizeof(header));
+    align();
+    write(data, size);
+  }
+
+private:
+  std::ofstream out;
+  uint64_t offset;
+  SnapshotCompression compression;
+  std::vector<char> scratch;
+};
+
+class SnapshotFileReader {
+public:
+  SnapshotFileReader(const MappedFile &file, SnapshotCompression compression)
+      : data(file.data()), size(file.size()), offset(0),
+        compression(compression) {}
+
+  bool read(void *destination, size_t count) {
+    if (count > size - offset) {
+      return false;
+    }
+    std::memcpy(destination, data + offset, count);
+    offset += count;
+    return true;
+  }
+
+  bool align() {
+    const size_t padding =
+        (snapshot_alignment - offset % snapshot_alignment) % snapshot_alignment;
+    if (padding > size - offset) {
+      return false;
+    }
+    offset += padding;
+    return true;
+  }
+
+  template <typename T> bool read_buffer(std::vector<T> &values) {
+    BufferHeader header;
+    if (!read(&header, sizeof(header)) || !align() ||
+        header.raw_size % sizeof(T) != 0 ||
+        header.stored_size > size - offset) {
+      return false;
+    }
+
+    values.resize(header.raw_size / sizeof(T));
+    const char *stored = data + offset;
+    offset += header.stored_size;
+    if (compression == SnapshotCompression::NONE) {
+      if (header.stored_size != header.raw_size) {
+        return false;
+      }
+      std::memcpy(values.data(), stored, header.raw_size);
+      return true;
+    }
+#ifdef ADAPTER_HAVE_ZLIB
+    if (header.raw_size == 0) {
+      return header.stored_size == 0;
+    }
+    uLongf raw = static_cast<uLongf>(header.raw_size);
+    return uncompress(reinterpret_cast<Bytef *>(values.data()), &raw,
+                      reinterpret_cast<const Bytef *>(stored),
+                      static_cast<uLong>(header.stored_size)) == Z_OK &&
+           raw == header.raw_size;
+#else
+    return false;
+#endif
+  }
+
+  bool read_name(size_t length, std::string &name) {
+    if (length > size - offset) {
+      return false;
+    }
+    name.assign(data + offset, length);
+    offset += length;
+    return align();
+  }
+
+private:
+  const char *data;
+  size_t size;
+  size_t offset;
+  SnapshotCompression compression;
+};
+
+// Dictionary entries are stored back to back, each behind its length
+std::vector<char> encode_dictionary(const std::vector<std::string> &entries) {
+  size_t total = 0;
+  for (const auto &entry : entries) {
+    total += sizeof(uint32_t) + entry.size();
+  }
+  std::vector<char> blob(total);
+  char *cursor = blob.data();
+  for (const auto &entry : entries) {
+    const uint32_t length = static_cast<uint32_t>(entry.size());
+    std::memcpy(cursor, &length, sizeof(length));
+    std::memcpy(cursor + sizeof(length), entry.data(), entry.size());
+    cursor += sizeof(length) + entry.size();
+  }
+  return blob;
+}
+
+bool decode_dictionary(const std::vector<char> &blob,
+                       std::vector<std::string> &entries) {
+  size_t position = 0;
+  while (position < blob.size()) {
+    uint32_t length = 0;
+    if (blob.size() - position < sizeof(length)) {
+      return false;
+    }
+    std::memcpy(&length, blob.data() + position, sizeof(length));
+    position += sizeof(length);
+    if (length > blob.size() - position) {
+      return false;
+    }
+    entries.emplace_back(blob.data() + position, length);
+    position += length;
+  }
+  return true;
+}
+
+bool read_header(const MappedFile &file, SnapshotHeader &header) {
+  if (file.size() < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, file.data(), sizeof(header));
+  return std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)) ==
+             0 &&
+         header.version == snapshot_version &&
+         header.compression <=
+             static_cast<uint32_t>(SnapshotCompression::ZLIB);
+}
+
+SnapshotInfo make_info(const SnapshotHeader &header, size_t file_size) {
+  SnapshotInfo info;
+  info.source.size = header.source_size;
+  info.source.mtime_ns = header.source_mtime_ns;
+  info.source.hash = header.source_hash;
+  info.source.delimiter = header.delimiter;
+  info.compression = static_cast<SnapshotCompression>(header.compression);
+  info.row_count = header.row_count;
+  info.column_count = header.column_count;
+  info.file_size = file_size;
+  return info;
+}
+
+} // namespace
+
+bool describe_snapshot_source(const std::string &csv_file, char delimiter,
+                              SnapshotSource &source) {
+  int fd = ::open(csv_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+
+  source.size = static_cast<uint64_t>(st.st_size);
+  source.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                    st.st_mtim.tv_nsec;
+  source.delimiter = delimiter;
+
+  // Head and tail samples; small files are hashed whole
+  const size_t head = std::min<size_t>(source.size, snapshot_sample_bytes);
+  const size_t tail =
+      std::min<size_t>(source.size - head, snapshot_sample_bytes);
+  std::vector<char> sample(head + tail);
+  bool read = read_at(fd, sample.data(), head, 0) &&
+              read_at(fd, sample.data() + head, tail,
+                      static_cast<off_t>(source.size - tail));
+  ::close(fd);
+  if (!read) {
+    return false;
+  }
+
+  source.hash = hash_bytes(sample.data(), sample.size(), mix(source.size));
+  return true;
+}
+
+bool write_table_snapshot(const Table &table, const SnapshotSource &source,
+                          const std::string &path,
+                          SnapshotCompression compression) {
+  if (!snapshot_compression_available(compression)) {
+    return false;
+  }
+
+  const std::string temporary = path + ".tmp";
+  {
+    SnapshotFileWriter writer(temporary, compression);
+    if (!writer.good()) {
+      return false;
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.compression = static_cast<uint32_t>(compression);
+    header.source_size = source.size;
+    header.source_mtime_ns = source.mtime_ns;
+    header.source_hash = source.hash;
+    header.row_count = table.get_row_count();
+    header.column_count = static_cast<uint32_t>(table.get_column_count());
+    header.delimiter = source.delimiter;
+    writer.write(&header, sizeof(header));
+
+    for (size_t col = 0; col < table.get_column_count(); ++col) {
+      const Column &column = table.get_column(col);
+      ColumnHeader column_header = {};
+      column_header.name_length =
+          static_cast<uint32_t>(column.get_name().size());
+      column_header.type = static_cast<uint32_t>(column.get_type());
+      column_header.precision = column.get_precision();
+      writer.write(&column_header, sizeof(column_header));
+      writer.write(column.get_name().data(), column.get_name().size());
+      writer.align();
+
+      const auto &validity = column.get_validity();
+      writer.write_buffer(validity.data(), validity.size() * sizeof(uint64_t));
+      switch (column.get_type()) {
+      case ColumnType::INT64:
+        writer.write_buffer(column.get_ints().data(),
+                            column.get_ints().size() * sizeof(int64_t));
+        break;
+      case ColumnType::FLOAT64:
+        writer.write_buffer(column.get_doubles().data(),
+                            column.get_doubles().size() * sizeof(double));
+        break;
+      case ColumnType::STRING: {
+        writer.write_buffer(column.get_codes().data(),
+                            column.get_codes().size() * sizeof(uint32_t));
+        const std::vector<char> dictionary =
+            encode_dictionary(column.get_dictionary());
+        writer.write_buffer(dictionary.data(), dictionary.size());
+        break;
+      }
+      }
+      writer.align();
+    }
+
+    if (!writer.good()) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool read_table_snapshot(const std::string &path,
+                         const SnapshotSource &expected, Table &table,
+                         SnapshotInfo *info) {
+  table.clear();
+
+  MappedFile file;
+  SnapshotHeader header;
+  if (!file.open(path) || !read_header(file, header)) {
+    return false;
+  }
+  const SnapshotInfo snapshot = make_info(header, file.size());
+  if (!same_source(snapshot.source, expected) ||
+      !snapshot_compression_available(snapshot.compression)) {
+    return false;
+  }
+
+  SnapshotFileReader reader(file, snapshot.compression);
+  SnapshotHeader skipped;
+  reader.read(&skipped, sizeof(skipped));
+
+  for (uint32_t col = 0; col < header.column_count; ++col) {
+    ColumnHeader column_header;
+    std::string name;
+    if (!reader.read(&column_header, sizeof(column_header)) ||
+        column_header.type > static_cast<uint32_t>(ColumnType::STRING) ||
+        !reader.read_name(column_header.name_length, name)) {
+      table.clear();
+      return false;
+    }
+
+    const ColumnType type = static_cast<ColumnType>(column_header.type);
+    Column column(name, type);
+    column.set_precision(column_header.precision);
+
+    ColumnBuffers buffers;
+    bool loaded = reader.read_buffer(buffers.validity);
+    if (type == ColumnType::INT64) {
+      loaded = loaded && reader.read_buffer(buffers.ints);
+    } else if (type == ColumnType::FLOAT64) {
+      loaded = loaded && reader.read_buffer(buffers.doubles);
+    } else {
+      std::vector<char> dictionary;
+      loaded = loaded && reader.read_buffer(buffers.codes) &&
+               reader.read_buffer(dictionary) &&
+               decode_dictionary(dictionary, buffers.dictionary);
+    }
+
+    if (!loaded || !reader.align() ||
+        !column.adopt_buffers(header.row_count, std::move(buffers)) ||
+        !table.add_column(std::move(column))) {
+      table.clear();
+      return false;
+    }
+  }
+
+  if (info != nullptr) {
+    *info = snapshot;
+  }
+  return true;
+}
+
+bool read_snapshot_info(const std::string &path, SnapshotInfo &info) {
+  MappedFile file;
+  SnapshotHeader header;
+  if (!file.open(path) || !read_header(file, header)) {
+    return false;
+  }
+  info = make_info(header, file.size());
+  return true;
+}
+
+bool parse_snapshot_compression(const std::string &name,
+                                SnapshotCompression &compression) {
+  if (name == "none") {
+    compression = SnapshotCompression::NONE;
+  } else if (name == "zlib") {
+    compression = SnapshotCompression::ZLIB;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool snapshot_compression_available(SnapshotCompression compression) {
+#ifdef ADAPTER_HAVE_ZLIB
+  return compression == SnapshotCompression::NONE ||
+         compression == SnapshotCompression::ZLIB;
+#else
+  return compression == SnapshotCompression::NONE;
+#endif
+}
+
+} // namespace adapter
@@ -0,0 +1,150 @@
+#include "adapter/thread_pool.hpp"
+
+namespace adapter {
+
+namespace {
+
+// Identifies the worker running on this thread, so tasks it submits land in
+// its own queue.
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t thread_count)
+    : queued(0), pending(0), next_queue(0), stopping(false) {
+  if (thread_count > 1) {
+    queues.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+      queues.push_back(std::make_unique<WorkQueue>());
+    }
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+      workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  task_available.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::get_thread_count() const {
+  return workers.empty() ? 1 : workers.size();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  if (workers.empty()) {
+    run_task(task);
+    return;
+  }
+
+  const size_t target = current_pool == this
+                            ? current_queue
+                            : next_queue.fetch_add(1) % queues.size();
+  pending.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(queues[target]->mutex);
+    queues[target]->tasks.push_back(std::move(task));
+    queued.fetch_add(1);
+  }
+
+  // Taking the pool mutex orders this wakeup after any worker's last check
+  { std::lock_guard<std::mutex> lock(mutex); }
+  task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  tasks_done.wait(lock, [this] { return pending.load() == 0; });
+
+  if (first_error) {
+    std::exception_ptr error = first_error;
+    first_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::parallel_for(size_t count,
+                              const std::function<void(size_t)> &body) {
+  for (size_t i = 0; i < count; ++i) {
+    submit([&body, i] { body(i); });
+  }
+  wait();
+}
+
+size_t ThreadPool::default_thread_count() {
+  size_t count = std::thread::hardware_concurrency();
+  return count == 0 ? 1 : count;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+  current_pool = this;
+  current_queue = index;
+
+  while (true) {
+    std::function<void()> task;
+    if (take_task(index, task)) {
+      run_task(task);
+      if (pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks_done.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task_available.wait(lock,
+                        [this] { return stopping || queued.load() > 0; });
+    if (stopping && queued.load() == 0) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::take_task(size_t index, std::function<void()> &task) {
+  // Newest local work first: it is the most likely to still be in cache
+  {
+    WorkQueue &own = *queues[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      queued.fetch_sub(1);
+      return true;
+    }
+  }
+
+  // Steal the oldest task from the next busy worker
+  for (size_t offset = 1; offset < queues.size(); ++offset) {
+    WorkQueue &victim = *queues[(index + offset) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      queued.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::run_task(const std::function<void()> &task) {
+  try {
+    task();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!first_error) {
+      first_error = std::current_exception();
+    }
+  }
+}
+
+} // namespace adapter
@@ -1,19 +1,195 @@
 #include "adapter/time_aligner.hpp"
+#include "adapter/thread_pool.hpp"
+#include "adapter/value_parser.hpp"
 #include <algorithm>
-#include <chrono>
 #include <cmath>
-#include <ctime>
-#include <iomanip>
 #include <iostream>
-#include <regex>
-#include <sstream>
 
 namespace adapter {
 
+namespace {
+
+template <typename T>
+std::vector<T> in_index_order(std::vector<T> values, const TimeIndex &index) {
+  if (index.was_sorted()) {
+    return values;
+  }
+  std::vector<T> sorted;
+  sorted.reserve(values.size());
+  for (size_t row : index.get_rows()) {
+    sorted.push_back(std::move(values[row]));
+  }
+  return sorted;
+}
+
+// Valid samples of a numeric column in time order, keeping the first sample
+// of any repeated timestamp so the knots strictly increase.
+void collect_knots(const Column &source, const std::vector<double> &times,
+                   const std::vector<size_t> &source_rows,
+                   std::vector<double> &knot_times,
+                   std::vector<double> &knot_values) {
+  knot_times.clear();
+  knot_values.clear();
+  for (size_t i = 0; i < times.size(); ++i) {
+    const size_t row = source_rows[i];
+    if (!source.is_valid(row) ||
+        (!knot_times.empty() && times[i] <= knot_times.back())) {
+      continue;
+    }
+    knot_times.push_back(times[i]);
+    knot_values.push_back(source.get_double(row));
+  }
+}
+
+double interpolate_between(double x, double x1, double y1, double x2,
+                           double y2) {
+  if (std::abs(x2 - x1) < 1e-10) {
+    return y1; // Avoid division by zero
+  }
+
+  return y1 + (y2 - y1) * (x - x1) / (x2 - x1);
+}
+
+// Linear interpolation of a numeric column onto the grid, taking the
+// nearest sample where either neighbour is null. Value is the column's
+// storage type, so the loop reads its array directly instead of dispatching
+// on the type for every cell.
+template <typename Value>
+Column interpolate_numeric(const Column &source, const Value *values,
+                           const std::vector<double> &times,
+                           const std::vector<size_t> &rows,
+                           const std::vector<double> &target_times,
+                           const std::vector<size_t> &lower_indices,
+                           const std::vector<size_t> &upper_indices,
+                           const std::vector<char> &in_gap) {
+  const std::vector<uint64_t> &validity = source.get_validity();
+  auto is_valid = [&validity](size_t row) {
+    return (validity[row / 64] >> (row % 64)) & 1u;
+  };
+
+  const size_t count = target_times.size();
+  ColumnBuffers buffers;
+  buffers.doubles.assign(count, 0.0);
+  buffers.validity.assign((count + 63) / 64, 0);
+  for (size_t time_idx = 0; time_idx < count; ++time_idx) {
+    if (in_gap[time_idx]) {
+      continue;
+    }
+
+    const double target_time = target_times[time_idx];
+    const size_t lower_idx = lower_indices[time_idx];
+    const size_t upper_idx = upper_indices[time_idx];
+    const size_t lower_row = rows[lower_idx];
+    const size_t upper_row = rows[upper_idx];
+    if (is_valid(lower_row) && is_valid(upper_row)) {
+      buffers.doubles[time_idx] = interpolate_between(
+          target_time, times[lower_idx], static_cast<double>(values[lower_row]),
+          times[upper_idx], static_cast<double>(values[upper_row]));
+    } else {
+      const double dist_lower = std::abs(target_time - times[lower_idx]);
+      const double dist_upper = std::abs(target_time - times[upper_idx]);
+      const size_t nearest_row =
+          dist_lower <= dist_upper ? lower_row : upper_row;
+      if (!is_valid(nearest_row)) {
+        continue;
+      }
+      buffers.doubles[time_idx] = static_cast<double>(values[nearest_row]);
+    }
+    buffers.validity[time_idx / 64] |= uint64_t(1) << (time_idx % 64);
+  }
+
+  Column column(source.get_name(), ColumnType::FLOAT64);
+  // Interpolated values are rendered like std::to_string
+  column.set_precision(6);
+  column.adopt_buffers(count, std::move(buffers));
+  return column;
+}
+
+// Rate of change between knots, following the spline or straight lines.
+// Targets are visited in order, so each keeps a cursor into the knots.
+struct SplineRate {
+  const CubicSpline &spline;
+  size_t cursor = 0;
+
+  double operator()(double t) { return spline.evaluate_at(t, cursor); }
+};
+
+struct LinearRate {
+  const std::vector<double> &knot_times;
+  const std::vector<double> &knot_values;
+  size_t cursor = 0;
+
+  double operator()(double t) {
+    if (t <= knot_times.front()) {
+      return knot_values.front();
+    }
+    if (t >= knot_times.back()) {
+      return knot_values.back();
+    }
+    if (t < knot_times[cursor]) {
+      cursor = 0;
+    }
+    while (knot_times[cursor + 1] < t) {
+      ++cursor;
+    }
+    return interpolate_between(t, knot_times[cursor], knot_values[cursor],
+                               knot_times[cursor + 1],
+                               knot_values[cursor + 1]);
+  }
+};
+
+// The rate depends on time only, so each step needs f(t) alone.
+struct RungeKuttaStep {
+  template <typename Rate>
+  double operator()(Rate &f, double t, double y, double h) const {
+    const double k1 = f(t);
+    const double k2 = f(t + h / 2.0);
+    const double k3 = f(t + h / 2.0);
+    const double k4 = f(t + h);
+    return y + h * (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
+  }
+};
+
+struct HeunStep {
+  template <typename Rate>
+  double operator()(Rate &f, double t, double y, double h) const {
+    return y + h * (f(t) + f(t + h)) / 2.0;
+  }
+};
+
+// Integral of the rate from the first target to each one. Step and Rate
+// are resolved at compile time, so both inline into the loop.
+template <typename Step, typename Rate>
+std::vector<double> integrate(Rate &rate,
+                              const std::vector<double> &target_times) {
+  const Step step;
+  std::vector<double> integral(target_times.size(), 0.0);
+  for (size_t i = 1; i < target_times.size(); ++i) {
+    const double t = target_times[i - 1];
+    const double h = target_times[i] - t;
+    integral[i] = step(rate, t, integral[i - 1], h);
+  }
+  return integral;
+}
+
+template <typename Rate>
+std::vector<double> integrate(SolverMethod method, Rate &rate,
+                              const std::vector<double> &target_times) {
+  return method == SolverMethod::HEUN
+             ? integrate<HeunStep>(rate, target_times)
+             : integrate<RungeKuttaStep>(rate, target_times);
+}
+
+} // namespace
+
 TimeAligner::TimeAligner()
     : target_time_interval(1.0),
       solver_method(SolverMethod::LINEAR_INTERPOLATION),
-      time_format("%Y-%m-%d %H:%M:%S") {}
+      time_format("%Y-%m-%d %H:%M:%S"),
+      spline_boundary(SplineBoundary::NATURAL), thread_count(1), max_gap(0.0),
+      aggregation(ResampleAggregation::NONE), has_grid_origin(false),
+      grid_origin(0.0), aligned_point_count(0), unparsed_time_count(0),
+      gap_point_count(0) {}
 
 TimeAligner::~TimeAligner() {}
 
@@ -22,6 +198,9 @@ void TimeAligner::align_time_series_data(
     const std::string &time_column_name,
     const std::vector<std::string> &dependent_columns,
     const std::vector<std::string> &independent_columns) {
+  aligned_point_count = 0;
+  unparsed_time_count = 0;
+  gap_point_count = 0;
   if (data.empty()) {
     std::cerr << "Error: No data to align" << std::endl;
     return;
@@ -62,67 +241,350 @@ void TimeAligner::align_time_series_data(
 
   // Parse time values
   std::vector<double> original_times = parse_time_column(time_column);
+  unparsed_time_count = time_column.size() - original_times.size();
   if (original_times.empty()) {
     std::cerr << "Error: Could not parse time column" << std::endl;
     return;
   }
 
+  // Sort the source once; every column then shares the same order
+  const size_t time_count = original_times.size();
+  std::vector<size_t> positions(time_count);
+  for (size_t i = 0; i < time_count; ++i) {
+    positions[i] = i;
+  }
+  TimeIndex index;
+  index.build(std::move(original_times), std::move(positions));
+
   // Create uniform time grid
-  double start_time =
-      *std::min_element(original_times.begin(), original_times.end());
-  double end_time =
-      *std::max_element(original_times.begin(), original_times.end());
-  std::vector<double> target_times =
-      create_uniform_time_grid(start_time, end_time);
+  std::vector<double> target_times = create_uniform_time_grid(
+      has_grid_origin ? grid_origin : index.get_times().front(),
+      index.get_times().back());
 
   // Create new aligned data structure
-  std::vector<std::vector<std::string>> aligned_data;
+  std::vector<std::vector<std::string>> aligned_data(
+      target_times.size() + 1, std::vector<std::string>(data[0].size()));
 
   // Keep the header row
-  if (!data.empty()) {
-    aligned_data.push_back(data[0]);
-  }
+  aligned_data[0] = data[0];
 
-  // Interpolate data for each target time
+  // Set the time values (convert back to readable format)
   for (size_t time_idx = 0; time_idx < target_times.size(); ++time_idx) {
-    std::vector<std::string> new_row(data[0].size());
+    aligned_data[time_idx + 1][time_column_index] =
+        format_time_value(target_times[time_idx]);
+  }
+
+  // Interpolate each column in one pass over the target grid
+  for_each_column(data[0].size(), [&](size_t col) {
+    if (col == time_column_index) {
+      return; // Already set above
+    }
+
+    // Extract original values for this column
+    std::vector<std::string> original_values;
+    original_values.reserve(data.size() - 1);
+    for (size_t i = 1; i < data.size(); ++i) {
+      if (col < data[i].size()) {
+        original_values.push_back(data[i][col]);
+      }
+    }
+
+    std::vector<std::string> interpolated_values;
+    if (original_values.size() == index.size()) {
+      interpolated_values = interpolate_values(
+          index, in_index_order(std::move(original_values), index),
+          target_times);
+    }
 
-    // Set the time value (convert back to readable format)
-    new_row[time_column_index] = format_time_value(target_times[time_idx]);
+    for (size_t time_idx = 0; time_idx < target_times.size(); ++time_idx) {
+      aligned_data[time_idx + 1][col] = interpolated_values.empty()
+                                            ? "0" // Default value
+                                            : interpolated_values[time_idx];
+    }
+  });
+
+  // Replace original data with aligned data
+  data = std::move(aligned_data);
+
+  aligned_point_count = target_times.size();
+  std::cout << "Time series alignment complete. Generated "
+            << target_times.size() << " aligned data points" << std::endl;
+}
+
+bool TimeAligner::align_time_series_data(
+    Table &table, const std::string &time_column_name,
+    const std::vector<std::string> &dependent_columns,
+    const std::vector<std::string> &independent_columns) {
+  aligned_point_count = 0;
+  unparsed_time_count = 0;
+  gap_point_count = 0;
+  grid_times.clear();
+  if (table.empty()) {
+    std::cerr << "Error: No data to align" << std::endl;
+    return false;
+  }
+
+  std::cout << "Starting time series alignment..." << std::endl;
+  std::cout << "Target time interval: " << target_time_interval << " seconds"
+            << std::endl;
+
+  const size_t time_column_index = table.find_column(time_column_name);
+  if (time_column_index == Table::npos) {
+    std::cerr << "Error: Time column '" << time_column_name << "' not found"
+              << std::endl;
+    return false;
+  }
+
+  // Parse time values; string columns are parsed once per distinct value
+  const Column &time_column = table.get_column(time_column_index);
+  std::vector<double> original_times;
+  std::vector<size_t> source_rows;
+  original_times.reserve(time_column.size());
+  source_rows.reserve(time_column.size());
+
+  std::vector<double> parsed_dictionary;
+  std::vector<bool> dictionary_parsed;
+  if (time_column.get_type() == ColumnType::STRING) {
+    const auto &dictionary = time_column.get_dictionary();
+    parsed_dictionary.resize(dictionary.size());
+    dictionary_parsed.resize(dictionary.size());
+    // A timestamp column's values are known to be RFC 3339 already
+    const bool rfc3339 = time_column.get_kind() == ColumnKind::TIMESTAMP;
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+      dictionary_parsed[i] =
+          (rfc3339 && parse_iso_timestamp(dictionary[i],
+                                          parsed_dictionary[i])) ||
+          parse_time_value(dictionary[i], parsed_dictionary[i]);
+    }
+  }
 
-    // Interpolate each column
-    for (size_t col = 0; col < data[0].size(); ++col) {
-      if (col == time_column_index) {
-        continue; // Already set above
+  for (size_t row = 0; row < time_column.size(); ++row) {
+    if (time_column.is_valid(row)) {
+      if (time_column.is_numeric()) {
+        original_times.push_back(time_column.get_double(row));
+        source_rows.push_back(row);
+        continue;
       }
 
-      // Extract original values for this column
-      std::vector<std::string> original_values;
-      for (size_t i = 1; i < data.size(); ++i) {
-        if (col < data[i].size()) {
-          original_values.push_back(data[i][col]);
+      uint32_t code = time_column.get_codes()[row];
+      if (dictionary_parsed[code]) {
+        original_times.push_back(parsed_dictionary[code]);
+        source_rows.push_back(row);
+        continue;
+      }
+    }
+
+    ++unparsed_time_count;
+    std::cerr << "Warning: Could not parse time value: "
+              << time_column.to_string(row) << std::endl;
+  }
+
+  if (original_times.empty()) {
+    std::cerr << "Error: Could not parse time column" << std::endl;
+    return false;
+  }
+
+  // Sort the source once, and only if it is out of order; every column
+  // then shares the same order
+  TimeIndex index;
+  {
+    ThreadPool pool(
+        original_times.size() >= TimeIndex::min_parallel_sort ? thread_count
+                                                               : 1);
+    index.build(std::move(original_times), std::move(source_rows), &pool);
+  }
+  const std::vector<double> &times = index.get_times();
+  const std::vector<size_t> &rows = index.get_rows();
+
+  // Create uniform time grid
+  std::vector<double> target_times = create_uniform_time_grid(
+      has_grid_origin ? grid_origin : times.front(), times.back());
+
+  // Bracketing source points for each target time, and the targets that
+  // fall inside an outage
+  std::vector<size_t> lower_indices;
+  std::vector<size_t> upper_indices;
+  index.bracket(target_times, lower_indices, upper_indices);
+  std::vector<char> in_gap(target_times.size(), 0);
+  std::vector<size_t> bucket_starts;
+  if (aggregation != ResampleAggregation::NONE) {
+    index.bucket(target_times, bucket_starts);
+  } else {
+    for (size_t time_idx = 0; time_idx < target_times.size(); ++time_idx) {
+      in_gap[time_idx] = index.in_gap(target_times[time_idx],
+                                      lower_indices[time_idx],
+                                      upper_indices[time_idx], max_gap);
+      gap_point_count += in_gap[time_idx];
+    }
+  }
+
+  // Columns are independent, so each is aligned into its own slot and the
+  // table is assembled in order afterwards
+  std::vector<Column> aligned_columns(table.get_column_count());
+  for_each_column(aligned_columns.size(), [&](size_t col) {
+    const Column &source = table.get_column(col);
+
+    if (col == time_column_index) {
+      Column times(source.get_name(), ColumnType::STRING);
+      times.reserve(target_times.size());
+      for (double target_time : target_times) {
+        times.append_string(format_time_value(target_time));
+      }
+      aligned_columns[col] = std::move(times);
+      return;
+    }
+
+    if (aggregation != ResampleAggregation::NONE) {
+      aligned_columns[col] = aggregate_column(source, index, bucket_starts);
+      return;
+    }
+
+    if (source.is_numeric() && solver_method == SolverMethod::CUBIC_SPLINE) {
+      Column values(source.get_name(), ColumnType::FLOAT64);
+      values.reserve(target_times.size());
+      // Interpolated values are rendered like std::to_string
+      values.set_precision(6);
+      std::vector<double> knot_times;
+      std::vector<double> knot_values;
+      collect_knots(source, times, rows, knot_times, knot_values);
+      if (knot_times.empty()) {
+        for (size_t time_idx = 0; time_idx < target_times.size(); ++time_idx) {
+          values.append_null();
+        }
+      } else {
+        const std::vector<double> curve =
+            cubic_spline_interpolation(knot_times, knot_values, target_times);
+        for (size_t time_idx = 0; time_idx < curve.size(); ++time_idx) {
+          if (in_gap[time_idx]) {
+            values.append_null();
+          } else {
+            values.append_double(curve[time_idx]);
+          }
         }
       }
+      aligned_columns[col] = std::move(values);
+      return;
+    }
 
-      // Interpolate values
-      std::vector<std::string> interpolated_values = interpolate_values(
-          original_times, original_values, {target_times[time_idx]});
+    if (source.get_type() == ColumnType::INT64) {
+      aligned_columns[col] = interpolate_numeric(
+          source, source.get_ints().data(), times, rows, target_times,
+          lower_indices, upper_indices, in_gap);
+      return;
+    }
+    if (source.get_type() == ColumnType::FLOAT64) {
+      aligned_columns[col] = interpolate_numeric(
+          source, source.get_doubles().data(), times, rows, target_times,
+          lower_indices, upper_indices, in_gap);
+      return;
+    }
+
+    // Text takes the nearest sample
+    Column values(source.get_name(), ColumnType::STRING);
+    values.reserve(target_times.size());
+    for (size_t time_idx = 0; time_idx < target_times.size(); ++time_idx) {
+      const double target_time = target_times[time_idx];
+      const size_t lower_idx = lower_indices[time_idx];
+      const size_t upper_idx = upper_indices[time_idx];
+      if (in_gap[time_idx]) {
+        values.append_null();
+        continue;
+      }
+
+      double dist_lower = std::abs(target_time - times[lower_idx]);
+      double dist_upper = std::abs(target_time - times[upper_idx]);
+      size_t nearest_row =
+          (dist_lower <= dist_upper) ? rows[lower_idx] : rows[upper_idx];
 
-      if (!interpolated_values.empty()) {
-        new_row[col] = interpolated_values[0];
+      if (!source.is_valid(nearest_row)) {
+        values.append_null();
       } else {
-        new_row[col] = "0"; // Default value
+        values.append_string(source.get_string(nearest_row));
       }
     }
 
-    aligned_data.push_back(new_row);
+    aligned_columns[col] = std::move(values);
+  });
+
+  std::vector<size_t> derivative_indices;
+  for (const auto &name : derivative_columns) {
+    const size_t col = table.find_column(name);
+    if (col == Table::npos || !table.get_column(col).is_numeric()) {
+      std::cerr << "Warning: Derivative column '" << name
+                << "' not found or not numeric" << std::endl;
+      continue;
+    }
+    derivative_indices.push_back(col);
+  }
+
+  std::vector<Column> integrals(derivative_indices.size());
+  for_each_column(integrals.size(), [&](size_t i) {
+    const Column &source = table.get_column(derivative_indices[i]);
+    std::vector<double> knot_times;
+    std::vector<double> knot_values;
+    collect_knots(source, times, rows, knot_times, knot_values);
+    if (knot_times.empty()) {
+      return;
+    }
+
+    // The rate between samples follows the same interpolant as the values
+    CubicSpline spline;
+    if (solver_method == SolverMethod::CUBIC_SPLINE) {
+      spline.fit(knot_times, knot_values, spline_boundary);
+    }
+    std::vector<double> integral_values;
+    if (spline.get_knot_count() > 0) {
+      SplineRate rate{spline};
+      integral_values = integrate(solver_method, rate, target_times);
+    } else {
+      LinearRate rate{knot_times, knot_values};
+      integral_values = integrate(solver_method, rate, target_times);
+    }
+
+    Column integral(source.get_name() + "_integral", ColumnType::FLOAT64);
+    integral.set_precision(6);
+    integral.reserve(target_times.size());
+    for (double value : integral_values) {
+      integral.append_double(value);
+    }
+    integrals[i] = std::move(integral);
+  });
+
+  Table aligned;
+  for (auto &column : aligned_columns) {
+    aligned.add_column(std::move(column));
+  }
+  for (auto &integral : integrals) {
+    if (!integral.get_name().empty()) {
+      aligned.add_column(std::move(integral));
+    }
   }
 
   // Replace original data with aligned data
-  data = aligned_data;
+  table = std::move(aligned);
 
+  aligned_point_count = target_times.size();
+  grid_times = std::move(target_times);
   std::cout << "Time series alignment complete. Generated "
-            << target_times.size() << " aligned data points" << std::endl;
+            << aligned_point_count << " aligned data points" << std::endl;
+  return true;
+}
+
+void TimeAligner::set_alignment_columns(
+    const std::string &time_column_name,
+    const std::vector<std::string> &dependent_columns,
+    const std::vector<std::string> &independent_columns) {
+  alignment_time_column = time_column_name;
+  alignment_dependent_columns = dependent_columns;
+  alignment_independent_columns = independent_columns;
+}
+
+std::string TimeAligner::get_stage_name() const { return "align"; }
+
+bool TimeAligner::apply(Table &table) {
+  return align_time_series_data(table, alignment_time_column,
+                                alignment_dependent_columns,
+                                alignment_independent_columns);
 }
 
 void TimeAligner::set_target_time_interval(double interval_seconds) {
@@ -137,109 +599,124 @@ void TimeAligner::set_time_format(const std::string &format) {
   time_format = format;
 }
 
-std::vector<double> TimeAligner::parse_time_column(
-    const std::vector<std::string> &time_column) const {
-  std::vector<double> parsed_times;
+void TimeAligner::set_spline_boundary(SplineBoundary boundary) {
+  spline_boundary = boundary;
+}
 
-  for (const auto &time_str : time_column) {
-    // Try parsing as numeric timestamp first (only if it's all digits and
-    // optional decimal point)
-    std::regex numeric_pattern(R"(^\d+(\.\d+)?$)");
-    if (std::regex_match(time_str, numeric_pattern)) {
-      try {
-        double time_value = std::stod(time_str);
-        parsed_times.push_back(time_value);
-        continue;
-      } catch (const std::exception &) {
-        // Not a numeric value, try date/time parsing
-      }
-    }
+void TimeAligner::set_derivative_columns(
+    const std::vector<std::string> &columns) {
+  derivative_columns = columns;
+}
 
-    // Try parsing ISO format: YYYY-MM-DDTHH:MM:SS or YYYY-MM-DD HH:MM:SS
-    std::regex iso_datetime_pattern(
-        R"((\d{4})-(\d{2})-(\d{2})[T\s](\d{2}):(\d{2}):(\d{2}))");
-    std::smatch matches;
-
-    if (std::regex_search(time_str, matches, iso_datetime_pattern)) {
-      try {
-        int year = std::stoi(matches[1]);
-        int month = std::stoi(matches[2]);
-        int day = std::stoi(matches[3]);
-        int hour = std::stoi(matches[4]);
-        int minute = std::stoi(matches[5]);
-        int second = std::stoi(matches[6]);
-
-        // Create a chrono time_point
-        std::tm tm = {};
-        tm.tm_year = year - 1900; // years since 1900
-        tm.tm_mon = month - 1;    // months since January (0-11)
-        tm.tm_mday = day;
-        tm.tm_hour = hour;
-        tm.tm_min = minute;
-        tm.tm_sec = second;
-        tm.tm_isdst = -1; // let mktime determine DST
-
-        std::time_t time_t_value = std::mktime(&tm);
-        if (time_t_value != -1) {
-          // Convert to seconds since Unix epoch (1970-01-01)
-          double time_value = static_cast<double>(time_t_value);
-          parsed_times.push_back(time_value);
-          continue;
-        }
-      } catch (const std::exception &) {
-        // Fall through to date-only parsing
-      }
-    }
+void TimeAligner::set_thread_count(size_t count) {
+  thread_count = count == 0 ? 1 : count;
+}
 
-    // Try parsing just date: YYYY-MM-DD
-    std::regex date_pattern(R"((\d{4})-(\d{2})-(\d{2}))");
-    if (std::regex_search(time_str, matches, date_pattern)) {
-      try {
-        int year = std::stoi(matches[1]);
-        int month = std::stoi(matches[2]);
-        int day = std::stoi(matches[3]);
-
-        std::tm tm = {};
-        tm.tm_year = year - 1900;
-        tm.tm_mon = month - 1;
-        tm.tm_mday = day;
-        tm.tm_hour = 0;
-        tm.tm_min = 0;
-        tm.tm_sec = 0;
-        tm.tm_isdst = -1;
-
-        std::time_t time_t_value = std::mktime(&tm);
-        if (time_t_value != -1) {
-          double time_value = static_cast<double>(time_t_value);
-          parsed_times.push_back(time_value);
-          continue;
-        }
-      } catch (const std::exception &) {
-        // Continue to error case
-      }
+void TimeAligner::set_max_gap(double seconds) { max_gap = seconds; }
+
+void TimeAligner::set_aggregation(ResampleAggregation aggregation) {
+  this->aggregation = aggregation;
+}
+
+ResampleAggregation TimeAligner::get_aggregation() const {
+  return aggregation;
+}
+
+void TimeAligner::set_grid_origin(double time) {
+  has_grid_origin = true;
+  grid_origin = time;
+}
+
+const std::string &TimeAligner::get_alignment_time_column() const {
+  return alignment_time_column;
+}
+
+const std::vector<double> &TimeAligner::get_grid_times() const {
+  return grid_times;
+}
+
+void TimeAligner::for_each_column(
+    size_t column_count, const std::function<void(size_t)> &body) const {
+  if (thread_count <= 1 || column_count <= 1) {
+    for (size_t col = 0; col < column_count; ++col) {
+      body(col);
     }
+    return;
+  }
 
-    // If all parsing attempts fail, skip this entry
-    std::cerr << "Warning: Could not parse time value: " << time_str
-              << std::endl;
+  ThreadPool pool(std::min(thread_count, column_count));
+  pool.parallel_for(column_count, body);
+}
+
+size_t TimeAligner::get_aligned_point_count() const {
+  return aligned_point_count;
+}
+
+size_t TimeAligner::get_unparsed_time_count() const {
+  return unparsed_time_count;
+}
+
+size_t TimeAligner::get_gap_point_count() const { return gap_point_count; }
+
+bool TimeAligner::parse_solver_method(const std::string &name,
+                                      SolverMethod &method) {
+  if (name == "linear") {
+    method = SolverMethod::LINEAR_INTERPOLATION;
+  } else if (name == "rk4") {
+    method = SolverMethod::RK4;
+  } else if (name == "heun") {
+    method = SolverMethod::HEUN;
+  } else if (name == "cubic_spline") {
+    method = SolverMethod::CUBIC_SPLINE;
+  } else {
+    return false;
   }
+  return true;
+}
 
-  return parsed_times;
+bool TimeAligner::parse_aggregation(const std::string &name,
+                                    ResampleAggregation &aggregation) {
+  if (name == "none") {
+    aggregation = ResampleAggregation::NONE;
+  } else if (name == "mean") {
+    aggregation = ResampleAggregation::MEAN;
+  } else if (name == "min") {
+    aggregation = ResampleAggregation::MIN;
+  } else if (name == "max") {
+    aggregation = ResampleAggregation::MAX;
+  } else if (name == "last") {
+    aggregation = ResampleAggregation::LAST;
+  } else {
+    return false;
+  }
+  return true;
 }
 
-std::string TimeAligner::format_time_value(double time_value) const {
-  // Convert from Unix timestamp to readable format using chrono
-  std::time_t time_t_value = static_cast<std::time_t>(time_value);
-  std::tm *tm_ptr = std::gmtime(&time_t_value);
+std::vector<double> TimeAligner::parse_time_column(
+    const std::vector<std::string> &time_column) const {
+  std::vector<double> parsed_times;
 
-  if (tm_ptr == nullptr) {
-    // Fallback for invalid time
-    return "1970-01-01T00:00:00";
+  for (const auto &time_str : time_column) {
+    double time_value = 0.0;
+    if (parse_time_value(time_str, time_value)) {
+      parsed_times.push_back(time_value);
+    } else {
+      // If all parsing attempts fail, skip this entry
+      std::cerr << "Warning: Could not parse time value: " << time_str
+                << std::endl;
+    }
   }
 
-  std::ostringstream oss;
-  oss << std::put_time(tm_ptr, "%Y-%m-%dT%H:%M:%S");
-  return oss.str();
+  return parsed_times;
+}
+
+bool TimeAligner::parse_time_value(const std::string &time_str,
+                                   double &time_value) const {
+  return parse_timestamp(time_str, time_value);
+}
+
+std::string TimeAligner::format_time_value(double time_value) const {
+  return format_iso_timestamp(time_value);
 }
 
 std::vector<double>
@@ -251,6 +728,8 @@ TimeAligner::create_uniform_time_grid(double start_time,
     return time_grid;
   }
 
+  time_grid.reserve(
+      static_cast<size_t>((end_time - start_time) / target_time_interval) + 2);
   for (double t = start_time; t <= end_time; t += target_time_interval) {
     time_grid.push_back(t);
   }
@@ -259,43 +738,46 @@ TimeAligner::create_uniform_time_grid(double start_time,
 }
 
 std::vector<std::string>
-TimeAligner::interpolate_values(const std::vector<double> &original_times,
+TimeAligner::interpolate_values(const TimeIndex &index,
                                 const std::vector<std::string> &original_values,
                                 const std::vector<double> &target_times) const {
   std::vector<std::string> interpolated_values;
+  const std::vector<double> &original_times = index.get_times();
 
   if (original_times.size() != original_values.size() ||
       original_times.empty()) {
     return interpolated_values;
   }
 
-  for (double target_time : target_times) {
-    std::string interpolated_value = "0";
+  // Each value is parsed once rather than once per target it brackets
+  std::vector<double> numbers(original_values.size(), 0.0);
+  std::vector<char> numeric(original_values.size(), 0);
+  for (size_t i = 0; i < original_values.size(); ++i) {
+    numeric[i] = parse_number(original_values[i], numbers[i]);
+  }
 
-    // Find the two closest time points
-    size_t lower_idx = 0;
-    size_t upper_idx = original_times.size() - 1;
+  std::vector<size_t> lower_indices;
+  std::vector<size_t> upper_indices;
+  index.bracket(target_times, lower_indices, upper_indices);
+  interpolated_values.reserve(target_times.size());
 
-    for (size_t i = 0; i < original_times.size() - 1; ++i) {
-      if (original_times[i] <= target_time &&
-          target_time <= original_times[i + 1]) {
-        lower_idx = i;
-        upper_idx = i + 1;
-        break;
-      }
+  for (size_t time_idx = 0; time_idx < target_times.size(); ++time_idx) {
+    const double target_time = target_times[time_idx];
+    const size_t lower_idx = lower_indices[time_idx];
+    const size_t upper_idx = upper_indices[time_idx];
+    std::string interpolated_value;
+    if (index.in_gap(target_time, lower_idx, upper_idx, max_gap)) {
+      interpolated_values.emplace_back();
+      continue;
     }
 
-    // Check if we can interpolate numerically
-    try {
-      double lower_value = std::stod(original_values[lower_idx]);
-      double upper_value = std::stod(original_values[upper_idx]);
-
+    if (numeric[lower_idx] && numeric[upper_idx]) {
       double interpolated_numeric = linear_interpolation(
-          target_time, original_times[lower_idx], lower_value,
-          original_times[upper_idx], upper_value);
+          target_time, original_times[lower_idx], numbers[lower_idx],
+          original_times[upper_idx], numbers[upper_idx]);
 
-      interpolated_value = std::to_string(interpolated_numeric);
-    } catch (const std::exception &) {
+      interpolated_value = format_fixed(interpolated_numeric, 6);
+    } else {
       // If not numeric, use nearest neighbor
       double dist_lower = std::abs(target_time - original_times[lower_idx]);
       double dist_upper = std::abs(target_time - original_times[upper_idx]);
@@ -307,31 +789,77 @@ TimeAligner::interpolate_values(const std::vector<double> &original_times,
       }
     }
 
-    interpolated_values.push_back(interpolated_value);
+    interpolated_values.push_back(std::move(interpolated_value));
   }
 
   return interpolated_values;
 }
 
-double TimeAligner::linear_interpolation(double x, double x1, double y1,
-                                         double x2, double y2) const {
-  if (std::abs(x2 - x1) < 1e-10) {
-    return y1; // Avoid division by zero
+Column TimeAligner::aggregate_column(const Column &source,
+                                    const TimeIndex &index,
+                                    const std::vector<size_t> &starts) const {
+  const std::vector<size_t> &rows = index.get_rows();
+  const size_t buckets = starts.size() - 1;
+
+  if (!source.is_numeric()) {
+    Column values(source.get_name(), ColumnType::STRING);
+    values.reserve(buckets);
+    for (size_t bucket = 0; bucket < buckets; ++bucket) {
+      size_t last = starts[bucket + 1];
+      while (last > starts[bucket] && !source.is_valid(rows[last - 1])) {
+        --last;
+      }
+      if (last == starts[bucket]) {
+        values.append_null();
+      } else {
+        values.append_string(source.get_string(rows[last - 1]));
+      }
+    }
+    return values;
   }
 
-  return y1 + (y2 - y1) * (x - x1) / (x2 - x1);
-}
+  Column values(source.get_name(), ColumnType::FLOAT64);
+  values.set_precision(6);
+  values.reserve(buckets);
+  for (size_t bucket = 0; bucket < buckets; ++bucket) {
+    size_t count = 0;
+    double result = 0.0;
+    for (size_t i = starts[bucket]; i < starts[bucket + 1]; ++i) {
+      if (!source.is_valid(rows[i])) {
+        continue;
+      }
+      const double value = source.get_double(rows[i]);
+      switch (aggregation) {
+      case ResampleAggregation::MIN:
+        result = count == 0 ? value : std::min(result, value);
+        break;
+      case ResampleAggregation::MAX:
+        result = count == 0 ? value : std::max(result, value);
+        break;
+      case ResampleAggregation::LAST:
+        result = value;
+        break;
+      default:
+        result += value;
+        break;
+      }
+      ++count;
+    }
 
-double TimeAligner::runge_kutta_step(double x, double y, double h) const {
-  // Simplified RK4 implementation (would need a proper differential equation)
-  // For now, just return a linear step
-  return y + h;
+    if (count == 0) {
+      values.append_null();
+    } else if (aggregation == ResampleAggregation::MEAN) {
+      values.append_double(result / static_cast<double>(count));
+    } else {
+      values.append_double(result);
+    }
+  }
+  return values;
 }
 
-double TimeAligner::heun_step(double x, double y, double h) const {
-  // Simplified Heun method implementation
-  // For now, just return a linear step
-  return y + h;
+double TimeAligner::linear_interpolation(double x, double x1, double y1,
+                                         double x2, double y2) const {
+  return interpolate_between(x, x1, y1, x2, y2);
 }
 
 std::vector<double>
@@ -339,28 +867,10 @@ TimeAligner::cubic_spline_interpolation(const std::vector<double> &x,
                                         const std::vector<double> &y,
                                         const std::vector<double> &xi) const {
   std::vector<double> result;
-
-  // Simplified cubic spline - for full implementation would need spline
-  // coefficients For now, fall back to linear interpolation
-  for (double xi_val : xi) {
-    // Find surrounding points
-    size_t idx = 0;
-    for (size_t i = 0; i < x.size() - 1; ++i) {
-      if (x[i] <= xi_val && xi_val <= x[i + 1]) {
-        idx = i;
-        break;
-      }
-    }
-
-    if (idx < x.size() - 1) {
-      double interpolated =
-          linear_interpolation(xi_val, x[idx], y[idx], x[idx + 1], y[idx + 1]);
-      result.push_back(interpolated);
-    } else {
-      result.push_back(y.back());
-    }
+  CubicSpline spline;
+  if (spline.fit(x, y, spline_boundary)) {
+    spline.evaluate(xi, result);
   }
-
   return result;
 }
 
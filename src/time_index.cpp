@@ -0,0 +1,126 @@
+#include "adapter/time_index.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace adapter {
+
+TimeIndex::TimeIndex() : sorted(true) {}
+
+void TimeIndex::build(std::vector<double> times, std::vector<size_t> rows,
+                      ThreadPool *pool) {
+  this->times = std::move(times);
+  this->rows = std::move(rows);
+  sorted = std::is_sorted(this->times.begin(), this->times.end());
+  if (sorted) {
+    return;
+  }
+
+  std::vector<size_t> order(this->times.size());
+  std::iota(order.begin(), order.end(), 0);
+  sort_order(order, pool);
+
+  std::vector<double> sorted_times;
+  std::vector<size_t> sorted_rows;
+  sorted_times.reserve(order.size());
+  sorted_rows.reserve(order.size());
+  for (size_t index : order) {
+    sorted_times.push_back(this->times[index]);
+    sorted_rows.push_back(this->rows[index]);
+  }
+  this->times = std::move(sorted_times);
+  this->rows = std::move(sorted_rows);
+}
+
+const std::vector<double> &TimeIndex::get_times() const { return times; }
+
+const std::vector<size_t> &TimeIndex::get_rows() const { return rows; }
+
+size_t TimeIndex::size() const { return times.size(); }
+
+bool TimeIndex::empty() const { return times.empty(); }
+
+bool TimeIndex::was_sorted() const { return sorted; }
+
+void TimeIndex::bracket(const std::vector<double> &targets,
+                        std::vector<size_t> &lower_indices,
+                        std::vector<size_t> &upper_indices) const {
+  const size_t last = times.empty() ? 0 : times.size() - 1;
+  lower_indices.assign(targets.size(), 0);
+  upper_indices.assign(targets.size(), last);
+  if (times.size() < 2) {
+    return;
+  }
+
+  // Targets ascend, so the first interval whose upper end reaches the
+  // target only ever moves forward
+  size_t cursor = 0;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const double target = targets[i];
+    if (i > 0 && target < targets[i - 1]) {
+      cursor = 0;
+    }
+    while (cursor + 1 < last && times[cursor + 1] < target) {
+      ++cursor;
+    }
+
+    // Targets outside the source range keep the first/last fallback
+    if (times[cursor] <= target && target <= times[cursor + 1]) {
+      lower_indices[i] = cursor;
+      upper_indices[i] = cursor + 1;
+    }
+  }
+}
+
+void TimeIndex::bucket(const std::vector<double> &grid,
+                       std::vector<size_t> &starts) const {
+  starts.assign(grid.size() + 1, times.size());
+  size_t sample = 0;
+  for (size_t k = 0; k < grid.size(); ++k) {
+    while (sample < times.size() && times[sample] < grid[k]) {
+      ++sample;
+    }
+    starts[k] = sample;
+  }
+}
+
+bool TimeIndex::in_gap(double target, size_t lower, size_t upper,
+                       double max_gap) const {
+  return max_gap > 0.0 && times[upper] - times[lower] > max_gap &&
+         times[lower] < target && target < times[upper];
+}
+
+void TimeIndex::sort_order(std::vector<size_t> &order,
+                           ThreadPool *pool) const {
+  auto earlier = [this](size_t a, size_t b) { return times[a] < times[b]; };
+  const size_t runs = pool != nullptr ? pool->get_thread_count() : 1;
+  if (runs <= 1 || order.size() < min_parallel_sort) {
+    std::stable_sort(order.begin(), order.end(), earlier);
+    return;
+  }
+
+  // One run per worker, then neighbouring runs are merged pairwise. The
+  // left run always wins ties, so the result is still stable.
+  std::vector<size_t> bounds(runs + 1);
+  for (size_t i = 0; i <= runs; ++i) {
+    bounds[i] = order.size() * i / runs;
+  }
+  pool->parallel_for(runs, [&](size_t i) {
+    std::stable_sort(order.begin() + bounds[i], order.begin() + bounds[i + 1],
+                     earlier);
+  });
+  for (size_t width = 1; width < runs; width *= 2) {
+    const size_t merges = (runs + 2 * width - 1) / (2 * width);
+    pool->parallel_for(merges, [&](size_t merge) {
+      const size_t first = merge * 2 * width;
+      const size_t middle = std::min(first + width, runs);
+      const size_t last = std::min(first + 2 * width, runs);
+      if (middle < last) {
+        std::inplace_merge(order.begin() + bounds[first],
+                           order.begin() + bounds[middle],
+                           order.begin() + bounds[last], earlier);
+      }
+    });
+  }
+}
+
+} // namespace adapter
@@ -0,0 +1,382 @@
+#include "adapter/value_parser.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace adapter {
+
+namespace {
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// \s in the legacy pattern: space, \t, \n, \v, \f, \r
+inline bool is_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+inline bool digits_at(std::string_view text, size_t pos, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (!is_digit(text[pos + i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline int read_digits(std::string_view text, size_t pos, size_t count) {
+  int value = 0;
+  for (size_t i = 0; i < count; ++i) {
+    value = value * 10 + (text[pos + i] - '0');
+  }
+  return value;
+}
+
+// YYYY-MM-DD starting at pos; the caller guarantees 10 bytes remain.
+inline bool date_at(std::string_view text, size_t pos) {
+  return digits_at(text, pos, 4) && text[pos + 4] == '-' &&
+         digits_at(text, pos + 5, 2) && text[pos + 7] == '-' &&
+         digits_at(text, pos + 8, 2);
+}
+
+// [T\s]HH:MM:SS starting at pos; the caller guarantees 9 bytes remain.
+inline bool time_at(std::string_view text, size_t pos) {
+  return (text[pos] == 'T' || is_space(text[pos])) &&
+         digits_at(text, pos + 1, 2) && text[pos + 3] == ':' &&
+         digits_at(text, pos + 4, 2) && text[pos + 6] == ':' &&
+         digits_at(text, pos + 7, 2);
+}
+
+inline void write_digits(char *out, int64_t value, size_t count) {
+  for (size_t i = count; i-- > 0;) {
+    out[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+}
+
+constexpr double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4,
+                                    1e5, 1e6, 1e7, 1e8, 1e9};
+
+} // namespace
+
+bool classify_number(std::string_view text, NumberFormat *format) {
+  const size_t n = text.size();
+  size_t i = 0;
+  if (i < n && (text[i] == '-' || text[i] == '+')) {
+    ++i;
+  }
+
+  size_t int_digits = 0;
+  while (i < n && is_digit(text[i])) {
+    ++i;
+    ++int_digits;
+  }
+
+  bool has_point = false;
+  int fraction_digits = 0;
+  if (i < n && text[i] == '.') {
+    has_point = true;
+    ++i;
+    while (i < n && is_digit(text[i])) {
+      ++i;
+      ++fraction_digits;
+    }
+    if (fraction_digits == 0) {
+      return false;
+    }
+  } else if (int_digits == 0) {
+    return false;
+  }
+
+  bool has_exponent = false;
+  if (i < n && (text[i] == 'e' || text[i] == 'E')) {
+    has_exponent = true;
+    ++i;
+    if (i < n && (text[i] == '-' || text[i] == '+')) {
+      ++i;
+    }
+    size_t exponent_digits = 0;
+    while (i < n && is_digit(text[i])) {
+      ++i;
+      ++exponent_digits;
+    }
+    if (exponent_digits == 0) {
+      return false;
+    }
+  }
+
+  if (i != n) {
+    return false;
+  }
+
+  if (format != nullptr) {
+    format->has_point = has_point;
+    format->has_exponent = has_exponent;
+    format->fraction_digits = fraction_digits;
+  }
+  return true;
+}
+
+bool parse_number(std::string_view text, double &value,
+                  NumberFormat *format) {
+  if (!classify_number(text, format)) {
+    return false;
+  }
+
+  // from_chars does not take a leading '+'
+  const char *begin = text.data() + (text[0] == '+' ? 1 : 0);
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(begin, end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+bool parse_integer(std::string_view text, int64_t &value) {
+  if (text.empty()) {
+    return false;
+  }
+
+  const char *begin = text.data() + (text[0] == '+' ? 1 : 0);
+  const char *end = text.data() + text.size();
+  if (begin == end || *begin == '+') {
+    return false;
+  }
+  auto result = std::from_chars(begin, end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+std::string format_fixed(double value, int precision) {
+  char buffer[64];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                              std::chars_format::fixed, precision);
+  if (result.ec == std::errc()) {
+    return std::string(buffer, result.ptr);
+  }
+
+  // Values too wide for the stack buffer
+  std::string text(400 + static_cast<size_t>(precision < 0 ? 0 : precision),
+                   '\0');
+  result = std::to_chars(&text[0], &text[0] + text.size(), value,
+                         std::chars_format::fixed, precision);
+  text.resize(result.ec == std::errc() ? result.ptr - text.data() : 0);
+  return text;
+}
+
+bool find_iso_datetime(std::string_view text, DateTimeFields &fields) {
+  if (text.size() < 10) {
+    return false;
+  }
+
+  size_t date_pos = text.size();
+  for (size_t pos = 0; pos + 10 <= text.size(); ++pos) {
+    if (!date_at(text, pos)) {
+      continue;
+    }
+    if (pos + 19 <= text.size() && time_at(text, pos + 10)) {
+      fields.year = read_digits(text, pos, 4);
+      fields.month = read_digits(text, pos + 5, 2);
+      fields.day = read_digits(text, pos + 8, 2);
+      fields.hour = read_digits(text, pos + 11, 2);
+      fields.minute = read_digits(text, pos + 14, 2);
+      fields.second = read_digits(text, pos + 17, 2);
+      fields.has_time = true;
+      return true;
+    }
+    if (date_pos == text.size()) {
+      date_pos = pos;
+    }
+  }
+
+  if (date_pos == text.size()) {
+    return false;
+  }
+
+  fields = DateTimeFields();
+  fields.year = read_digits(text, date_pos, 4);
+  fields.month = read_digits(text, date_pos + 5, 2);
+  fields.day = read_digits(text, date_pos + 8, 2);
+  return true;
+}
+
+bool contains_iso_date(std::string_view text) {
+  for (size_t pos = 0; pos + 10 <= text.size(); ++pos) {
+    if (date_at(text, pos)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int64_t days_from_civil(int64_t year, int month, int day) {
+  year -= month <= 2;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const int64_t year_of_era = year - era * 400;
+  const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 +
+                              day - 1;
+  const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 -
+                             year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+void civil_from_days(int64_t days, int64_t &year, int &month, int &day) {
+  days += 719468;
+  const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const int64_t day_of_era = days - era * 146097;
+  const int64_t year_of_era =
+      (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+       day_of_era / 146096) /
+      365;
+  const int64_t day_of_year =
+      day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const int64_t shifted_month = (5 * day_of_year + 2) / 153;
+  day = static_cast<int>(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+  month = static_cast<int>(shifted_month < 10 ? shifted_month + 3
+                                              : shifted_month - 9);
+  year = year_of_era + era * 400 + (month <= 2);
+}
+
+bool parse_iso_timestamp(std::string_view text, double &seconds) {
+  const size_t n = text.size();
+  if (n < 10 || !date_at(text, 0)) {
+    return false;
+  }
+  const int year = read_digits(text, 0, 4);
+  const int month = read_digits(text, 5, 2);
+  const int day = read_digits(text, 8, 2);
+  if (month < 1 || month > 12 || day < 1 || day > 31) {
+    return false;
+  }
+
+  int64_t clock = 0;
+  double fraction = 0.0;
+  size_t pos = 10;
+  if (pos < n && (text[pos] == 'T' || text[pos] == 't' || text[pos] == ' ')) {
+    if (pos + 6 > n || !digits_at(text, pos + 1, 2) || text[pos + 3] != ':' ||
+        !digits_at(text, pos + 4, 2)) {
+      return false;
+    }
+    const int hour = read_digits(text, pos + 1, 2);
+    const int minute = read_digits(text, pos + 4, 2);
+    int second = 0;
+    pos += 6;
+    if (pos + 3 <= n && text[pos] == ':' && digits_at(text, pos + 1, 2)) {
+      second = read_digits(text, pos + 1, 2);
+      pos += 3;
+      if (pos < n && (text[pos] == '.' || text[pos] == ',')) {
+        const size_t start = ++pos;
+        int64_t digits = 0;
+        size_t kept = 0;
+        for (; pos < n && is_digit(text[pos]); ++pos) {
+          if (kept < 9) {
+            digits = digits * 10 + (text[pos] - '0');
+            ++kept;
+          }
+        }
+        if (pos == start) {
+          return false;
+        }
+        fraction = static_cast<double>(digits) / powers_of_ten[kept];
+      }
+    }
+    // 24:00 and a leap second are accepted and roll into the next minute
+    if (hour > 24 || minute > 59 || second > 60) {
+      return false;
+    }
+    clock = hour * 3600 + minute * 60 + second;
+
+    if (pos < n && (text[pos] == 'Z' || text[pos] == 'z')) {
+      ++pos;
+    } else if (pos < n && (text[pos] == '+' || text[pos] == '-')) {
+      const int64_t sign = text[pos] == '-' ? -1 : 1;
+      if (pos + 3 > n || !digits_at(text, pos + 1, 2)) {
+        return false;
+      }
+      int64_t offset = read_digits(text, pos + 1, 2) * 60;
+      pos += 3;
+      if (pos + 3 <= n && text[pos] == ':' && digits_at(text, pos + 1, 2)) {
+        offset += read_digits(text, pos + 1, 2);
+        pos += 3;
+      } else if (pos + 2 <= n && digits_at(text, pos, 2)) {
+        offset += read_digits(text, pos, 2);
+        pos += 2;
+      }
+      clock -= sign * offset * 60;
+    }
+  }
+  if (pos != n) {
+    return false;
+  }
+
+  seconds =
+      static_cast<double>(days_from_civil(year, month, day) * 86400 + clock) +
+      fraction;
+  return true;
+}
+
+bool parse_timestamp(std::string_view text, double &seconds) {
+  if (parse_number(text, seconds) || parse_iso_timestamp(text, seconds)) {
+    return true;
+  }
+
+  DateTimeFields fields;
+  if (!find_iso_datetime(text, fields) || fields.month < 1 ||
+      fields.month > 12) {
+    return false;
+  }
+  const int64_t days = days_from_civil(fields.year, fields.month, fields.day);
+  seconds = static_cast<double>(days * 86400 + fields.hour * 3600 +
+                                fields.minute * 60 + fields.second);
+  return true;
+}
+
+std::string format_iso_timestamp(double seconds) {
+  // Roughly +-31000 years, which keeps every intermediate value in range
+  if (!std::isfinite(seconds) || std::abs(seconds) > 1e12) {
+    return "1970-01-01T00:00:00";
+  }
+
+  int64_t whole = static_cast<int64_t>(std::floor(seconds));
+  int64_t micros =
+      static_cast<int64_t>(std::llround((seconds - whole) * 1e6));
+  if (micros == 1000000) {
+    ++whole;
+    micros = 0;
+  }
+  const int64_t days = (whole >= 0 ? whole : whole - 86399) / 86400;
+  const int64_t clock = whole - days * 86400;
+  int64_t year = 0;
+  int month = 0;
+  int day = 0;
+  civil_from_days(days, year, month, day);
+
+  char buffer[32];
+  size_t length = 0;
+  if (year < 0 || year > 9999) {
+    length = static_cast<size_t>(
+        std::to_chars(buffer, buffer + 12, year).ptr - buffer);
+  } else {
+    write_digits(buffer, year, 4);
+    length = 4;
+  }
+  char *out = buffer + length;
+  out[0] = '-';
+  write_digits(out + 1, month, 2);
+  out[3] = '-';
+  write_digits(out + 4, day, 2);
+  out[6] = 'T';
+  write_digits(out + 7, clock / 3600, 2);
+  out[9] = ':';
+  write_digits(out + 10, clock / 60 % 60, 2);
+  out[12] = ':';
+  write_digits(out + 13, clock % 60, 2);
+  length += 15;
+
+  if (micros != 0) {
+    size_t digits = 6;
+    while (micros % 10 == 0) {
+      micros /= 10;
+      --digits;
+    }
+    buffer[length] = '.';
+    write_digits(buffer + length + 1, micros, digits);
+    length += digits + 1;
+  }
+  return std::string(buffer, length);
+}
+
+} // namespace adapter
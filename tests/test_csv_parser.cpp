@@ -1,7 +1,21 @@
+#include "adapter/arrow_writer.hpp"
+#include "adapter/compressed_stream.hpp"
 #include "adapter/csv_parser.hpp"
+#include "adapter/csv_stream_reader.hpp"
+#include "adapter/csv_tokenizer.hpp"
+#include "adapter/csv_writer.hpp"
+#include "adapter/data_cleaner.hpp"
+#include "adapter/structural_scanner.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+
+#ifdef ADAPTER_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace adapter;
 
@@ -117,11 +131,507 @@ void test_csv_parser_quoted_fields() {
   std::cout << "CSV Parser quoted fields tests passed!" << std::endl;
 }
 
+void test_csv_parser_escaped_quotes_and_newlines() {
+  std::cout << "Testing CSV Parser with escaped quotes and newlines..."
+            << std::endl;
+
+  std::ofstream test_file("test_escaped.csv", std::ios::binary);
+  test_file << "id,note\r\n";
+  test_file << "1,\"say \"\"hi\"\"\"\r\n";
+  test_file << "\r\n";
+  test_file << "2,\"two\nlines\"\r\n";
+  test_file << "3,plain";
+  test_file.close();
+
+  CsvParser parser;
+  bool loaded = parser.load_file("test_escaped.csv");
+  test_assert(loaded, true, "load_file with escapes should succeed");
+  test_assert(parser.get_row_count(), static_cast<size_t>(3),
+              "blank lines should be skipped");
+
+  auto notes = parser.get_column("note");
+  test_assert(notes[0], std::string("say \"hi\""),
+              "doubled quotes should unescape to one quote");
+  test_assert(notes[1], std::string("two\nlines"),
+              "quoted newline should stay inside the cell");
+  test_assert(notes[2], std::string("plain"),
+              "last record without newline should be read");
+
+  // Clean up
+  std::remove("test_escaped.csv");
+
+  std::cout << "CSV Parser escaped field tests passed!" << std::endl;
+}
+
+void test_structural_scanner_kernels() {
+  std::cout << "Testing structural scanner kernels..." << std::endl;
+
+  std::string block;
+  unsigned int seed = 12345;
+  const char alphabet[] = "ab,;\"\n 1";
+  for (size_t i = 0; i < StructuralScanner::block_size; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    block.push_back(alphabet[(seed >> 16) % (sizeof(alphabet) - 1)]);
+  }
+
+  StructuralScanner scalar(';', ScannerKernel::SCALAR);
+  StructuralMasks expected = scalar.scan_block(block.data());
+
+  for (ScannerKernel kernel : {ScannerKernel::SSE42, ScannerKernel::AVX2}) {
+    StructuralScanner scanner(';', kernel);
+    StructuralMasks masks = scanner.scan_block(block.data());
+    std::string name = StructuralScanner::kernel_name(scanner.get_kernel());
+    test_assert(masks.quotes, expected.quotes, name + " quote mask");
+    test_assert(masks.delimiters, expected.delimiters,
+                name + " delimiter mask");
+    test_assert(masks.newlines, expected.newlines, name + " newline mask");
+  }
+
+  test_assert(prefix_xor(0x11), static_cast<uint64_t>(0x0f),
+              "prefix_xor should mark bytes between quotes");
+
+  std::cout << "Structural scanner kernel tests passed!" << std::endl;
+}
+
+void test_tokenizer_across_blocks() {
+  std::cout << "Testing tokenizer with fields spanning blocks..." << std::endl;
+
+  std::string long_text(100, 'x');
+  std::string quoted = "\"" + std::string(70, 'y') + ",\n" +
+                       std::string(10, 'z') + "\"";
+  std::string input = long_text + ";" + quoted + ";end\nnext;row;here\n";
+
+  for (ScannerKernel kernel : {ScannerKernel::SCALAR, ScannerKernel::SSE42,
+                               ScannerKernel::AVX2}) {
+    StructuralScanner scanner(';', kernel);
+    CsvTokenizer tokenizer(input.data(), input.data() + input.size(),
+                           scanner);
+    std::vector<std::string_view> cells;
+
+    test_assert(tokenizer.next_record(cells), true, "first record");
+    test_assert(cells.size(), static_cast<size_t>(3),
+                "first record should have 3 cells");
+    test_assert(std::string(cells[0]), long_text, "long plain cell");
+    test_assert(std::string(cells[1]),
+                std::string(70, 'y') + ",\n" + std::string(10, 'z'),
+                "quoted cell across blocks");
+    test_assert(std::string(cells[2]), std::string("end"), "last cell");
+
+    test_assert(tokenizer.next_record(cells), true, "second record");
+    test_assert(std::string(cells[1]), std::string("row"),
+                "second record middle cell");
+    test_assert(tokenizer.next_record(cells), false, "no third record");
+  }
+
+  std::cout << "Tokenizer block boundary tests passed!" << std::endl;
+}
+
+void test_csv_parser_parallel_matches_serial() {
+  std::cout << "Testing parallel CSV parsing..." << std::endl;
+
+  // Large enough to be split into chunks, with quoted newlines and a
+  // malformed row near the end
+  std::ofstream test_file("test_parallel.csv");
+  test_file << "id,text,value\n";
+  for (int i = 0; i < 60000; ++i) {
+    if (i % 7 == 0) {
+      test_file << i << ",\"multi\nline, " << i << "\"," << i * 0.5 << "\n";
+    } else {
+      test_file << i << ",plain" << i << "," << i * 0.5 << "\n";
+    }
+  }
+  test_file << "bad,row\n";
+  test_file << "60000,tail,1.5\n";
+  test_file.close();
+
+  CsvParser serial;
+  serial.load_file("test_parallel.csv");
+
+  CsvParser parallel;
+  parallel.set_thread_count(4);
+  parallel.load_file("test_parallel.csv");
+
+  test_assert(parallel.get_row_count(), serial.get_row_count(),
+              "parallel parse should keep every row");
+  test_assert(parallel.get_row_count(), static_cast<size_t>(60001),
+              "malformed row should be skipped");
+  test_assert(parallel.get_data() == serial.get_data(), true,
+              "parallel parse should match serial parse in order");
+
+  // Clean up
+  std::remove("test_parallel.csv");
+
+  std::cout << "Parallel CSV parsing tests passed!" << std::endl;
+}
+
+void test_csv_parser_take_table() {
+  std::cout << "Testing table hand-off without copies..." << std::endl;
+
+  std::ofstream test_file("test_take.csv");
+  test_file << "id,value,label\n";
+  test_file << "1,0.5,a\n";
+  test_file << "2,1.5,b\n";
+  test_file << "2,1.5,b\n";
+  test_file.close();
+
+  CsvParser parser;
+  parser.load_file("test_take.csv");
+  const double *values =
+      parser.get_table().get_column(1).get_double_span().data();
+
+  Table table = parser.take_table();
+  test_assert(table.get_row_count(), static_cast<size_t>(3),
+              "taken table should hold every row");
+  test_assert(parser.get_row_count(), static_cast<size_t>(0),
+              "parser should hold no rows after take_table");
+  test_assert(parser.get_headers().size(), static_cast<size_t>(3),
+              "parser should keep its headers");
+
+  Span<const double> span = table.get_column(1).get_double_span();
+  test_assert(span.data() == values, true,
+              "take_table should move the column storage");
+  test_assert(span.size(), static_cast<size_t>(3), "span should cover the column");
+  test_assert(span.subspan(1, 10).size(), static_cast<size_t>(2),
+              "subspan should clamp to the end");
+  test_assert(table.get_column(0).get_int_span()[1], static_cast<int64_t>(2),
+              "int span should index values");
+
+  DataCleaner cleaner;
+  TableStage &stage = cleaner;
+  test_assert(stage.apply(table), true, "cleaner stage should apply");
+  test_assert(stage.get_stage_name(), std::string("clean"),
+              "cleaner stage should be named");
+  test_assert(table.get_row_count(), static_cast<size_t>(2),
+              "stage should transform the table in place");
+
+  std::remove("test_take.csv");
+
+  std::cout << "Table hand-off tests passed!" << std::endl;
+}
+
+void test_csv_parser_snapshot() {
+  std::cout << "Testing binary snapshots..." << std::endl;
+
+  std::ofstream test_file("test_snapshot.csv");
+  test_file << "id,value,label,mixed\n";
+  for (int i = 0; i < 500; ++i) {
+    test_file << i << "," << i * 0.25 << ",\"name, " << i % 7 << "\","
+              << (i % 5 == 0 ? "" : "1.50") << "\n";
+  }
+  test_file.close();
+
+  CsvParser first;
+  first.set_snapshot_file("test_snapshot.bin");
+  test_assert(first.load_file("test_snapshot.csv"), true,
+              "first load should parse the CSV");
+  test_assert(first.is_from_snapshot(), false,
+              "first load should not use a snapshot");
+
+  CsvParser second;
+  second.set_snapshot_file("test_snapshot.bin");
+  second.load_file("test_snapshot.csv");
+  test_assert(second.is_from_snapshot(), true,
+              "second load should come from the snapshot");
+  test_assert(second.get_data() == first.get_data(), true,
+              "snapshot should reproduce every cell");
+  test_assert(second.get_headers() == first.get_headers(), true,
+              "snapshot should keep the headers");
+  const Column &mixed = second.get_table().get_column(3);
+  test_assert(mixed.get_type() == ColumnType::FLOAT64 &&
+                  mixed.get_precision() == 2 && mixed.get_null_count() == 100,
+              true, "snapshot should keep types, precision and nulls");
+
+  SnapshotSource source;
+  describe_snapshot_source("test_snapshot.csv", ',', source);
+  if (snapshot_compression_available(SnapshotCompression::ZLIB)) {
+    write_table_snapshot(first.get_table(), source, "test_snapshot_z.bin",
+                         SnapshotCompression::ZLIB);
+    SnapshotInfo info;
+    Table table;
+    test_assert(read_table_snapshot("test_snapshot_z.bin", source, table,
+                                    &info),
+                true, "compressed snapshot should load");
+    test_assert(table.to_rows() == first.get_table().to_rows(), true,
+                "compressed snapshot should reproduce every cell");
+    test_assert(info.compression == SnapshotCompression::ZLIB, true,
+                "snapshot info should report compression");
+  }
+
+  SnapshotSource other = source;
+  other.delimiter = ';';
+  Table table;
+  test_assert(read_table_snapshot("test_snapshot.bin", other, table), false,
+              "snapshot for another delimiter should be rejected");
+
+  std::ofstream append("test_snapshot.csv", std::ios::app);
+  append << "500,125,\"name, 3\",1.50\n";
+  append.close();
+  CsvParser third;
+  third.set_snapshot_file("test_snapshot.bin");
+  third.load_file("test_snapshot.csv");
+  test_assert(third.is_from_snapshot(), false,
+              "changed source should be parsed again");
+  test_assert(third.get_row_count(), static_cast<size_t>(501),
+              "reparse should see the new row");
+
+  std::remove("test_snapshot.csv");
+  std::remove("test_snapshot.bin");
+  std::remove("test_snapshot_z.bin");
+
+  std::cout << "Binary snapshot tests passed!" << std::endl;
+}
+
+void test_csv_parser_projection() {
+  std::cout << "Testing column projection..." << std::endl;
+
+  std::ofstream test_file("test_projection.csv");
+  test_file << "a,b,c,d\n";
+  test_file << "1,\"x, y\",3,4.5\n";
+  test_file << "2,z,3\n";
+  test_file << "5,w,6,7.5\n";
+  test_file.close();
+
+  CsvParser parser;
+  parser.set_projection({"d", "b", "missing"});
+  parser.load_file("test_projection.csv");
+  test_assert(parser.get_headers() == std::vector<std::string>{"b", "d"},
+              true, "projection should keep columns in file order");
+  test_assert(parser.get_malformed_count(), static_cast<size_t>(1),
+              "rows are checked against every field");
+  test_assert(parser.get_column("b")[0], std::string("x, y"),
+              "projected text should be copied");
+  test_assert(parser.get_table().get_column(1).get_double(1), 7.5,
+              "projected numbers should be typed");
+
+  CsvParser cached;
+  cached.set_snapshot_file("test_projection.bin");
+  cached.set_projection({"c"});
+  cached.load_file("test_projection.csv");
+  test_assert(cached.get_column_count(), static_cast<size_t>(1),
+              "snapshot runs should be projected too");
+  SnapshotInfo info;
+  test_assert(read_snapshot_info("test_projection.bin", info) &&
+                  info.column_count == 4,
+              true, "snapshot should hold every column");
+
+  CsvParser reloaded;
+  reloaded.set_snapshot_file("test_projection.bin");
+  reloaded.set_projection({"a", "c"});
+  reloaded.load_file("test_projection.csv");
+  test_assert(reloaded.is_from_snapshot() &&
+                  reloaded.get_headers() ==
+                      std::vector<std::string>{"a", "c"},
+              true, "snapshot should serve another projection");
+
+  std::remove("test_projection.csv");
+  std::remove("test_projection.bin");
+
+  std::cout << "Column projection tests passed!" << std::endl;
+}
+
+void test_csv_writer_round_trip() {
+  std::cout << "Testing CSV writer round trip..." << std::endl;
+
+  const std::string long_text(100000, 'x');
+  std::vector<std::vector<std::string>> rows = {
+      {"1", "plain", "2.50"},
+      {"2", "has, comma", "-0.75"},
+      {"3", "say \"hi\"", ""},
+      {"4", "two\nlines", "1e3"},
+      {"5", long_text, "12.25"},
+  };
+  Table table = Table::from_rows({"id", "text, quoted", "value"}, rows);
+
+  CsvWriter writer;
+  writer.set_buffer_size(64 * 1024); // Forces flushes and a vectored write
+  test_assert(writer.open("test_writer.csv", ','), true,
+              "writer should open the output file");
+  writer.write_header(table.get_headers());
+  writer.write_table(table);
+  test_assert(writer.close(), true, "writer should close cleanly");
+  test_assert(writer.get_rows_written(), static_cast<size_t>(5),
+              "writer should count data rows");
+
+  CsvParser parser;
+  parser.load_file("test_writer.csv");
+  test_assert(parser.get_headers()[1], std::string("text, quoted"),
+              "quoted header should round-trip");
+  auto data = parser.get_data();
+  test_assert(data.size(), rows.size(), "every row should be read");
+  for (size_t row = 0; row < rows.size(); ++row) {
+    test_assert(data[row][1], rows[row][1],
+                "text cell " + std::to_string(row + 1) + " should round-trip");
+  }
+  test_assert(data[2][2], std::string(""), "null cell should stay empty");
+  test_assert(data[3][2], std::string("1000"),
+              "mixed precision should use the shortest form");
+
+  // Clean up
+  std::remove("test_writer.csv");
+
+  std::cout << "CSV writer round trip tests passed!" << std::endl;
+}
+
+void test_compressed_round_trip() {
+  std::cout << "Testing compressed input and output..." << std::endl;
+
+  test_assert(stream_compression_for_path("out.csv.gz") ==
+                      StreamCompression::GZIP &&
+                  stream_compression_for_path("out.csv.zst") ==
+                      StreamCompression::ZSTD &&
+                  stream_compression_for_path("out.csv") ==
+                      StreamCompression::NONE,
+              true, "compression should follow the extension");
+  if (!stream_compression_available(StreamCompression::GZIP)) {
+    std::cout << "gzip support not built, skipping" << std::endl;
+    return;
+  }
+
+  std::vector<std::vector<std::string>> rows;
+  for (int i = 0; i < 20000; ++i) {
+    rows.push_back({std::to_string(i), "item \"" + std::to_string(i % 13) +
+                                           "\"\nline two",
+                    std::to_string(i % 100) + ".25"});
+  }
+  Table table = Table::from_rows({"id", "text", "value"}, rows);
+
+  // Several buffers of several blocks each
+  CsvWriter writer;
+  writer.set_buffer_size(256 * 1024);
+  test_assert(writer.open("test_compressed.csv.gz", ','), true,
+              "writer should open compressed output");
+  writer.write_header(table.get_headers());
+  writer.write_table(table);
+  test_assert(writer.close(), true, "compressed writer should close cleanly");
+  test_assert(writer.get_compression() == StreamCompression::GZIP, true,
+              "writer should compress a .gz file");
+
+  CsvParser parser;
+  parser.set_thread_count(4);
+  test_assert(parser.load_file("test_compressed.csv.gz"), true,
+              "parser should load gzip input");
+  test_assert(parser.get_table().to_rows() == table.to_rows(), true,
+              "blocks decoded in parallel should reproduce every cell");
+
+  CsvStreamReader reader;
+  reader.set_buffer_size(4096);
+  test_assert(reader.open("test_compressed.csv.gz", ','), true,
+              "stream reader should open gzip input");
+  test_assert(reader.get_compression() == StreamCompression::GZIP, true,
+              "stream reader should detect gzip by its magic number");
+  TableBuilder builder(reader.get_headers());
+  while (reader.read_batch(builder, 1000) > 0) {
+  }
+  test_assert(builder.finish().to_rows() == table.to_rows(), true,
+              "streamed gzip should reproduce every cell");
+
+#ifdef ADAPTER_HAVE_ZLIB
+  // Ordinary gzip without block sizes is decoded serially
+  const std::string text = "a,b\n1,x\n2,y\n";
+  gzFile plain = gzopen("test_plain.gz", "wb");
+  gzwrite(plain, text.data(), static_cast<unsigned>(text.size()));
+  gzclose(plain);
+  CsvParser serial;
+  serial.set_thread_count(4);
+  serial.load_file("test_plain.gz");
+  test_assert(serial.get_row_count(), static_cast<size_t>(2),
+              "plain gzip should load");
+  test_assert(serial.get_data()[1][1], std::string("y"),
+              "plain gzip should decode every cell");
+#endif
+
+  std::ifstream in("test_compressed.csv.gz", std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+  std::vector<char> decoded;
+  test_assert(decompress_buffer(bytes.data(), bytes.size() / 2,
+                                StreamCompression::GZIP, decoded, 2),
+              false, "truncated input should fail to decode");
+
+  std::remove("test_compressed.csv.gz");
+  std::remove("test_plain.gz");
+
+  std::cout << "Compressed input and output tests passed!" << std::endl;
+}
+
+void test_arrow_writer() {
+  std::cout << "Testing Arrow IPC output..." << std::endl;
+
+  Column ids("id", ColumnType::INT64);
+  Column values("value", ColumnType::FLOAT64);
+  Column labels("label", ColumnType::STRING);
+  values.set_precision(2);
+  for (int64_t i = 0; i < 100; ++i) {
+    ids.append_int(i * 1000003);
+    if (i % 10 == 0) {
+      values.append_null();
+    } else {
+      values.append_double(static_cast<double>(i) / 4);
+    }
+    labels.append_string(i % 2 == 0 ? "even" : "odd");
+  }
+  Table table;
+  table.add_column(std::move(ids));
+  table.add_column(std::move(values));
+  table.add_column(std::move(labels));
+
+  uint64_t bytes_written = 0;
+  test_assert(write_arrow_file(table, "test_output.arrow", &bytes_written),
+              true, "Arrow file should be written");
+  std::ifstream in("test_output.arrow", std::ios::binary);
+  const std::string bytes((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+  test_assert(static_cast<uint64_t>(bytes.size()), bytes_written,
+              "writer should report the file size");
+  test_assert(bytes.compare(0, 8, std::string("ARROW1\0\0", 8)) == 0 &&
+                  bytes.compare(bytes.size() - 6, 6, "ARROW1") == 0,
+              true, "file should start and end with the Arrow magic");
+
+  int32_t footer_size = 0;
+  std::memcpy(&footer_size, bytes.data() + bytes.size() - 10, 4);
+  test_assert(footer_size > 0 &&
+                  static_cast<size_t>(footer_size) + 18 < bytes.size(),
+              true, "footer size should fit the file");
+
+  // Arrays are stored exactly as the columns hold them
+  const std::vector<int64_t> &raw = table.get_column(0).get_ints();
+  const std::string ints(reinterpret_cast<const char *>(raw.data()),
+                         raw.size() * sizeof(int64_t));
+  const size_t ints_at = bytes.find(ints);
+  test_assert(ints_at != std::string::npos && ints_at % 64 == 0, true,
+              "int64 values should be stored in place on a 64-byte boundary");
+  test_assert(bytes.find("evenodd") != std::string::npos, true,
+              "dictionary should hold each label once");
+  test_assert(bytes.find("adapter.precision") != std::string::npos, true,
+              "precision should be kept in the field metadata");
+
+  OutputFormat format = OutputFormat::CSV;
+  test_assert(parse_output_format("feather", format) &&
+                  format == OutputFormat::ARROW,
+              true, "feather should select Arrow output");
+  test_assert(parse_output_format("parquet", format), false,
+              "unsupported formats should be rejected");
+
+  std::remove("test_output.arrow");
+
+  std::cout << "Arrow IPC output tests passed!" << std::endl;
+}
+
 int main() {
   try {
     test_csv_parser_basic_functionality();
     test_csv_parser_different_delimiters();
     test_csv_parser_quoted_fields();
+    test_csv_parser_escaped_quotes_and_newlines();
+    test_structural_scanner_kernels();
+    test_tokenizer_across_blocks();
+    test_csv_parser_parallel_matches_serial();
+    test_csv_parser_take_table();
+    test_csv_parser_snapshot();
+    test_csv_parser_projection();
+    test_csv_writer_round_trip();
+    test_compressed_round_trip();
+    test_arrow_writer();
 
     std::cout << std::endl
               << "All CSV Parser tests passed successfully!" << std::endl;
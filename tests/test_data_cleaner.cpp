@@ -1,6 +1,14 @@
+#include "adapter/column_stats.hpp"
 #include "adapter/data_cleaner.hpp"
+#include "adapter/numeric_kernels.hpp"
+#include "adapter/row_deduplicator.hpp"
+#include "adapter/value_parser.hpp"
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <random>
 
 using namespace adapter;
 
@@ -65,6 +73,62 @@ void test_data_cleaner_duplicate_removal() {
   std::cout << "Data Cleaner duplicate removal tests passed!" << std::endl;
 }
 
+void test_row_deduplicator() {
+  std::cout << "Testing row deduplicator..." << std::endl;
+
+  Table table = Table::from_rows({"time", "sensor", "value"},
+                                 {{"0", "a", "1.5"},
+                                  {"0", "b", "1.5"},
+                                  {"0", "a", "2.5"}, // Same key as row 0
+                                  {"1", "a", ""},
+                                  {"1", "a", "NA"}}); // Null like row 3
+
+  RowDeduplicator whole_row;
+  whole_row.set_exact_verify(true);
+  Table copy = table;
+  test_assert(whole_row.deduplicate(copy), static_cast<size_t>(1),
+              "only the all-null repeat should be removed");
+
+  RowDeduplicator keyed;
+  keyed.set_key_columns({"time", "sensor"});
+  test_assert(keyed.deduplicate(table), static_cast<size_t>(2),
+              "rows with repeated keys should be removed");
+  test_assert(table.get_row_count(), static_cast<size_t>(3),
+              "three key combinations should remain");
+  test_assert(table.get_column(2).to_string(1), std::string("1.5"),
+              "first occurrence of each key should be kept");
+
+  // Later batches are checked against everything seen before
+  Table batch = Table::from_rows({"time", "sensor", "value"},
+                                 {{"0", "b", "9.0"}, {"2", "a", "1.0"}});
+  test_assert(keyed.deduplicate(batch), static_cast<size_t>(1),
+              "keys from an earlier table should be remembered");
+
+  std::vector<std::vector<std::string>> data = {
+      {"x", "y"}, {"1", "2"}, {"3"}, {"1", "2"}, {"3"}, {"3", ""}};
+  RowDeduplicator rows;
+  rows.set_exact_verify(true);
+  test_assert(rows.deduplicate(data), static_cast<size_t>(2),
+              "row-based duplicates should be removed");
+  test_assert(data.size(), static_cast<size_t>(4),
+              "ragged rows should only match rows of the same length");
+
+  RowDeduplicator streaming;
+  streaming.set_headers({"a", "b"});
+  test_assert(streaming.insert({"1.0", "x"}), true,
+              "first streamed row should be new");
+  test_assert(streaming.insert({"1.00", "x"}), false,
+              "streamed numbers should compare by value");
+  test_assert(streaming.insert({"1.0", "NA"}), true,
+              "streamed null should differ from text");
+  test_assert(streaming.insert({"1.0", ""}), false,
+              "streamed missing tokens should compare equal");
+  test_assert(streaming.get_unique_count(), static_cast<size_t>(2),
+              "two unique streamed rows should be stored");
+
+  std::cout << "Row deduplicator tests passed!" << std::endl;
+}
+
 void test_data_cleaner_format_normalization() {
   std::cout << "Testing Data Cleaner format normalization..." << std::endl;
 
@@ -87,6 +151,71 @@ void test_data_cleaner_format_normalization() {
   std::cout << "Data Cleaner format normalization tests passed!" << std::endl;
 }
 
+void test_value_classification() {
+  std::cout << "Testing value classification..." << std::endl;
+
+  test_assert(classify_number("-12.5"), true, "signed decimal is numeric");
+  test_assert(classify_number(".5"), true, "leading point is numeric");
+  test_assert(classify_number("+7"), true, "leading plus is numeric");
+  test_assert(classify_number("6.02e23"), true, "exponent is numeric");
+  test_assert(classify_number("1E-3"), true, "signed exponent is numeric");
+  test_assert(classify_number("5."), false, "trailing point is rejected");
+  test_assert(classify_number("1e"), false, "empty exponent is rejected");
+  test_assert(classify_number("-"), false, "bare sign is rejected");
+  test_assert(classify_number("inf"), false, "inf is rejected");
+  test_assert(classify_number("12abc"), false, "trailing text is rejected");
+
+  double value = 0.0;
+  test_assert(parse_number("+1.5e2", value) && value == 150.0, true,
+              "plus sign and exponent should convert");
+  int64_t integer = 0;
+  test_assert(parse_integer("+42", integer) && integer == 42, true,
+              "plus sign integer should convert");
+  test_assert(parse_integer("4.2", integer), false,
+              "decimal is not an integer");
+
+  DateTimeFields fields;
+  test_assert(find_iso_datetime("at 2024-03-05T06:07:08Z", fields), true,
+              "embedded datetime should be found");
+  test_assert(fields.year == 2024 && fields.month == 3 && fields.day == 5 &&
+                  fields.hour == 6 && fields.minute == 7 && fields.second == 8,
+              true, "datetime fields should be read");
+  test_assert(find_iso_datetime("2024-03-05", fields) && !fields.has_time,
+              true, "date-only value should be found");
+  test_assert(contains_iso_date("01/15/2021"), false,
+              "other date layouts are not ISO dates");
+
+  double seconds = 0.0;
+  test_assert(parse_iso_timestamp("2024-03-05T06:07:08Z", seconds) &&
+                  seconds == 1709618828.0,
+              true, "UTC timestamp should convert to epoch seconds");
+  test_assert(parse_iso_timestamp("2024-03-05T08:37:08.25+02:30", seconds) &&
+                  seconds == 1709618828.25,
+              true, "offset and fraction should be applied");
+  test_assert(parse_iso_timestamp("1969-12-31 23:59", seconds) &&
+                  seconds == -60.0,
+              true, "times before the epoch should convert");
+  test_assert(parse_iso_timestamp("2024-13-01", seconds), false,
+              "month out of range should be rejected");
+  test_assert(parse_iso_timestamp("2024-03-05T06:07:08 trailing", seconds),
+              false, "trailing text should be rejected");
+  test_assert(days_from_civil(2000, 2, 29), static_cast<int64_t>(11016),
+              "leap day should count from the epoch");
+  test_assert(format_iso_timestamp(1709618828.5),
+              std::string("2024-03-05T06:07:08.5"),
+              "fractional seconds should be formatted");
+  test_assert(format_iso_timestamp(-1.0), std::string("1969-12-31T23:59:59"),
+              "negative timestamps should format before the epoch");
+
+  DataCleaner cleaner;
+  std::vector<std::vector<std::string>> data = {{"a"}, {"+1.5e2"}};
+  cleaner.normalize_formats(data);
+  test_assert(data[1][0], std::string("150.00"),
+              "scientific notation should be normalized");
+
+  std::cout << "Value classification tests passed!" << std::endl;
+}
+
 void test_data_cleaner_complete_workflow() {
   std::cout << "Testing Data Cleaner complete workflow..." << std::endl;
 
@@ -111,12 +240,114 @@ void test_data_cleaner_complete_workflow() {
   std::cout << "Data Cleaner complete workflow tests passed!" << std::endl;
 }
 
+void test_column_statistics() {
+  std::cout << "Testing column statistics and per-column strategies..."
+            << std::endl;
+
+  Table table = Table::from_rows({"a", "b", "label"}, {{"2", "1.5", "x"},
+                                                       {"4", "", "y"},
+                                                       {"", "2.5", ""},
+                                                       {"9", "10.5", "x"}});
+  ColumnStats stats = compute_column_stats(table.get_column(0), true);
+  test_assert(stats.numeric_count, static_cast<size_t>(3),
+              "stats should count numeric values");
+  test_assert(stats.null_count, static_cast<size_t>(1),
+              "stats should count nulls");
+  test_assert(stats.min == 2.0 && stats.max == 9.0 && stats.sum == 15.0,
+              true, "stats should track min, max and sum");
+  test_assert(std::abs(stats.variance - 13.0) < 1e-12, true,
+              "Welford variance should match the two-pass value");
+  test_assert(stats.median, 4.0, "median should be exact");
+  test_assert(compute_column_stats(table.get_column(2)).numeric, false,
+              "text column should not be numeric");
+
+  MedianEstimator estimator(8);
+  for (int i = 1000; i >= 0; --i) {
+    estimator.add(static_cast<double>(i));
+  }
+  test_assert(std::abs(estimator.get_median() - 500.0) < 25.0, true,
+              "median estimate should be close past the exact limit");
+
+  DataCleaner cleaner;
+  cleaner.set_missing_value_strategies({"median", "mean", "b:none"});
+  test_assert(cleaner.get_missing_value_strategy(0, "a"), std::string("median"),
+              "first positional entry should apply to column 0");
+  test_assert(cleaner.get_missing_value_strategy(2, "label"),
+              std::string("mean"),
+              "last positional entry should cover remaining columns");
+  test_assert(cleaner.get_missing_value_strategy(1, "b"), std::string("none"),
+              "named entry should override position");
+
+  cleaner.handle_missing_values(table);
+  test_assert(table.get_column(0).get_int(2), static_cast<int64_t>(4),
+              "column a should be filled with its median");
+  test_assert(table.get_column(1).is_valid(1), false,
+              "column b should be left missing");
+  test_assert(table.get_column(2).get_string(2), std::string("0"),
+              "text column should fall back to zero");
+  test_assert(cleaner.get_column_stats().size(), static_cast<size_t>(3),
+              "cleaner should keep stats for every column");
+  test_assert(cleaner.get_column_stats()[1].null_count, static_cast<size_t>(1),
+              "kept stats should describe the data before filling");
+
+  std::cout << "Column statistics tests passed!" << std::endl;
+}
+
+void test_rounding_kernels() {
+  std::cout << "Testing vectorized rounding kernels..." << std::endl;
+
+  std::vector<double> inputs = {0.5,     -0.5,     1.005,   2.675,   -2.675,
+                                0.125,   -0.125,   1e300,   -1e300,  1e-300,
+                                -0.0,    0.0,      4.5e15,  123.456, -0.004,
+                                0.49999999999999994};
+  inputs.push_back(std::numeric_limits<double>::quiet_NaN());
+  inputs.push_back(std::numeric_limits<double>::infinity());
+  inputs.push_back(-std::numeric_limits<double>::infinity());
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<double> spread(-1e6, 1e6);
+  for (int i = 0; i < 1000; ++i) {
+    inputs.push_back(spread(random));
+    // Exact ties once scaled by 10^3
+    inputs.push_back(std::round(spread(random)) + 0.0625);
+  }
+
+  const ScannerKernel kernels[] = {ScannerKernel::SCALAR, ScannerKernel::SSE42,
+                                   ScannerKernel::AVX2};
+  for (int precision : {0, 2, 3, 6}) {
+    const double scale = std::pow(10.0, precision);
+    for (ScannerKernel kernel : kernels) {
+      if (!StructuralScanner::is_kernel_supported(kernel)) {
+        continue;
+      }
+      std::vector<double> values = inputs;
+      round_to_precision(values.data(), values.size(), precision, kernel);
+      size_t mismatches = 0;
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        const double expected = std::round(inputs[i] * scale) / scale;
+        if (std::memcmp(&expected, &values[i], sizeof(double)) != 0) {
+          ++mismatches;
+        }
+      }
+      test_assert(mismatches, static_cast<size_t>(0),
+                  std::string(StructuralScanner::kernel_name(kernel)) +
+                      " kernel should match std::round at precision " +
+                      std::to_string(precision));
+    }
+  }
+
+  std::cout << "Rounding kernel tests passed!" << std::endl;
+}
+
 int main() {
   try {
     test_data_cleaner_missing_values();
     test_data_cleaner_duplicate_removal();
+    test_row_deduplicator();
     test_data_cleaner_format_normalization();
+    test_value_classification();
     test_data_cleaner_complete_workflow();
+    test_column_statistics();
+    test_rounding_kernels();
 
     std::cout << std::endl
               << "All Data Cleaner tests passed successfully!" << std::endl;
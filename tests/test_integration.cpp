@@ -1,10 +1,23 @@
+#include "adapter/batch_runner.hpp"
 #include "adapter/config_manager.hpp"
 #include "adapter/csv_parser.hpp"
+#include "adapter/csv_writer.hpp"
 #include "adapter/data_cleaner.hpp"
+#include "adapter/incremental_pipeline.hpp"
+#include "adapter/merge_aligner.hpp"
+#include "adapter/metrics.hpp"
+#include "adapter/pipeline_spec.hpp"
+#include "adapter/stream_pipeline.hpp"
+#include "adapter/thread_pool.hpp"
 #include "adapter/time_aligner.hpp"
+#include "adapter/time_index.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 using namespace adapter;
 
@@ -144,6 +157,559 @@ void test_config_file_operations() {
   std::cout << "Configuration file operations test passed!" << std::endl;
 }
 
+void test_pipeline_spec() {
+  std::cout << "Testing pipeline spec resolution..." << std::endl;
+
+  {
+    std::ofstream file("test_spec_config.txt");
+    file << "solver_method=heun\n"
+            "aggregation=median\n"
+            "missing_value_strategies=median,flow:none\n"
+            "column_types=zip:text\n"
+            "output_format=feather\n"
+            "threads=0\n";
+  }
+  ConfigManager config;
+  test_assert(config.load_from_file("test_spec_config.txt"),
+              "spec configuration should load");
+  std::remove("test_spec_config.txt");
+
+  PipelineSpec spec;
+  test_assert(resolve_pipeline_spec(config, spec), "spec should resolve");
+  test_assert(spec.solver_method == SolverMethod::HEUN,
+              "solver should resolve to its enum");
+  test_assert(spec.aggregation == ResampleAggregation::NONE,
+              "an unknown aggregation should fall back to interpolation");
+  test_assert(spec.output_format == OutputFormat::ARROW,
+              "feather should select Arrow output");
+  test_assert(spec.thread_count >= 1, "0 threads should mean every core");
+  test_assert(spec.inference.column_kinds.count("zip") == 1 &&
+                  spec.inference.column_kinds.at("zip") == ColumnKind::TEXT,
+              "column types should resolve to kinds");
+
+  DataCleaner cleaner;
+  spec.configure(cleaner);
+  test_assert(cleaner.resolve_missing_value_strategy(3, "temp") ==
+                  MissingValueStrategy::MEDIAN,
+              "positional strategies should carry over");
+  test_assert(cleaner.resolve_missing_value_strategy(0, "flow") ==
+                  MissingValueStrategy::NONE,
+              "named strategies should carry over");
+
+  ConfigManager bad;
+  bad.set_output_format("xml");
+  test_assert(!resolve_pipeline_spec(bad, spec),
+              "an unknown output format should fail");
+
+  std::cout << "Pipeline spec test passed!" << std::endl;
+}
+
+std::string read_file(const std::string &path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+void test_streaming_pipeline() {
+  std::cout << "Testing streaming pipeline..." << std::endl;
+
+  std::ofstream test_file("stream_test_data.csv");
+  test_file << "time,temperature,status\n";
+  test_file << "0,20.5,ok\n";
+  test_file << "1,,\"multi\nline\"\n";
+  test_file << "2,21.25,\n";
+  test_file << "0,20.5,ok\n"; // Duplicate from an earlier batch
+  test_file << "3,22.0\n";    // Malformed
+  test_file << "4,NaN,ok\n";
+  test_file << "5,23.75,warn\n";
+  test_file.close();
+
+  for (const std::string strategy : {"mean", "median"}) {
+    DataCleaner cleaner;
+    cleaner.set_missing_value_strategies({strategy});
+
+    CsvParser parser;
+    parser.load_file("stream_test_data.csv");
+    Table table = parser.get_table();
+    cleaner.clean_data(table);
+
+    CsvWriter writer;
+    writer.open("stream_expected.csv", ',');
+    writer.write_header(table.get_headers());
+    writer.write_table(table);
+    writer.close();
+
+    StreamingPipeline pipeline;
+    pipeline.set_batch_size(2);
+    bool ran = pipeline.run("stream_test_data.csv", "stream_output.csv",
+                            cleaner);
+    test_assert(ran, "streaming run should succeed (" + strategy + ")");
+    test_assert(pipeline.get_batch_count() == 3,
+                "six unique rows should take three batches");
+    test_assert(read_file("stream_output.csv") ==
+                    read_file("stream_expected.csv"),
+                "streamed output should match in-memory cleaning (" +
+                    strategy + ")");
+
+    for (size_t depth : {0, 1}) {
+      pipeline.set_queue_depth(depth);
+      pipeline.run("stream_test_data.csv", "stream_output.csv", cleaner);
+      test_assert(read_file("stream_output.csv") ==
+                          read_file("stream_expected.csv") &&
+                      pipeline.get_duplicates_removed() == 1,
+                  "output should not depend on the queue depth (" +
+                      std::to_string(depth) + ")");
+    }
+  }
+
+  std::remove("stream_test_data.csv");
+  std::remove("stream_expected.csv");
+  std::remove("stream_output.csv");
+
+  std::cout << "Streaming pipeline test passed!" << std::endl;
+}
+
+void test_streaming_median_estimate() {
+  std::cout << "Testing streaming median estimate..." << std::endl;
+
+  // Enough values to move past the exact median onto the estimator
+  std::ofstream test_file("stream_median_data.csv");
+  test_file << "id,value\n";
+  const int rows = 200000;
+  for (int i = 0; i < rows; ++i) {
+    test_file << i << "," << (i * 7919) % 1000 << "\n";
+  }
+  test_file << rows << ",\n";
+  test_file.close();
+
+  DataCleaner cleaner;
+  cleaner.set_missing_value_strategies({"median"});
+  StreamingPipeline pipeline;
+  pipeline.set_batch_size(50000);
+  bool ran = pipeline.run("stream_median_data.csv", "stream_median_out.csv",
+                          cleaner);
+  test_assert(ran, "streaming median run should succeed");
+
+  std::string contents = read_file("stream_median_out.csv");
+  size_t last_line = contents.find_last_of('\n', contents.size() - 2);
+  std::string last_row = contents.substr(last_line + 1);
+  double filled = std::stod(last_row.substr(last_row.find(',') + 1));
+  test_assert(filled > 490.0 && filled < 510.0,
+              "estimated median should be close to the exact one");
+
+  std::remove("stream_median_data.csv");
+  std::remove("stream_median_out.csv");
+
+  std::cout << "Streaming median estimate test passed!" << std::endl;
+}
+
+std::string run_wide_pipeline(size_t thread_count) {
+  CsvParser parser;
+  parser.set_thread_count(thread_count);
+  parser.load_file("parallel_test_data.csv");
+  Table table = parser.get_table();
+
+  DataCleaner cleaner;
+  cleaner.set_thread_count(thread_count);
+  cleaner.clean_data(table);
+
+  TimeAligner aligner;
+  aligner.set_thread_count(thread_count);
+  aligner.set_target_time_interval(0.5);
+  aligner.set_derivative_columns({"c1", "c2"});
+  aligner.align_time_series_data(table, "time", {}, {});
+
+  const std::string output =
+      "parallel_out_" + std::to_string(thread_count) + ".csv";
+  CsvWriter writer;
+  writer.open(output, ',');
+  writer.write_header(table.get_headers());
+  writer.write_table(table);
+  writer.close();
+  std::string contents = read_file(output);
+  std::remove(output.c_str());
+  return contents;
+}
+
+void test_parallel_columns() {
+  std::cout << "Testing parallel per-column processing..." << std::endl;
+
+  const int columns = 64;
+  std::ofstream test_file("parallel_test_data.csv");
+  test_file << "time";
+  for (int col = 0; col < columns; ++col) {
+    test_file << ",c" << col;
+  }
+  test_file << "\n";
+  for (int row = 0; row < 200; ++row) {
+    test_file << row * 0.75;
+    for (int col = 0; col < columns; ++col) {
+      const int value = (row * 31 + col * 17) % 97;
+      test_file << ",";
+      if (value % 11 != 0) {
+        test_file << (col % 2 ? "" : "x") << value;
+      }
+    }
+    test_file << "\n";
+  }
+  test_file.close();
+
+  const std::string serial = run_wide_pipeline(1);
+  test_assert(!serial.empty(), "serial run should produce output");
+  test_assert(run_wide_pipeline(4) == serial,
+              "four threads should match the serial output");
+  test_assert(run_wide_pipeline(7) == serial,
+              "seven threads should match the serial output");
+
+  // Tasks submitted from inside a task stay on the pool and all complete
+  ThreadPool pool(4);
+  std::atomic<int> finished(0);
+  pool.parallel_for(8, [&](size_t) {
+    for (int i = 0; i < 8; ++i) {
+      pool.submit([&finished] { ++finished; });
+    }
+  });
+  pool.wait();
+  test_assert(finished.load() == 64, "nested tasks should all run");
+
+  std::remove("parallel_test_data.csv");
+
+  std::cout << "Parallel per-column test passed!" << std::endl;
+}
+
+void test_time_index_alignment() {
+  std::cout << "Testing gap-aware alignment and resampling..." << std::endl;
+
+  // Out of order, with an outage between t=2 and t=10
+  Table table = Table::from_rows({"time", "value"}, {{"10", "10"},
+                                                     {"0", "0"},
+                                                     {"2", "2"},
+                                                     {"1", "1"},
+                                                     {"11", "11"}});
+  TimeAligner aligner;
+  aligner.set_max_gap(3.0);
+  aligner.align_time_series_data(table, "time", {}, {});
+  const Column &values = table.get_column(1);
+  test_assert(table.get_row_count() == 12, "grid should span the samples");
+  test_assert(values.is_valid(2) && values.get_double(2) == 2.0 &&
+                  values.get_double(10) == 10.0,
+              "samples at grid points should be kept");
+  test_assert(!values.is_valid(3) && !values.is_valid(9) &&
+                  values.get_null_count() == 7,
+              "points inside the outage should be null");
+  test_assert(aligner.get_gap_point_count() == 7,
+              "gap points should be counted");
+
+  std::vector<std::vector<std::string>> rows;
+  for (int i = 0; i < 12; ++i) {
+    rows.push_back({std::to_string(i * 0.25), std::to_string(i),
+                    i == 11 ? "" : "s" + std::to_string(i)});
+  }
+  for (ResampleAggregation aggregation :
+       {ResampleAggregation::MEAN, ResampleAggregation::MAX}) {
+    Table samples = Table::from_rows({"time", "value", "label"}, rows);
+    TimeAligner resampler;
+    resampler.set_aggregation(aggregation);
+    resampler.align_time_series_data(samples, "time", {}, {});
+    test_assert(samples.get_row_count() == 3,
+                "resampling should emit one row per bucket");
+    test_assert(samples.get_column(1).get_double(0) ==
+                    (aggregation == ResampleAggregation::MEAN ? 1.5 : 3.0),
+                "bucket should aggregate its samples");
+    test_assert(samples.get_column(2).get_string(2) == "s10",
+                "text should take the last valid value");
+  }
+
+  // Parallel sorting matches a serial stable sort, ties included
+  std::vector<double> times;
+  std::vector<size_t> positions;
+  for (size_t i = 0; i < 3 * TimeIndex::min_parallel_sort; ++i) {
+    times.push_back(static_cast<double>((i * 7919) % 1000));
+    positions.push_back(i);
+  }
+  TimeIndex serial;
+  serial.build(times, positions);
+  ThreadPool pool(4);
+  TimeIndex parallel;
+  parallel.build(times, positions, &pool);
+  test_assert(!parallel.was_sorted() &&
+                  parallel.get_rows() == serial.get_rows() &&
+                  std::is_sorted(parallel.get_times().begin(),
+                                 parallel.get_times().end()),
+              "parallel sort should be stable and match the serial sort");
+
+  std::cout << "Gap-aware alignment test passed!" << std::endl;
+}
+
+void test_merge_aligner() {
+  std::cout << "Testing multi-file merge alignment..." << std::endl;
+
+  std::ofstream left("merge_left.csv");
+  left << "time,temp\n0,0\n2,2\n1,9\n4,4\n";
+  left.close();
+  std::ofstream right("merge_right.csv");
+  right << "time,temp,state\n1,10,a\n3,30,b\n5,50,c\n";
+  right.close();
+
+  MergeAligner merger;
+  merger.set_buffer_size(4096);
+  test_assert(merger.run({"merge_left.csv", "merge_right.csv"},
+                         "merge_out.csv"),
+              "merge should succeed");
+  const std::string expected =
+      "time,merge_left.temp,merge_right.temp,state\n"
+      "1970-01-01T00:00:00,0.000000,,\n"
+      "1970-01-01T00:00:01,1.000000,10.000000,a\n"
+      "1970-01-01T00:00:02,2.000000,20.000000,a\n"
+      "1970-01-01T00:00:03,3.000000,30.000000,b\n"
+      "1970-01-01T00:00:04,4.000000,40.000000,b\n"
+      "1970-01-01T00:00:05,,50.000000,c\n";
+  test_assert(read_file("merge_out.csv") == expected,
+              "files should be merged onto one grid");
+  test_assert(merger.get_rows_written() == 6 &&
+                  merger.get_out_of_order_count() == 1,
+              "merge should count rows and out-of-order samples");
+
+  merger.set_max_gap(1.5);
+  merger.run({"merge_left.csv", "merge_right.csv"}, "merge_out.csv");
+  test_assert(read_file("merge_out.csv").find(
+                  "1970-01-01T00:00:03,,30.000000,b\n") != std::string::npos,
+              "points inside a long gap should be left empty");
+
+  std::remove("merge_left.csv");
+  std::remove("merge_right.csv");
+  std::remove("merge_out.csv");
+
+  std::cout << "Multi-file merge test passed!" << std::endl;
+}
+
+void test_incremental_pipeline() {
+  std::cout << "Testing incremental runs over a growing file..." << std::endl;
+
+  const std::string header = "time,temp,state\n";
+  const std::string first = "0,1.5,a\n1,2.5,a\n3,4.0,b\n";
+  // The last line is still being written when the first run starts
+  const std::string second = "4,,b\n3,4.0,b\n6,8.5,c\n";
+  std::ofstream full("incremental_full.csv");
+  full << header << first << second;
+  full.close();
+  std::ofstream growing("incremental_input.csv");
+  growing << header << first << "4,";
+  growing.close();
+
+  auto run = [](const std::string &input, const std::string &output,
+                const std::string &state, IncrementalPipeline &pipeline) {
+    DataCleaner cleaner;
+    cleaner.set_missing_value_strategies({"mean"});
+    TimeAligner aligner;
+    aligner.set_target_time_interval(1.0);
+    aligner.set_derivative_columns({"temp"});
+    aligner.set_alignment_columns("time", {}, {});
+    return pipeline.run(input, output, state, cleaner, &aligner);
+  };
+
+  std::remove("incremental_state.bin");
+  IncrementalPipeline pipeline;
+  test_assert(run("incremental_input.csv", "incremental_out.csv",
+                  "incremental_state.bin", pipeline),
+              "first incremental run should succeed");
+  test_assert(!pipeline.was_resumed() && pipeline.get_rows_read() == 3,
+              "first run should stop before the incomplete line");
+
+  std::ofstream append("incremental_input.csv", std::ios::app);
+  append << second.substr(2);
+  append.close();
+  test_assert(run("incremental_input.csv", "incremental_out.csv",
+                  "incremental_state.bin", pipeline),
+              "second incremental run should succeed");
+  test_assert(pipeline.was_resumed() && pipeline.get_rows_read() == 3 &&
+                  pipeline.get_duplicates_removed() == 1,
+              "second run should only read the appended rows");
+
+  // A fresh run over the whole file is the reference
+  std::remove("incremental_full_state.bin");
+  IncrementalPipeline reference;
+  run("incremental_full.csv", "incremental_full_out.csv",
+      "incremental_full_state.bin", reference);
+  test_assert(read_file("incremental_out.csv") ==
+                  read_file("incremental_full_out.csv"),
+              "appended output should match a full run");
+  test_assert(read_file("incremental_out.csv")
+                      .find("1970-01-01T00:00:04,4.130000,b,") !=
+                  std::string::npos,
+              "missing values should be imputed with the running mean");
+
+  // An unchanged input appends nothing
+  const std::string before = read_file("incremental_out.csv");
+  run("incremental_input.csv", "incremental_out.csv", "incremental_state.bin",
+      pipeline);
+  test_assert(pipeline.get_rows_read() == 0 &&
+                  read_file("incremental_out.csv") == before,
+              "a run without new rows should leave the output alone");
+
+  // A rewritten input is processed from the start
+  std::ofstream rewritten("incremental_input.csv");
+  rewritten << header << "0,9.0,z\n2,9.0,z\n";
+  rewritten.close();
+  run("incremental_input.csv", "incremental_out.csv", "incremental_state.bin",
+      pipeline);
+  test_assert(!pipeline.was_resumed() &&
+                  read_file("incremental_out.csv").find(",z,") !=
+                      std::string::npos &&
+                  read_file("incremental_out.csv").find(",a,") ==
+                      std::string::npos,
+              "a rewritten input should be reprocessed in full");
+
+  for (const char *file :
+       {"incremental_full.csv", "incremental_input.csv", "incremental_out.csv",
+        "incremental_state.bin", "incremental_full_out.csv",
+        "incremental_full_state.bin"}) {
+    std::remove(file);
+  }
+
+  std::cout << "Incremental pipeline test passed!" << std::endl;
+}
+
+void test_batch_runner() {
+  std::cout << "Testing batch runner..." << std::endl;
+
+  for (const char *name : {"batch_a.csv", "batch_b.csv"}) {
+    std::ofstream file(name);
+    file << "time,value,status\n";
+    file << "0,1.5,ok\n";
+    file << "1,,ok\n";
+    file << "1,,ok\n"; // Duplicate
+    file << "2,3.5,warn\n";
+  }
+
+  BatchJob job;
+  test_assert(!parse_batch_job("  # comment", job),
+              "comment lines should hold no job");
+  test_assert(parse_batch_job("in.csv out.csv\r", job) &&
+                  job.input_file == "in.csv" && job.output_file == "out.csv",
+              "a job line should give the input and output");
+
+  ConfigManager config;
+  config.set_time_column("time");
+  config.set_thread_count(2);
+  PipelineSpec spec;
+  test_assert(resolve_pipeline_spec(config, spec), "batch spec should resolve");
+  BatchRunner runner(spec);
+  test_assert(runner.get_worker_count() == 2,
+              "jobs should run on the spec's threads");
+
+  std::istringstream manifest("batch_a.csv\n"
+                              "\n"
+                              "batch_b.csv batch_b_out.csv\n"
+                              "batch_missing.csv\n"
+                              "batch_a.csv batch_a_again.csv\n");
+  std::ostringstream report;
+  test_assert(!run_batch_stream(runner, manifest, report),
+              "a failed job should fail the batch");
+  const std::string lines = report.str();
+  test_assert(std::count(lines.begin(), lines.end(), '\n') == 4,
+              "every job should report one line");
+  test_assert(lines.find("ok batch_a.csv batch_a_cleaned.csv rows_in=4 "
+                         "rows_out=3") != std::string::npos,
+              "jobs without an output should use the default name");
+  test_assert(lines.find("failed batch_missing.csv") != std::string::npos,
+              "a missing input should be reported");
+  test_assert(runner.get_job_count() == 4 && runner.get_failed_count() == 1,
+              "runner should count jobs and failures");
+
+  test_assert(read_file("batch_a_cleaned.csv") ==
+                  read_file("batch_a_again.csv"),
+              "a reused worker should write the same output");
+  test_assert(read_file("batch_b_out.csv") == read_file("batch_a_cleaned.csv"),
+              "jobs should honour their output path");
+
+  const Metrics totals = runner.get_metrics();
+  test_assert(!totals.get_stages().empty() &&
+                  totals.get_stages()[0].name == "parse" &&
+                  totals.get_stages()[0].rows_out == 12,
+              "stages should be summed over the jobs");
+
+  for (const char *name :
+       {"batch_a.csv", "batch_b.csv", "batch_a_cleaned.csv",
+        "batch_b_out.csv", "batch_a_again.csv"}) {
+    std::remove(name);
+  }
+  std::cout << "Batch runner test passed!" << std::endl;
+}
+
+void test_metrics_report() {
+  std::cout << "Testing metrics report..." << std::endl;
+
+  std::ofstream test_file("metrics_test_data.csv");
+  test_file << "time,value,label\n";
+  test_file << "0,1.5,a\n";
+  test_file << "1,,b\n";
+  test_file << "1,,b\n"; // Duplicate
+  test_file << "2,3.5\n"; // Malformed
+  test_file << "3,2.5,\n";
+  test_file.close();
+
+  Metrics metrics;
+  CsvParser parser;
+  size_t parse_stage = 0;
+  {
+    ScopedStage stage(metrics, "parse");
+    parse_stage = stage.index();
+    parser.load_file("metrics_test_data.csv");
+    stage.stage().bytes_read = parser.get_bytes_read();
+    metrics.add_counter(stage.index(), "malformed_rows",
+                        parser.get_malformed_count());
+  }
+  test_assert(parser.get_malformed_count() == 1,
+              "parser should count the malformed row");
+  test_assert(metrics.get_stages()[parse_stage].bytes_read > 0,
+              "parse stage should record bytes read");
+
+  Table table = parser.get_table();
+  DataCleaner cleaner;
+  cleaner.clean_data(table);
+  test_assert(cleaner.get_duplicates_removed() == 1,
+              "cleaner should count removed duplicates");
+  test_assert(cleaner.get_imputed_cells().at("mean") == 1 &&
+                  cleaner.get_imputed_cells().at("zero") == 1,
+              "cleaner should count imputed cells by strategy");
+
+  const size_t clean_stage = metrics.begin_stage("clean");
+  for (const auto &imputed : cleaner.get_imputed_cells()) {
+    metrics.add_counter(clean_stage, "cells_imputed", imputed.second,
+                        "strategy", imputed.first);
+  }
+  metrics.add_counter(clean_stage, "cells_imputed", 2, "strategy", "mean");
+  metrics.end_stage(clean_stage);
+
+  const std::string prometheus = metrics.to_prometheus();
+  test_assert(prometheus.find("adapter_cells_imputed_total{stage=\"clean\","
+                              "strategy=\"mean\"} 3") != std::string::npos,
+              "prometheus output should sum counters with labels");
+  test_assert(prometheus.find("adapter_malformed_rows_total{stage=\"parse\"} "
+                              "1") != std::string::npos,
+              "prometheus output should include stage counters");
+  const std::string json = metrics.to_json();
+  test_assert(json.find("\"name\": \"clean\"") != std::string::npos &&
+                  json.find("\"labels\": {\"strategy\": \"zero\"}") !=
+                      std::string::npos,
+              "json output should list stages and labels");
+  test_assert(metrics.to_table().find("cells_imputed{strategy=mean}: 3") !=
+                  std::string::npos,
+              "table output should list counters under their stage");
+
+  MetricsFormat format = MetricsFormat::TABLE;
+  test_assert(Metrics::parse_format("prometheus", format) &&
+                  format == MetricsFormat::PROMETHEUS &&
+                  !Metrics::parse_format("xml", format),
+              "profile formats should parse");
+
+  std::remove("metrics_test_data.csv");
+
+  std::cout << "Metrics report test passed!" << std::endl;
+}
+
 void test_error_handling() {
   std::cout << "Testing error handling..." << std::endl;
 
@@ -172,6 +738,15 @@ int main() {
   try {
     test_full_pipeline();
     test_config_file_operations();
+    test_pipeline_spec();
+    test_streaming_pipeline();
+    test_streaming_median_estimate();
+    test_parallel_columns();
+    test_time_index_alignment();
+    test_merge_aligner();
+    test_incremental_pipeline();
+    test_batch_runner();
+    test_metrics_report();
     test_error_handling();
 
     std::cout << std::endl
@@ -0,0 +1,332 @@
+#include "adapter/cell_arena.hpp"
+#include "adapter/cubic_spline.hpp"
+#include "adapter/data_cleaner.hpp"
+#include "adapter/table.hpp"
+#include "adapter/time_aligner.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+using namespace adapter;
+
+// Simple test framework
+template <typename T>
+void test_assert(const T &actual, const T &expected,
+                 const std::string &test_name) {
+  if (actual == expected) {
+    std::cout << "[PASS] " << test_name << std::endl;
+  } else {
+    std::cout << "[FAIL] " << test_name << " - Expected: " << expected
+              << ", Got: " << actual << std::endl;
+    throw std::runtime_error("Test failed: " + test_name);
+  }
+}
+
+void test_table_type_inference() {
+  std::cout << "Testing Table column type inference..." << std::endl;
+
+  Table table = Table::from_rows({"id", "value", "label"},
+                                 {{"1", "10.50", "a"},
+                                  {"2", "", "b"},
+                                  {"3", "12.25", "a"},
+                                  {"4", "NA", "NULL"}});
+
+  test_assert(table.get_row_count(), static_cast<size_t>(4),
+              "table should have 4 rows");
+  test_assert(table.get_column_count(), static_cast<size_t>(3),
+              "table should have 3 columns");
+
+  const Column &id = table.get_column(table.find_column("id"));
+  const Column &value = table.get_column(table.find_column("value"));
+  const Column &label = table.get_column(table.find_column("label"));
+
+  test_assert(id.get_type() == ColumnType::INT64, true,
+              "integer column should be INT64");
+  test_assert(value.get_type() == ColumnType::FLOAT64, true,
+              "decimal column should be FLOAT64");
+  test_assert(label.get_type() == ColumnType::STRING, true,
+              "text column should be STRING");
+
+  test_assert(value.get_null_count(), static_cast<size_t>(2),
+              "missing tokens should become nulls");
+  test_assert(value.to_string(0), std::string("10.50"),
+              "uniform precision should be preserved");
+  test_assert(label.get_dictionary().size(), static_cast<size_t>(2),
+              "string column should be dictionary-encoded");
+  test_assert(table.find_column("missing") == Table::npos, true,
+              "unknown column should not be found");
+
+  auto rows = table.to_rows();
+  test_assert(rows[2][1], std::string("12.25"),
+              "to_rows should render numeric cells");
+  test_assert(rows[3][2], std::string(""), "to_rows should render nulls empty");
+
+  Table scientific =
+      Table::from_rows({"x", "n"}, {{"1.5e3", "+4"}, {"-2E-1", "5"}});
+  test_assert(scientific.get_column(0).get_type() == ColumnType::FLOAT64, true,
+              "scientific notation should be FLOAT64");
+  test_assert(scientific.get_column(0).to_string(1), std::string("-0.2"),
+              "scientific values should render shortest");
+  test_assert(scientific.get_column(1).get_int(0), static_cast<int64_t>(4),
+              "leading plus should parse as INT64");
+
+  std::cout << "Table type inference tests passed!" << std::endl;
+}
+
+void test_table_cleaning() {
+  std::cout << "Testing Table cleaning..." << std::endl;
+
+  Table table = Table::from_rows({"a", "b"}, {{"1", "2.0"},
+                                              {"3", ""},
+                                              {"1", "2.0"},
+                                              {"5", "4.0"}});
+
+  DataCleaner cleaner;
+  cleaner.clean_data(table);
+
+  test_assert(table.get_row_count(), static_cast<size_t>(3),
+              "duplicate row should be removed");
+
+  const Column &b = table.get_column(1);
+  test_assert(b.get_null_count(), static_cast<size_t>(0),
+              "missing value should be imputed");
+  test_assert(b.to_string(1), std::string("3.00"),
+              "imputed value should be the column mean");
+  test_assert(table.get_column(0).to_string(2), std::string("5.00"),
+              "numeric columns should be normalized to precision");
+
+  std::cout << "Table cleaning tests passed!" << std::endl;
+}
+
+void test_table_alignment() {
+  std::cout << "Testing Table time alignment..." << std::endl;
+
+  Table table = Table::from_rows({"time", "value", "state"}, {{"0", "0", "x"},
+                                                              {"2", "4", "y"},
+                                                              {"4", "8", "y"}});
+
+  TimeAligner aligner;
+  aligner.set_target_time_interval(1.0);
+  aligner.align_time_series_data(table, "time", {"value"}, {});
+
+  test_assert(table.get_row_count(), static_cast<size_t>(5),
+              "alignment should produce 5 points");
+  const Column &value = table.get_column(table.find_column("value"));
+  test_assert(value.get_double(1), 2.0, "value should be interpolated");
+  test_assert(value.get_double(3), 6.0, "value should be interpolated");
+  const Column &state = table.get_column(table.find_column("state"));
+  test_assert(state.get_string(1), std::string("x"),
+              "text should use nearest neighbor");
+
+  // Out-of-order input is sorted before the grid is walked
+  Table shuffled = Table::from_rows({"time", "value"}, {{"4", "8"},
+                                                        {"0", "0"},
+                                                        {"3", "3"},
+                                                        {"1", "1"}});
+  aligner.align_time_series_data(shuffled, "time", {"value"}, {});
+  const Column &sorted_value = shuffled.get_column(1);
+  test_assert(sorted_value.get_double(2), 2.0,
+              "unsorted input should interpolate between neighbours");
+  test_assert(sorted_value.get_double(4), 8.0,
+              "last grid point should match the latest sample");
+
+  std::vector<std::vector<std::string>> rows = {
+      {"time", "value"}, {"4", "8"}, {"0", "0"}, {"2", "2"}};
+  aligner.align_time_series_data(rows, "time", {"value"}, {});
+  test_assert(rows.size(), static_cast<size_t>(6),
+              "row-based alignment should produce 5 points");
+  test_assert(rows[4][1], std::string("5.000000"),
+              "row-based alignment should sort before interpolating");
+
+  std::cout << "Table alignment tests passed!" << std::endl;
+}
+
+void test_spline_and_integration() {
+  std::cout << "Testing cubic spline and derivative integration..." << std::endl;
+
+  // A clamped spline with exact end slopes reproduces a cubic
+  std::vector<double> x = {0, 1, 2, 3, 4};
+  std::vector<double> y;
+  for (double xi : x) {
+    y.push_back(xi * xi * xi);
+  }
+  CubicSpline spline;
+  test_assert(spline.fit(x, y, 0.0, 48.0), true, "clamped fit should succeed");
+  std::vector<double> values;
+  spline.evaluate({0.5, 1.5, 3.25}, values);
+  test_assert(std::abs(values[0] - 0.125) < 1e-9 &&
+                  std::abs(values[1] - 3.375) < 1e-9 &&
+                  std::abs(values[2] - 34.328125) < 1e-9,
+              true, "clamped spline should reproduce a cubic");
+
+  // A natural spline through a line is the line
+  CubicSpline line;
+  line.fit({0, 1, 3, 6}, {1, 3, 7, 13});
+  size_t cursor = 0;
+  test_assert(std::abs(line.evaluate_at(2.0, cursor) - 5.0) < 1e-12, true,
+              "natural spline should reproduce a line");
+  test_assert(line.fit({0, 0}, {1, 2}), false,
+              "repeated knots should be rejected");
+
+  Table table = Table::from_rows({"time", "flow", "level"}, {{"0", "0", "0"},
+                                                             {"1", "1", "1"},
+                                                             {"2", "", "8"},
+                                                             {"3", "3", "27"},
+                                                             {"4", "4", "64"}});
+  TimeAligner aligner;
+  aligner.set_target_time_interval(0.5);
+  aligner.set_solver_method(SolverMethod::CUBIC_SPLINE);
+  aligner.set_derivative_columns({"flow"});
+  aligner.align_time_series_data(table, "time", {"level"}, {});
+
+  test_assert(table.get_row_count(), static_cast<size_t>(9),
+              "half-second grid should have 9 points");
+  const size_t integral_col = table.find_column("flow_integral");
+  test_assert(integral_col != Table::npos, true,
+              "derivative column should gain an integral column");
+  const Column &integral = table.get_column(integral_col);
+  test_assert(std::abs(integral.get_double(8) - 8.0) < 1e-9, true,
+              "RK4 should integrate a linear rate exactly");
+  const Column &flow = table.get_column(table.find_column("flow"));
+  test_assert(std::abs(flow.get_double(4) - 2.0) < 1e-9, true,
+              "spline should skip the missing sample");
+
+  std::cout << "Cubic spline and integration tests passed!" << std::endl;
+}
+
+void test_cell_arena() {
+  std::cout << "Testing arena-backed cell storage..." << std::endl;
+
+  CellArena arena(64);
+  std::string_view first = arena.store("first cell");
+  std::string_view empty = arena.store("");
+  const std::string long_text(200, 'y');
+  std::string_view oversized = arena.store(long_text);
+  test_assert(empty.size(), static_cast<size_t>(0),
+              "empty cells should take no space");
+  test_assert(oversized == long_text, true,
+              "oversized cells should get their own block");
+
+  CellArena other(64);
+  std::string_view moved = other.store("from another chunk");
+  arena.absorb(std::move(other));
+  std::string_view after = arena.store("after absorb");
+  test_assert(std::string(first) + "|" + std::string(moved) + "|" +
+                  std::string(after),
+              std::string("first cell|from another chunk|after absorb"),
+              "views should survive absorb");
+  test_assert(arena.get_bytes_used(), static_cast<size_t>(240),
+              "arena should count stored bytes");
+  test_assert(other.get_block_count(), static_cast<size_t>(0),
+              "absorbed arena should be empty");
+
+  TableBuilder head({"id", "note"});
+  TableBuilder tail({"id", "note"});
+  std::vector<std::string_view> row = {"1", "a note longer than sso storage"};
+  head.append_row(row);
+  row = {"2", "second"};
+  tail.append_row(row);
+  head.append_rows(std::move(tail));
+  test_assert(head.get_cell_bytes(), static_cast<size_t>(38),
+              "builder should keep every chunk's bytes");
+
+  Table table = head.finish();
+  const Column &note = table.get_column(1);
+  test_assert(note.get_string(0), std::string("a note longer than sso storage"),
+              "text should be copied out of the arena");
+  test_assert(note.get_string(1), std::string("second"),
+              "appended chunk text should be kept");
+  test_assert(head.get_cell_bytes(), static_cast<size_t>(0),
+              "finish should release the arena");
+
+  arena.reset();
+  test_assert(arena.get_block_count(), static_cast<size_t>(1),
+              "reset should keep one block for reuse");
+  test_assert(std::string(arena.store("reused")), std::string("reused"),
+              "a reset arena should store again");
+  head.reset({"id"});
+  row = {"3"};
+  head.append_row(row);
+  test_assert(head.finish().get_column(0).get_int(0), static_cast<int64_t>(3),
+              "a reset builder should build a new table");
+
+  std::cout << "Arena-backed cell storage tests passed!" << std::endl;
+}
+
+void test_sampled_inference() {
+  std::cout << "Testing sampled type inference..." << std::endl;
+
+  InferenceOptions options;
+  options.sample_rows = 2;
+  options.column_kinds["zip"] = ColumnKind::TEXT;
+  TableBuilder builder({"count", "ratio", "stamp", "zip", "group"});
+  builder.set_inference(options);
+  const char *rows[][5] = {{"1", "0.50", "2024-01-01T00:00:00Z", "01234", "a"},
+                           {"2", "0.25", "2024-01-01T00:00:01Z", "02134", "b"},
+                           {"3", "0.75", "2024-01-01T00:00:02Z", "03124", "a"},
+                           {"4.5", "1.125", "2024-01-01", "04123", "b"}};
+  for (const auto &row : rows) {
+    builder.append_row(std::vector<std::string_view>(row, row + 5));
+  }
+  Table table = builder.finish();
+
+  const Column &count = table.get_column(0);
+  test_assert(count.get_type() == ColumnType::FLOAT64, true,
+              "a late float should override a sampled int");
+  test_assert(count.to_string(3), std::string("4.5"),
+              "fallback should keep every value");
+  const Column &ratio = table.get_column(1);
+  test_assert(ratio.get_precision(), -1,
+              "precision should cover rows beyond the sample");
+  test_assert(table.get_column(2).get_kind() == ColumnKind::TIMESTAMP, true,
+              "RFC 3339 text should be a timestamp column");
+  const Column &zip = table.get_column(3);
+  test_assert(zip.get_type() == ColumnType::STRING &&
+                  zip.get_kind() == ColumnKind::TEXT,
+              true, "an override should keep zip codes as text");
+  test_assert(zip.get_string(0), std::string("01234"),
+              "overridden text should be kept as written");
+  test_assert(table.get_column(4).get_kind() == ColumnKind::CATEGORICAL, true,
+              "few distinct values should be categorical");
+
+  Column sparse("sparse", ColumnType::INT64);
+  for (size_t row = 0; row < 130; ++row) {
+    if (row % 3 == 0) {
+      sparse.append_null();
+    } else {
+      sparse.append_int(static_cast<int64_t>(row));
+    }
+  }
+  sparse.fill_nulls(-1.0);
+  test_assert(sparse.get_null_count(), static_cast<size_t>(0),
+              "fill_nulls should leave no nulls");
+  test_assert(sparse.get_int(129) == -1 && sparse.get_int(128) == 128, true,
+              "fill_nulls should touch only the null cells");
+
+  ColumnKind kind = ColumnKind::TEXT;
+  test_assert(parse_column_kind("categorical", kind) &&
+                  kind == ColumnKind::CATEGORICAL,
+              true, "kind names should parse");
+  test_assert(parse_column_kind("date", kind), false,
+              "unknown kinds should be rejected");
+
+  std::cout << "Sampled type inference tests passed!" << std::endl;
+}
+
+int main() {
+  try {
+    test_table_type_inference();
+    test_table_cleaning();
+    test_table_alignment();
+    test_spline_and_integration();
+    test_cell_arena();
+    test_sampled_inference();
+
+    std::cout << std::endl << "All Table tests passed successfully!"
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed with exception: " << e.what() << std::endl;
+    return 1;
+  }
+}